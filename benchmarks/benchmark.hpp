@@ -0,0 +1,31 @@
+#pragma once
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <engine/profiler.hpp>
+
+// Minimal harness: runs `f` a few times to warm up, then reports timings of `iterations` runs.
+template<typename F>
+ProfileStats RunBenchmark(const std::string& name, const std::size_t iterations, F&& f) {
+	for (std::size_t i = 0; i < 3; ++i) {
+		f();
+	}
+
+	std::vector<std::uint64_t> samples;
+	samples.reserve(iterations);
+	for (std::size_t i = 0; i < iterations; ++i) {
+		const auto start = Profiler::Clock::now();
+		f();
+		samples.push_back(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Profiler::Clock::now() - start).count()));
+	}
+
+	const auto stats = Profiler::Summarize(samples);
+	std::cout << std::left << std::setw(64) << name << std::right << std::fixed << std::setprecision(3)
+		<< " min " << std::setw(9) << stats.min << "ms"
+		<< "  avg " << std::setw(9) << stats.avg << "ms"
+		<< "  p95 " << std::setw(9) << stats.p95 << "ms" << std::endl;
+	return stats;
+}
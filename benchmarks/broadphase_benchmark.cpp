@@ -0,0 +1,88 @@
+// Overlapping pairs among n GameObject-sized boxes: brute force O(n^2) checks against the spatial hash
+// (serial and parallel rebuild + pair search), plus the incremental path where every object moves a little each frame.
+// Brute force at 100k objects takes seconds per run, so it runs only once there.
+// Usage: broadphase_benchmark [max objects]
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <engine/scheduler.hpp>
+#include <engine/spatial_hash.hpp>
+
+#include "benchmark.hpp"
+
+namespace {
+	constexpr float objectSize = 16.0f;
+
+	std::vector<Aabb2D> makeBoxes(const std::size_t count) {
+		// Keeps the density (and so the number of pairs per object) the same at every count.
+		const float extent = std::sqrt(static_cast<float>(count)) * objectSize * 4.0f;
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> position(0.0f, extent);
+		std::vector<Aabb2D> boxes;
+		boxes.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			boxes.push_back(Aabb2D::FromPositionSize(glm::vec2(position(rng), position(rng)), glm::vec2(objectSize)));
+		}
+		return boxes;
+	}
+
+	void runSuite(const std::size_t count, Scheduler& scheduler) {
+		const auto boxes = makeBoxes(count);
+		const std::string suffix = " [" + std::to_string(count) + " objects]";
+		const std::size_t iterations = count >= 100000 ? 20 : 100;
+
+		std::vector<SpatialHash2D::Pair> pairs;
+		RunBenchmark("brute force pairs" + suffix, count >= 100000 ? 1 : iterations / 10, [&]() {
+			pairs.clear();
+			for (std::size_t i = 0; i < boxes.size(); ++i) {
+				for (std::size_t j = i + 1; j < boxes.size(); ++j) {
+					if (boxes[i].Overlaps(boxes[j])) {
+						pairs.emplace_back(static_cast<SpatialHash2D::Id>(i), static_cast<SpatialHash2D::Id>(j));
+					}
+				}
+			}
+		});
+		const std::size_t expected = pairs.size();
+
+		SpatialHash2D grid(objectSize * 2.0f, count);
+		RunBenchmark("spatial hash rebuild + pairs" + suffix, iterations, [&]() {
+			grid.Rebuild(boxes);
+			grid.FindPairs(pairs);
+		});
+		RunBenchmark("spatial hash rebuild + pairs, " + std::to_string(scheduler.getNumThreads()) + " threads" + suffix, iterations, [&]() {
+			grid.Rebuild(boxes, &scheduler);
+			grid.FindPairs(pairs, &scheduler);
+		});
+
+		auto moved = boxes;
+		float offset = 0.0f;
+		RunBenchmark("spatial hash incremental update + pairs" + suffix, iterations, [&]() {
+			offset = offset > 0.0f ? -1.0f : 1.0f;
+			for (std::size_t i = 0; i < moved.size(); ++i) {
+				moved[i].min.x += offset;
+				moved[i].max.x += offset;
+				grid.Update(static_cast<SpatialHash2D::Id>(i), moved[i]);
+			}
+			grid.FindPairs(pairs);
+		});
+
+		grid.Rebuild(boxes);
+		grid.FindPairs(pairs);
+		if (pairs.size() != expected) {
+			std::cerr << "Pair count mismatch: " << pairs.size() << " vs brute force " << expected << std::endl;
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::size_t maxObjects = argc > 1 ? static_cast<std::size_t>(std::stoul(argv[1])) : 100000;
+	Scheduler scheduler;
+	for (std::size_t count = 1000; count <= maxObjects; count *= 10) {
+		runSuite(count, scheduler);
+	}
+	return 0;
+}
@@ -0,0 +1,95 @@
+// Frustum culling of n placed props: testing every box against the frustum checks against the dynamic BVH,
+// plus the cost of building the tree, of moving every prop each frame and of a picking ray cast.
+// Usage: culling_benchmark [max props]
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <engine/bvh.hpp>
+
+#include "benchmark.hpp"
+
+namespace {
+	std::vector<Aabb3D> makeProps(const std::size_t count) {
+		// Props on a ground plane, spread so the density stays the same at every count.
+		const float extent = std::sqrt(static_cast<float>(count)) * 8.0f;
+		std::mt19937 rng(11);
+		std::uniform_real_distribution<float> position(-extent, extent);
+		std::uniform_real_distribution<float> size(0.5f, 3.0f);
+		std::vector<Aabb3D> props;
+		props.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			const glm::vec3 center(position(rng), 1.0f, position(rng));
+			props.push_back(Aabb3D::FromCenterExtents(center, glm::vec3(size(rng))));
+		}
+		return props;
+	}
+
+	void runSuite(const std::size_t count) {
+		const auto props = makeProps(count);
+		const std::string suffix = " [" + std::to_string(count) + " props]";
+		const std::size_t iterations = 200;
+		const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(50.0f, 0.0f, 50.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+		const Frustum frustum = Frustum::FromMatrix(projection * view);
+
+		std::vector<std::uint32_t> visible;
+		RunBenchmark("linear frustum test" + suffix, iterations, [&]() {
+			visible.clear();
+			for (std::size_t i = 0; i < props.size(); ++i) {
+				if (frustum.Intersects(props[i])) {
+					visible.push_back(static_cast<std::uint32_t>(i));
+				}
+			}
+		});
+		const std::size_t linearVisible = visible.size();
+
+		DynamicBvh bvh;
+		std::vector<DynamicBvh::ProxyId> proxies;
+		RunBenchmark("bvh build" + suffix, count >= 100000 ? 5 : 20, [&]() {
+			bvh.Clear();
+			proxies.clear();
+			for (std::size_t i = 0; i < props.size(); ++i) {
+				proxies.push_back(bvh.Insert(props[i], static_cast<std::uint32_t>(i)));
+			}
+		});
+		RunBenchmark("bvh frustum query" + suffix, iterations, [&]() {
+			visible.clear();
+			bvh.QueryFrustum(frustum, [&](const DynamicBvh::ProxyId proxy) { visible.push_back(bvh.getUserData(proxy)); });
+		});
+		// The BVH tests the fat boxes, so it may keep a few more.
+		std::cout << "  visible: " << linearVisible << " linear, " << visible.size() << " bvh, height " << bvh.getHeight() << std::endl;
+
+		auto moved = props;
+		float offset = 0.0f;
+		// Each step moves every prop out of its fat box, the worst case for Move.
+		RunBenchmark("bvh move every prop" + suffix, iterations, [&]() {
+			offset = offset > 0.0f ? -0.25f : 0.25f;
+			for (std::size_t i = 0; i < moved.size(); ++i) {
+				moved[i].min.x += offset;
+				moved[i].max.x += offset;
+				bvh.Move(proxies[i], moved[i]);
+			}
+		});
+
+		const Ray ray = Ray::FromScreen(glm::vec2(640.0f, 360.0f), glm::vec2(1280.0f, 720.0f), view, projection);
+		RunBenchmark("bvh ray cast" + suffix, iterations, [&]() {
+			bvh.RayCast(ray, 1000.0f, [&](const DynamicBvh::ProxyId proxy, const float maxDistance) {
+				return ray.Intersect(moved[bvh.getUserData(proxy)], maxDistance);
+			});
+		});
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::size_t maxProps = argc > 1 ? static_cast<std::size_t>(std::stoul(argv[1])) : 100000;
+	for (std::size_t count = 1000; count <= maxProps; count *= 10) {
+		runSuite(count);
+	}
+	return 0;
+}
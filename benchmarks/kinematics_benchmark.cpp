@@ -0,0 +1,89 @@
+// Advances 100k 2D bodies with damping and bounds clamping: the per-object loop over GameObjects games write today
+// against the SoA kernel at each SIMD level, single threaded and across the scheduler.
+// Usage: kinematics_benchmark [bodies]
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <engine/game_object.hpp>
+#include <engine/kinematics.hpp>
+#include <engine/scheduler.hpp>
+
+#include "benchmark.hpp"
+
+namespace {
+	constexpr std::size_t iterations = 200;
+	constexpr float dt = 1.0f / 60.0f;
+
+	std::string levelName(const SimdLevel level) {
+		switch (level) {
+		case SimdLevel::Scalar: return "scalar";
+		case SimdLevel::SSE2: return "sse2";
+		case SimdLevel::AVX2: return "avx2";
+		case SimdLevel::Auto: break;
+		}
+		return "auto";
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::size_t count = argc > 1 ? static_cast<std::size_t>(std::stoul(argv[1])) : 100000;
+	const std::string suffix = " [" + std::to_string(count) + " bodies]";
+
+	KinematicsParams params;
+	params.damping = 0.5f;
+	params.clampToBounds = true;
+	params.boundsMin = glm::vec2(0.0f);
+	params.boundsMax = glm::vec2(1920.0f, 1080.0f);
+	params.restitution = 0.8f;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(0.0f, 1080.0f);
+	std::uniform_real_distribution<float> velocity(-400.0f, 400.0f);
+	std::vector<GameObject> objects(count);
+	KinematicBodies bodies;
+	bodies.Reserve(count);
+	for (auto& object : objects) {
+		object.position() = glm::vec2(position(rng), position(rng));
+		object.velocity() = glm::vec2(velocity(rng), velocity(rng));
+		bodies.Add(object.position(), object.velocity());
+	}
+
+	RunBenchmark("naive GameObject loop" + suffix, iterations, [&]() {
+		const float factor = std::exp(-params.damping * dt);
+		for (auto& object : objects) {
+			glm::vec2& objectPosition = object.position();
+			glm::vec2& objectVelocity = object.velocity();
+			objectVelocity *= factor;
+			objectPosition += objectVelocity * dt;
+			for (int axis = 0; axis < 2; ++axis) {
+				if (objectPosition[axis] < params.boundsMin[axis]) {
+					objectPosition[axis] = params.boundsMin[axis];
+					objectVelocity[axis] = std::abs(objectVelocity[axis]) * params.restitution;
+				} else if (objectPosition[axis] > params.boundsMax[axis]) {
+					objectPosition[axis] = params.boundsMax[axis];
+					objectVelocity[axis] = -std::abs(objectVelocity[axis]) * params.restitution;
+				}
+			}
+		}
+	});
+
+	const SimdLevel supported = KinematicBodies::getSupportedSimdLevel();
+	for (const auto level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+		if (level > supported) {
+			continue;
+		}
+		RunBenchmark("KinematicBodies " + levelName(level) + suffix, iterations, [&]() {
+			bodies.Integrate(dt, params, nullptr, level);
+		});
+	}
+
+	Scheduler scheduler;
+	RunBenchmark("KinematicBodies " + levelName(supported) + ", " + std::to_string(scheduler.getNumThreads()) + " threads" + suffix, iterations, [&]() {
+		bodies.Integrate(dt, params, &scheduler);
+	});
+	return 0;
+}
@@ -0,0 +1,91 @@
+// Compares the scheduler backends on the workloads games throw at them:
+// wide data-parallel loops, lots of tiny independent tasks and a small per-frame task graph.
+// Usage: scheduler_benchmark [max threads]
+
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <engine/scheduler.hpp>
+#include <engine/task_graph.hpp>
+
+#include "benchmark.hpp"
+
+namespace {
+	constexpr std::size_t iterations = 50;
+
+	std::string backendName(const SchedulerBackend backend) {
+		return backend == SchedulerBackend::Fibers ? "ftl" : "work-stealing";
+	}
+
+	void runSuite(const SchedulerBackend backend, const std::size_t numThreads) {
+		SchedulerOptions options;
+		options.backend = backend;
+		options.numThreads = numThreads;
+		Scheduler scheduler{ options };
+		const std::string suffix = " [" + backendName(backend) + ", " + std::to_string(numThreads) + " threads]";
+
+		std::vector<float> data(1 << 20, 1.0f);
+		RunBenchmark("parallel_for 1M sqrt, grain 4096" + suffix, iterations, [&]() {
+			scheduler.parallel_for(0, data.size(), 4096, [&data](const std::size_t i) {
+				data[i] = std::sqrt(data[i] + 1.0f);
+			});
+		});
+
+		RunBenchmark("reduce 1M, grain 4096" + suffix, iterations, [&]() {
+			volatile float sum = scheduler.reduce(data, 0.0f, [](const float a, const float b) { return a + b; }, 4096);
+			static_cast<void>(sum);
+		});
+
+		std::atomic<std::size_t> ran{0};
+		RunBenchmark("10k empty tasks" + suffix, iterations, [&]() {
+			TaskCounter counter(&scheduler);
+			std::vector<Scheduler::Task> tasks(10000, [&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+			scheduler.AddTasks(std::move(tasks), &counter);
+			scheduler.WaitForCounter(counter);
+		});
+
+		// Animation -> culling -> commands, with 32 audio/particle style jobs alongside.
+		TaskGraph graph;
+		auto busyWork = [&data](const std::size_t offset) {
+			return [&data, offset]() {
+				float acc = 0.0f;
+				for (std::size_t i = 0; i < 2048; ++i) {
+					acc += data[(offset + i) % data.size()];
+				}
+				data[offset % data.size()] = acc;
+			};
+		};
+		const auto animation = graph.AddNode("Animation", busyWork(0));
+		const auto culling = graph.AddNode("Culling", busyWork(4096));
+		const auto commands = graph.AddNode("Commands", busyWork(8192));
+		graph.AddDependency(animation, culling);
+		graph.AddDependency(culling, commands);
+		for (std::size_t i = 0; i < 32; ++i) {
+			graph.AddNode("Side", busyWork(16384 + i * 4096));
+		}
+		graph.Compile();
+		RunBenchmark("35 node frame graph" + suffix, iterations, [&]() {
+			scheduler.RunGraph(graph);
+		});
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::size_t hardwareThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	const std::size_t maxThreads = argc > 1 ? static_cast<std::size_t>(std::stoul(argv[1])) : hardwareThreads;
+
+	std::vector<SchedulerBackend> backends = { SchedulerBackend::WorkStealing };
+#if ENGINE_ENABLE_MULTITHREADED
+	backends.push_back(SchedulerBackend::Fibers);
+#endif
+
+	for (std::size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+		for (const auto& backend : backends) {
+			runSuite(backend, numThreads);
+		}
+	}
+	return 0;
+}
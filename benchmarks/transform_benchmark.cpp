@@ -0,0 +1,75 @@
+// World matrices for n props in small hierarchies (a root with a few children each): recomputing every matrix each
+// frame against TransformHierarchy::Update when nothing moved, when 1% moved, and when everything moved.
+// Usage: transform_benchmark [max nodes]
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <engine/scheduler.hpp>
+#include <engine/transform_hierarchy.hpp>
+
+#include "benchmark.hpp"
+
+namespace {
+	void runSuite(const std::size_t count, Scheduler& scheduler) {
+		const std::string suffix = " [" + std::to_string(count) + " nodes]";
+		const std::size_t iterations = 100;
+
+		TransformHierarchy hierarchy;
+		std::vector<TransformHierarchy::NodeId> nodes;
+		std::vector<std::size_t> parents;
+		std::vector<Transform> locals;
+		for (std::size_t i = 0; i < count; ++i) {
+			Transform local;
+			local.translation = glm::vec3(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100));
+			const bool root = i % 8 == 0;
+			parents.push_back(root ? count : i - i % 8);
+			nodes.push_back(hierarchy.Create(local, root ? TransformHierarchy::nullNode : nodes[i - i % 8]));
+			locals.push_back(local);
+		}
+
+		std::vector<glm::mat4> worlds(count);
+		RunBenchmark("recompute every world matrix" + suffix, iterations, [&]() {
+			for (std::size_t i = 0; i < count; ++i) {
+				const glm::mat4 local = locals[i].toMatrix();
+				worlds[i] = parents[i] == count ? local : worlds[parents[i]] * local;
+			}
+		});
+
+		hierarchy.Update();
+		RunBenchmark("hierarchy update, nothing moved" + suffix, iterations, [&]() {
+			hierarchy.Update();
+		});
+		std::size_t frame = 0;
+		RunBenchmark("hierarchy update, 1% of roots moved" + suffix, iterations, [&]() {
+			frame += 1;
+			for (std::size_t i = (frame % 100) * 8; i < count; i += 800) {
+				hierarchy.setLocal(nodes[i], locals[i]);
+			}
+			hierarchy.Update();
+		});
+		auto moveAll = [&]() {
+			for (std::size_t i = 0; i < count; i += 8) {
+				hierarchy.setLocal(nodes[i], locals[i]);
+			}
+		};
+		RunBenchmark("hierarchy update, everything moved" + suffix, iterations, [&]() {
+			moveAll();
+			hierarchy.Update();
+		});
+		RunBenchmark("hierarchy update, everything moved, " + std::to_string(scheduler.getNumThreads()) + " threads" + suffix, iterations, [&]() {
+			moveAll();
+			hierarchy.Update(&scheduler);
+		});
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::size_t maxNodes = argc > 1 ? static_cast<std::size_t>(std::stoul(argv[1])) : 1000000;
+	Scheduler scheduler;
+	for (std::size_t count = 10000; count <= maxNodes; count *= 10) {
+		runSuite(count, scheduler);
+	}
+	return 0;
+}
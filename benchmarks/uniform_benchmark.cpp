@@ -0,0 +1,146 @@
+// Uniform-heavy draws, as meshes did before cameras and lights moved to uniform buffers: matrices, a material and
+// several lights' worth of uniforms per draw. Compares looking every name up with glGetUniformLocation (what the
+// Shader setters used to do) against the reflected table by name and against handles resolved once.
+// Needs a GL context, so it opens a hidden window like EngineMode::Headless.
+// Usage: uniform_benchmark [draws per frame]
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <constants/shader.hpp>
+#include <engine/engine.hpp>
+#include <engine/game.hpp>
+
+#include "benchmark.hpp"
+
+namespace {
+	constexpr std::size_t numLights = 4;
+	constexpr std::size_t iterations = 50;
+
+	const char* vertexSource = R"(#version 330 core
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+void main() {
+	gl_Position = projection * view * model * vec4(float(gl_VertexID), 0.0, 0.0, 1.0);
+}
+)";
+
+	const char* fragmentSource = R"(#version 330 core
+struct PointLight {
+	vec3 position;
+	float constant;
+	float linear;
+	float quadratic;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+struct Material {
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+};
+uniform PointLight pointLights[4];
+uniform Material material;
+uniform vec3 viewPos;
+out vec4 FragColour;
+void main() {
+	vec3 colour = material.ambient + material.diffuse + material.specular * material.shininess + viewPos;
+	for (int i = 0; i < 4; ++i) {
+		PointLight light = pointLights[i];
+		colour += (light.ambient + light.diffuse + light.specular + light.position) * (light.constant + light.linear + light.quadratic);
+	}
+	FragColour = vec4(colour, 1.0);
+}
+)";
+
+	const std::vector<std::string> lightFields = { "position", "constant", "linear", "quadratic", "ambient", "diffuse", "specular" };
+
+	std::string lightUniform(const std::size_t light, const std::string& field) {
+		return "pointLights[" + std::to_string(light) + "]." + field;
+	}
+}
+
+int main(int argc, char** argv) {
+	const std::size_t drawsPerFrame = argc > 1 ? static_cast<std::size_t>(std::stoul(argv[1])) : 1000;
+	auto game = std::make_shared<Game>(ScreenSize{ 320, 240 }, "uniform_benchmark");
+	Engine engine{ game, EngineConfig::Headless(1) };
+
+	Shader shader(vertexSource, fragmentSource);
+	if (!shader.valid()) {
+		return 1;
+	}
+	shader.use();
+	unsigned int vao = 0;
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	const std::string suffix = " [" + std::to_string(drawsPerFrame) + " draws, " + std::to_string(shader.numUniforms()) + " uniforms]";
+	const glm::mat4 matrix(1.0f);
+	const glm::vec3 colour(0.5f);
+
+	RunBenchmark("glGetUniformLocation per set" + suffix, iterations, [&]() {
+		const unsigned int program = shader.id();
+		for (std::size_t draw = 0; draw < drawsPerFrame; ++draw) {
+			glUniformMatrix4fv(glGetUniformLocation(program, std::string("model").c_str()), 1, GL_FALSE, &matrix[0][0]);
+			glUniformMatrix4fv(glGetUniformLocation(program, std::string("view").c_str()), 1, GL_FALSE, &matrix[0][0]);
+			glUniformMatrix4fv(glGetUniformLocation(program, std::string("projection").c_str()), 1, GL_FALSE, &matrix[0][0]);
+			glUniform3fv(glGetUniformLocation(program, std::string("viewPos").c_str()), 1, &colour[0]);
+			glUniform3fv(glGetUniformLocation(program, std::string("material.ambient").c_str()), 1, &colour[0]);
+			glUniform3fv(glGetUniformLocation(program, std::string("material.diffuse").c_str()), 1, &colour[0]);
+			glUniform3fv(glGetUniformLocation(program, std::string("material.specular").c_str()), 1, &colour[0]);
+			glUniform1f(glGetUniformLocation(program, std::string("material.shininess").c_str()), 32.0f);
+			for (std::size_t light = 0; light < numLights; ++light) {
+				for (const auto& field : lightFields) {
+					glUniform1f(glGetUniformLocation(program, lightUniform(light, field).c_str()), 1.0f);
+				}
+			}
+			glDrawArrays(GL_POINTS, 0, 1);
+		}
+		glFinish();
+	});
+
+	RunBenchmark("table lookup by name" + suffix, iterations, [&]() {
+		for (std::size_t draw = 0; draw < drawsPerFrame; ++draw) {
+			shader.setMat4("model", matrix).setMat4("view", matrix).setMat4("projection", matrix).setVec3("viewPos", colour);
+			shader.setVec3("material.ambient", colour).setVec3("material.diffuse", colour).setVec3("material.specular", colour);
+			shader.setFloat("material.shininess", 32.0f);
+			for (std::size_t light = 0; light < numLights; ++light) {
+				for (const auto& field : lightFields) {
+					shader.setFloat(lightUniform(light, field), 1.0f);
+				}
+			}
+			glDrawArrays(GL_POINTS, 0, 1);
+		}
+		glFinish();
+	});
+
+	std::vector<UniformHandle> handles;
+	for (const char* name : { "model", "view", "projection", "viewPos", "material.ambient", "material.diffuse", "material.specular", "material.shininess" }) {
+		handles.push_back(shader.uniform(name));
+	}
+	for (std::size_t light = 0; light < numLights; ++light) {
+		for (const auto& field : lightFields) {
+			handles.push_back(shader.uniform(lightUniform(light, field)));
+		}
+	}
+	RunBenchmark("resolved handles" + suffix, iterations, [&]() {
+		for (std::size_t draw = 0; draw < drawsPerFrame; ++draw) {
+			shader.setMat4(handles[0], matrix).setMat4(handles[1], matrix).setMat4(handles[2], matrix).setVec3(handles[3], colour);
+			shader.setVec3(handles[4], colour).setVec3(handles[5], colour).setVec3(handles[6], colour);
+			shader.setFloat(handles[7], 32.0f);
+			for (std::size_t i = 8; i < handles.size(); ++i) {
+				shader.setFloat(handles[i], 1.0f);
+			}
+			glDrawArrays(GL_POINTS, 0, 1);
+		}
+		glFinish();
+	});
+
+	glDeleteVertexArrays(1, &vao);
+	return 0;
+}
@@ -1,12 +1,28 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <glm/glm.hpp>
 
+struct UniformTable;
+
+// Location of an active uniform, from Shader::uniform. Setters ignore invalid handles, as GL ignores location -1.
+struct UniformHandle {
+    int location = -1;
+
+    bool valid() const {
+        return this->location >= 0;
+    }
+};
+
 class Shader {
 private:
     // the program ID
     unsigned int ID;
+    // Active uniforms reflected after linking, shared by copies of the shader.
+    std::shared_ptr<const UniformTable> uniforms;
 public:
 
     // constructor reads and builds the shader
@@ -22,32 +38,64 @@ public:
 
     unsigned int id() const;
 
-    // utility uniform functions
-    const Shader& setBool(const std::string& name, bool value) const;
-    const Shader& setInt(const std::string& name, int value) const;
-    const Shader& setFloat(const std::string& name, float value) const;
-    const Shader& setVec2(const std::string& name, const glm::vec2& value) const;
-    const Shader& setVec2(const std::string& name, float x, float y) const;
-    const Shader& setVec3(const std::string& name, const glm::vec3& value) const;
-    const Shader& setVec3(const std::string& name, float x, float y, float z) const;
-    const Shader& setVec4(const std::string& name, const glm::vec4& value) const;
-    const Shader& setVec4(const std::string& name, float x, float y, float z, float w) const;
-    const Shader& setMat2(const std::string& name, const glm::mat2& mat) const;
-    const Shader& setMat3(const std::string& name, const glm::mat3& mat) const;
-    const Shader& setMat4(const std::string& name, const glm::mat4& mat) const;
+    // Hashed lookup in the table of active uniforms, no GL call. Array elements are found as "name[i]" (and the
+    // first also as "name"). Resolve handles once for uniforms set every frame.
+    UniformHandle uniform(std::string_view name) const;
+    // Number of names in the table
+    std::size_t numUniforms() const;
+    // Points the uniform block `name` at a uniform buffer binding point (glUniformBlockBinding). Returns false if the
+    // program has no such active block.
+    bool bindUniformBlock(std::string_view name, unsigned int binding) const;
+
+    // utility uniform functions, by name (looked up in the table) or by handle
+    const Shader& setBool(std::string_view name, bool value) const;
+    const Shader& setInt(std::string_view name, int value) const;
+    const Shader& setFloat(std::string_view name, float value) const;
+    const Shader& setVec2(std::string_view name, const glm::vec2& value) const;
+    const Shader& setVec2(std::string_view name, float x, float y) const;
+    const Shader& setVec3(std::string_view name, const glm::vec3& value) const;
+    const Shader& setVec3(std::string_view name, float x, float y, float z) const;
+    const Shader& setVec4(std::string_view name, const glm::vec4& value) const;
+    const Shader& setVec4(std::string_view name, float x, float y, float z, float w) const;
+    const Shader& setMat2(std::string_view name, const glm::mat2& mat) const;
+    const Shader& setMat3(std::string_view name, const glm::mat3& mat) const;
+    const Shader& setMat4(std::string_view name, const glm::mat4& mat) const;
+
+    const Shader& setBool(UniformHandle uniform, bool value) const;
+    const Shader& setInt(UniformHandle uniform, int value) const;
+    const Shader& setFloat(UniformHandle uniform, float value) const;
+    const Shader& setVec2(UniformHandle uniform, const glm::vec2& value) const;
+    const Shader& setVec2(UniformHandle uniform, float x, float y) const;
+    const Shader& setVec3(UniformHandle uniform, const glm::vec3& value) const;
+    const Shader& setVec3(UniformHandle uniform, float x, float y, float z) const;
+    const Shader& setVec4(UniformHandle uniform, const glm::vec4& value) const;
+    const Shader& setVec4(UniformHandle uniform, float x, float y, float z, float w) const;
+    const Shader& setMat2(UniformHandle uniform, const glm::mat2& mat) const;
+    const Shader& setMat3(UniformHandle uniform, const glm::mat3& mat) const;
+    const Shader& setMat4(UniformHandle uniform, const glm::mat4& mat) const;
 
 #if ENGINE_CXX_OVERLOADS
-    const Shader& set(const std::string& name, bool value) const;
-    const Shader& set(const std::string& name, int value) const;
-    const Shader& set(const std::string& name, float value) const;
-    const Shader& set(const std::string& name, const glm::vec2& value) const;
-    const Shader& set(const std::string& name, float x, float y) const;
-    const Shader& set(const std::string& name, const glm::vec3& value) const;
-    const Shader& set(const std::string& name, float x, float y, float z) const;
-    const Shader& set(const std::string& name, const glm::vec4& value) const;
-    const Shader& set(const std::string& name, float x, float y, float z, float w) const;
-    const Shader& set(const std::string& name, const glm::mat2& mat) const;
-    const Shader& set(const std::string& name, const glm::mat3& mat) const;
-    const Shader& set(const std::string& name, const glm::mat4& mat) const;
+    const Shader& set(std::string_view name, bool value) const;
+    const Shader& set(std::string_view name, int value) const;
+    const Shader& set(std::string_view name, float value) const;
+    const Shader& set(std::string_view name, const glm::vec2& value) const;
+    const Shader& set(std::string_view name, float x, float y) const;
+    const Shader& set(std::string_view name, const glm::vec3& value) const;
+    const Shader& set(std::string_view name, float x, float y, float z) const;
+    const Shader& set(std::string_view name, const glm::vec4& value) const;
+    const Shader& set(std::string_view name, float x, float y, float z, float w) const;
+    const Shader& set(std::string_view name, const glm::mat2& mat) const;
+    const Shader& set(std::string_view name, const glm::mat3& mat) const;
+    const Shader& set(std::string_view name, const glm::mat4& mat) const;
+
+    const Shader& set(UniformHandle uniform, bool value) const;
+    const Shader& set(UniformHandle uniform, int value) const;
+    const Shader& set(UniformHandle uniform, float value) const;
+    const Shader& set(UniformHandle uniform, const glm::vec2& value) const;
+    const Shader& set(UniformHandle uniform, const glm::vec3& value) const;
+    const Shader& set(UniformHandle uniform, const glm::vec4& value) const;
+    const Shader& set(UniformHandle uniform, const glm::mat2& mat) const;
+    const Shader& set(UniformHandle uniform, const glm::mat3& mat) const;
+    const Shader& set(UniformHandle uniform, const glm::mat4& mat) const;
 #endif
 };
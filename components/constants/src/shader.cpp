@@ -3,9 +3,69 @@
 
 #include "glad/glad.h" // include glad to get all the required OpenGL headers
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <utility>
+#include <vector>
+
+// Open addressing with linear probing, at most half full so misses end quickly.
+struct UniformTable {
+    struct Entry {
+        std::uint64_t hash = 0;
+        int location = -1;
+        // Empty for unused slots
+        std::string name;
+    };
+
+    std::vector<Entry> slots;
+    std::size_t count = 0;
+
+    explicit UniformTable(std::vector<std::pair<std::string, int>> uniforms) {
+        std::size_t capacity = 16;
+        while (capacity < uniforms.size() * 2) {
+            capacity <<= 1;
+        }
+        this->slots.resize(capacity);
+        for (auto& [name, location] : uniforms) {
+            const std::uint64_t hash = Hash(name);
+            Entry& slot = this->slots[this->probe(name, hash)];
+            if (slot.name.empty()) {
+                slot.hash = hash;
+                slot.location = location;
+                slot.name = std::move(name);
+                this->count += 1;
+            }
+        }
+    }
+
+    int find(std::string_view name) const {
+        return this->slots[this->probe(name, Hash(name))].location;
+    }
+
+private:
+    // FNV-1a
+    static std::uint64_t Hash(std::string_view name) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const char c : name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Index of the slot holding `name`, or of the empty slot where it would go.
+    std::size_t probe(std::string_view name, const std::uint64_t hash) const {
+        const std::size_t mask = this->slots.size() - 1;
+        for (std::size_t i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+            const Entry& slot = this->slots[i];
+            if (slot.name.empty() || (slot.hash == hash && slot.name == name)) {
+                return i;
+            }
+        }
+    }
+};
 
 namespace {
     unsigned int CompileShader(const std::string& shaderSource, const GLuint& shaderType) {
@@ -71,9 +131,51 @@ namespace {
         }
         return success;
     }
+
+    // Every active uniform's location, enumerated once so setters don't need glGetUniformLocation.
+    std::shared_ptr<const UniformTable> ReflectUniforms(unsigned int shaderProgram) {
+        int linked = 0;
+        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            return nullptr;
+        }
+
+        int numActive = 0;
+        int maxLength = 0;
+        glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &numActive);
+        glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> buffer(static_cast<std::size_t>(std::max(maxLength, 1)));
+        std::vector<std::pair<std::string, int>> uniforms;
+        for (int i = 0; i < numActive; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(shaderProgram, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), static_cast<std::size_t>(length));
+            const int location = glGetUniformLocation(shaderProgram, name.c_str());
+            if (location < 0) {
+                // Members of uniform blocks have no location.
+                continue;
+            }
+
+            // Arrays are listed once, as "name[0]", with the number of elements that are used.
+            const std::string suffix = "[0]";
+            if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                const std::string base = name.substr(0, name.size() - suffix.size());
+                uniforms.emplace_back(base, location);
+                for (int element = 1; element < size; ++element) {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    const int elementLocation = glGetUniformLocation(shaderProgram, elementName.c_str());
+                    uniforms.emplace_back(std::move(elementName), elementLocation);
+                }
+            }
+            uniforms.emplace_back(std::move(name), location);
+        }
+        return std::make_shared<const UniformTable>(std::move(uniforms));
+    }
 }
 
-Shader::Shader(const std::string& vertexSrc, const std::string& fragmentSrc) : ID(CreateShaderProgram(vertexSrc, fragmentSrc)) {}
+Shader::Shader(const std::string& vertexSrc, const std::string& fragmentSrc) : ID(CreateShaderProgram(vertexSrc, fragmentSrc)), uniforms(ReflectUniforms(this->ID)) {}
 
 Shader Shader::from_file(const std::string& vertexPath, const std::string& fragmentPath) {
     // Helper function that reads the source code from each path, along with error messages.
@@ -117,6 +219,24 @@ unsigned int Shader::id() const {
     return this->ID;
 }
 
+UniformHandle Shader::uniform(std::string_view name) const {
+    return { this->uniforms ? this->uniforms->find(name) : -1 };
+}
+
+std::size_t Shader::numUniforms() const {
+    return this->uniforms ? this->uniforms->count : 0;
+}
+
+bool Shader::bindUniformBlock(std::string_view name, unsigned int binding) const {
+    const std::string terminated(name);
+    const GLuint index = glGetUniformBlockIndex(this->ID, terminated.c_str());
+    if (index == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(this->ID, index, binding);
+    return true;
+}
+
 bool Shader::valid() const {
     return this->ID > 0 && VerifyShaderProgram(this->ID);
 }
@@ -131,112 +251,196 @@ Shader& Shader::use() {
     return *this;
 }
 
-const Shader& Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(this->ID, name.c_str()), static_cast<int>(value));
+const Shader& Shader::setBool(std::string_view name, bool value) const {
+    return this->setBool(this->uniform(name), value);
+}
+
+const Shader& Shader::setInt(std::string_view name, int value) const {
+    return this->setInt(this->uniform(name), value);
+}
+
+const Shader& Shader::setFloat(std::string_view name, float value) const {
+    return this->setFloat(this->uniform(name), value);
+}
+
+const Shader& Shader::setVec2(std::string_view name, const glm::vec2& value) const {
+    return this->setVec2(this->uniform(name), value);
+}
+
+const Shader& Shader::setVec2(std::string_view name, float x, float y) const {
+    return this->setVec2(this->uniform(name), x, y);
+}
+
+const Shader& Shader::setVec3(std::string_view name, const glm::vec3& value) const {
+    return this->setVec3(this->uniform(name), value);
+}
+
+const Shader& Shader::setVec3(std::string_view name, float x, float y, float z) const {
+    return this->setVec3(this->uniform(name), x, y, z);
+}
+
+const Shader& Shader::setVec4(std::string_view name, const glm::vec4& value) const {
+    return this->setVec4(this->uniform(name), value);
+}
+
+const Shader& Shader::setVec4(std::string_view name, float x, float y, float z, float w) const {
+    return this->setVec4(this->uniform(name), x, y, z, w);
+}
+
+const Shader& Shader::setMat2(std::string_view name, const glm::mat2& mat) const {
+    return this->setMat2(this->uniform(name), mat);
+}
+
+const Shader& Shader::setMat3(std::string_view name, const glm::mat3& mat) const {
+    return this->setMat3(this->uniform(name), mat);
+}
+
+const Shader& Shader::setMat4(std::string_view name, const glm::mat4& mat) const {
+    return this->setMat4(this->uniform(name), mat);
+}
+
+const Shader& Shader::setBool(UniformHandle uniform, bool value) const {
+    glUniform1i(uniform.location, static_cast<int>(value));
     return *this;
 }
 
-const Shader& Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(this->ID, name.c_str()), value);
+const Shader& Shader::setInt(UniformHandle uniform, int value) const {
+    glUniform1i(uniform.location, value);
     return *this;
 }
 
-const Shader& Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(this->ID, name.c_str()), value);
+const Shader& Shader::setFloat(UniformHandle uniform, float value) const {
+    glUniform1f(uniform.location, value);
     return *this;
 }
 
-const Shader& Shader::setVec2(const std::string& name, const glm::vec2& value) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+const Shader& Shader::setVec2(UniformHandle uniform, const glm::vec2& value) const {
+    glUniform2fv(uniform.location, 1, &value[0]);
     return *this;
 }
 
-const Shader& Shader::setVec2(const std::string& name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+const Shader& Shader::setVec2(UniformHandle uniform, float x, float y) const {
+    glUniform2f(uniform.location, x, y);
     return *this;
 }
 
-const Shader& Shader::setVec3(const std::string& name, const glm::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+const Shader& Shader::setVec3(UniformHandle uniform, const glm::vec3& value) const {
+    glUniform3fv(uniform.location, 1, &value[0]);
     return *this;
 }
 
-const Shader& Shader::setVec3(const std::string& name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+const Shader& Shader::setVec3(UniformHandle uniform, float x, float y, float z) const {
+    glUniform3f(uniform.location, x, y, z);
     return *this;
 }
 
-const Shader& Shader::setVec4(const std::string& name, const glm::vec4& value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+const Shader& Shader::setVec4(UniformHandle uniform, const glm::vec4& value) const {
+    glUniform4fv(uniform.location, 1, &value[0]);
     return *this;
 }
 
-const Shader& Shader::setVec4(const std::string& name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+const Shader& Shader::setVec4(UniformHandle uniform, float x, float y, float z, float w) const {
+    glUniform4f(uniform.location, x, y, z, w);
     return *this;
 }
 
-const Shader& Shader::setMat2(const std::string& name, const glm::mat2& mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+const Shader& Shader::setMat2(UniformHandle uniform, const glm::mat2& mat) const {
+    glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     return *this;
 }
 
-const Shader& Shader::setMat3(const std::string& name, const glm::mat3& mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+const Shader& Shader::setMat3(UniformHandle uniform, const glm::mat3& mat) const {
+    glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     return *this;
 }
 
-const Shader& Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+const Shader& Shader::setMat4(UniformHandle uniform, const glm::mat4& mat) const {
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     return *this;
 }
 
 #if ENGINE_CXX_OVERLOADS
-const Shader& Shader::set(const std::string& name, bool value) const {
+const Shader& Shader::set(std::string_view name, bool value) const {
     return this->setBool(name, value);
 }
 
-const Shader& Shader::set(const std::string& name, int value) const {
+const Shader& Shader::set(std::string_view name, int value) const {
     return this->setInt(name, value);
 }
 
-const Shader& Shader::set(const std::string& name, float value) const {
+const Shader& Shader::set(std::string_view name, float value) const {
     return this->setFloat(name, value);
 }
 
-const Shader& Shader::set(const std::string& name, const glm::vec2& value) const {
+const Shader& Shader::set(std::string_view name, const glm::vec2& value) const {
     return this->setVec2(name, value);
 }
 
-const Shader& Shader::set(const std::string& name, float x, float y) const {
+const Shader& Shader::set(std::string_view name, float x, float y) const {
     return this->setVec2(name, x, y);
 }
 
-const Shader& Shader::set(const std::string& name, const glm::vec3& value) const {
+const Shader& Shader::set(std::string_view name, const glm::vec3& value) const {
     return this->setVec3(name, value);
 }
 
-const Shader& Shader::set(const std::string& name, float x, float y, float z) const {
+const Shader& Shader::set(std::string_view name, float x, float y, float z) const {
     return this->setVec3(name, x, y, z);
 }
 
-const Shader& Shader::set(const std::string& name, const glm::vec4& value) const {
+const Shader& Shader::set(std::string_view name, const glm::vec4& value) const {
     return this->setVec4(name, value);
 }
 
-const Shader& Shader::set(const std::string& name, float x, float y, float z, float w) const {
+const Shader& Shader::set(std::string_view name, float x, float y, float z, float w) const {
     return this->setVec4(name, x, y, z, w);
 }
 
-const Shader& Shader::set(const std::string& name, const glm::mat2& mat) const {
+const Shader& Shader::set(std::string_view name, const glm::mat2& mat) const {
     return this->setMat2(name, mat);
 }
 
-const Shader& Shader::set(const std::string& name, const glm::mat3& mat) const {
+const Shader& Shader::set(std::string_view name, const glm::mat3& mat) const {
     return this->setMat3(name, mat);
 }
 
-const Shader& Shader::set(const std::string& name, const glm::mat4& mat) const {
+const Shader& Shader::set(std::string_view name, const glm::mat4& mat) const {
     return this->setMat4(name, mat);
 }
+
+const Shader& Shader::set(UniformHandle uniform, bool value) const {
+    return this->setBool(uniform, value);
+}
+
+const Shader& Shader::set(UniformHandle uniform, int value) const {
+    return this->setInt(uniform, value);
+}
+
+const Shader& Shader::set(UniformHandle uniform, float value) const {
+    return this->setFloat(uniform, value);
+}
+
+const Shader& Shader::set(UniformHandle uniform, const glm::vec2& value) const {
+    return this->setVec2(uniform, value);
+}
+
+const Shader& Shader::set(UniformHandle uniform, const glm::vec3& value) const {
+    return this->setVec3(uniform, value);
+}
+
+const Shader& Shader::set(UniformHandle uniform, const glm::vec4& value) const {
+    return this->setVec4(uniform, value);
+}
+
+const Shader& Shader::set(UniformHandle uniform, const glm::mat2& mat) const {
+    return this->setMat2(uniform, mat);
+}
+
+const Shader& Shader::set(UniformHandle uniform, const glm::mat3& mat) const {
+    return this->setMat3(uniform, mat);
+}
+
+const Shader& Shader::set(UniformHandle uniform, const glm::mat4& mat) const {
+    return this->setMat4(uniform, mat);
+}
 #endif
@@ -34,7 +34,7 @@ private:
 	FramebufferDesc CreateEyeFrameBuffer(int width, int height);
 	void CreateCompanionWindow();
 
-	vr::IVRSystem* vr_pointer;
+	vr::IVRSystem* vr_pointer = nullptr;
 
 	// Shutdown
 	bool has_shutdown = false;
@@ -66,6 +66,9 @@ public:
 	~VRApplication();
 
 	void Init();
+	// Init split in two: the runtime needs no GL context (so can start on another thread), graphics does.
+	void InitRuntime();
+	void InitGraphics();
 	void Shutdown();
 	bool ShouldShutdown();
 
@@ -18,6 +18,11 @@ namespace {
 }
 
 void VRApplication::Init() {
+	this->InitRuntime();
+	this->InitGraphics();
+}
+
+void VRApplication::InitRuntime() {
 	vr::EVRInitError eError = vr::VRInitError_None;
 	this->vr_pointer = vr::VR_Init(&eError, vr::VRApplication_Scene);
 	if (eError != vr::VRInitError_None) {
@@ -38,7 +43,9 @@ void VRApplication::Init() {
 
 	// Setup render targets
 	this->vr_pointer->GetRecommendedRenderTargetSize(&this->renderWidth, &this->renderHeight);
+}
 
+void VRApplication::InitGraphics() {
 	// Setup frame buffers
 	this->leftFrameBufferDesc = this->CreateEyeFrameBuffer(static_cast<int>(this->renderWidth), static_cast<int>(this->renderHeight));
 	this->rightFrameBufferDesc = this->CreateEyeFrameBuffer(static_cast<int>(this->renderWidth), static_cast<int>(this->renderHeight));
@@ -8,6 +8,8 @@ option(GLAD_GENERATOR "glad generator" "c")
 set(GLAD_GENERATOR c)
 option(GLAD_REPRODUCIBLE "glad reproductible" OFF)
 option(GLAD_ALL_EXTENSIONS "glad enable extensions" OFF)
+# KHR_debug for GPU profiler debug groups (checked at runtime)
+set(GLAD_EXTENSIONS "GL_KHR_debug")
 fetch_extern(glad https://github.com/Dav1dde/glad ${GLAD_VERSION})
 if(NOT APPLE AND NOT WIN32)
 	target_compile_options(glad PUBLIC -fPIC)
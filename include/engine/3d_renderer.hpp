@@ -2,14 +2,36 @@
 #include <glad/glad.h>
 #include "glm/glm.hpp"
 
+#include "engine/bounds.hpp"
 #include "engine/renderer.hpp"
 
+// Camera state for 3D drawing. Shaders read it from a std140 uniform block backed by one buffer, which Upload
+// rewrites only after a setter changed something, so meshes and the skybox don't each get the matrices set.
 class Renderer3D : public Renderer {
 private:
-	glm::mat4 view;
-	glm::mat4 projection;
-    glm::vec3 cameraPos;
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+
+	unsigned int cameraBuffer = 0;
+	// Set by the setters, cleared by Upload
+	bool cameraChanged = true;
 public:
+	// Binding point of the camera block, after LightManager's.
+	static constexpr unsigned int cameraBinding = 3;
+	static constexpr const char* cameraBlock = "CameraBlock";
+	// Declares view, projection and viewPos. Add it to any stage of a shader and bind the program with
+	// Shader::bindUniformBlock(cameraBlock, cameraBinding).
+	static constexpr const char* cameraBlockSource =
+		"layout(std140) uniform CameraBlock {\n"
+		"   mat4 view;\n"
+		"   mat4 projection;\n"
+		"   vec3 viewPos;\n"
+		"};\n";
+
+	Renderer3D() = default;
+	~Renderer3D() = default;
+
 	void setProjectionMatrix(const glm::mat4 _projection);
 	void setViewMatrix(const glm::mat4& _view);
     void setCameraPosition(const glm::vec3& _cameraPos);
@@ -17,4 +39,13 @@ public:
 	const glm::mat4& getProjection() const;
 	const glm::mat4& getView() const;
     const glm::vec3& getCameraPos() const;
+	// View volume of the current projection and view, for culling.
+	Frustum getFrustum() const;
+
+	// Writes the camera block if a setter was called since the last Upload, and binds it to cameraBinding. Called
+	// once per frame by the engine; call it again before drawing after changing the camera mid-frame, e.g. per eye
+	// or shadow view. Requires a current GL context.
+	void Upload();
+	// Deletes the buffer, before the GL context goes away.
+	void Shutdown();
 };
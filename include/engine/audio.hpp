@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <map>
 #include <memory>
+#include <future>
 
 #if ENGINE_ENABLE_AUDIO
 #include "AL/al.h"
@@ -17,6 +19,8 @@
 
 #include <constants/position.hpp>
 
+#include "startup_trace.hpp"
+
 struct SoundDefinition {
 #if ENGINE_ENABLE_AUDIO
 	const static ALuint NUM_BUFFERS = 4;
@@ -59,7 +63,9 @@ struct SoundDefinition {
 
 class AudioEngine {
 public:
-	AudioEngine();
+	// A disabled engine never touches OpenAL (its device/context are process-wide), every call is a no-op.
+	// OpenAL is only brought up when the first sound is loaded (or by Init/InitAsync), `trace` records how long it took.
+	explicit AudioEngine(const bool enabled = true, StartupTrace* trace = nullptr);
 	~AudioEngine();
 
 	// Delete copy and move constructors & assignment
@@ -68,7 +74,11 @@ public:
 	AudioEngine(AudioEngine&&) = delete;
 	AudioEngine&& operator=(AudioEngine&&) = delete;
 
+	// Waits for a pending InitAsync first, so the device is only opened once.
 	void Init();
+	// Opens the device on a background thread, the first sound (or Init) waits for it.
+	void InitAsync();
+	bool isInitialized() const;
 	void Update();
 	void Shutdown();
 
@@ -85,9 +95,17 @@ public:
 */
 	bool IsPlaying(const std::string& strSoundName) const;
 	bool isLoaded(const std::string& soundName) const;
+	bool isEnabled() const;
 
 private:
+	bool enabled;
+	// Set by the InitAsync thread
+	std::atomic<bool> initialized;
 	bool isShutdown;
+	StartupTrace* trace;
+	std::future<void> pendingInit;
+
+	void openDevice();
 
 	using SoundMap = std::map<std::string, std::unique_ptr<SoundDefinition>>;
 	SoundMap sounds;
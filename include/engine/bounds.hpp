@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+// Axis-aligned box in 3D, empty (min > max) until something is added.
+struct Aabb3D {
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+	static Aabb3D FromCenterExtents(const glm::vec3& center, const glm::vec3& extents) {
+		return { center - extents, center + extents };
+	}
+
+	bool isEmpty() const {
+		return this->min.x > this->max.x || this->min.y > this->max.y || this->min.z > this->max.z;
+	}
+	glm::vec3 getCenter() const {
+		return (this->min + this->max) * 0.5f;
+	}
+	// Half the size along each axis
+	glm::vec3 getExtents() const {
+		return (this->max - this->min) * 0.5f;
+	}
+	float getSurfaceArea() const {
+		const glm::vec3 size = this->max - this->min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	void Expand(const glm::vec3& point) {
+		this->min = glm::min(this->min, point);
+		this->max = glm::max(this->max, point);
+	}
+	void Expand(const Aabb3D& other) {
+		this->min = glm::min(this->min, other.min);
+		this->max = glm::max(this->max, other.max);
+	}
+	Aabb3D Merged(const Aabb3D& other) const {
+		return { glm::min(this->min, other.min), glm::max(this->max, other.max) };
+	}
+	Aabb3D Inflated(const float margin) const {
+		return { this->min - glm::vec3(margin), this->max + glm::vec3(margin) };
+	}
+
+	bool Contains(const Aabb3D& other) const {
+		return glm::all(glm::lessThanEqual(this->min, other.min)) && glm::all(glm::greaterThanEqual(this->max, other.max));
+	}
+	bool Overlaps(const Aabb3D& other) const {
+		return glm::all(glm::lessThanEqual(this->min, other.max)) && glm::all(glm::lessThanEqual(other.min, this->max));
+	}
+	bool OverlapsSphere(const glm::vec3& center, const float radius) const {
+		const glm::vec3 closest = glm::clamp(center, this->min, this->max);
+		const glm::vec3 offset = closest - center;
+		return glm::dot(offset, offset) <= radius * radius;
+	}
+
+	// Box around this one after `transform` (an affine model matrix), without visiting the corners (Arvo's method).
+	Aabb3D Transformed(const glm::mat4& transform) const {
+		if (this->isEmpty()) {
+			return *this;
+		}
+		const glm::vec3 center = glm::vec3(transform * glm::vec4(this->getCenter(), 1.0f));
+		const glm::vec3 extents = this->getExtents();
+		glm::vec3 transformed(0.0f);
+		for (int column = 0; column < 3; ++column) {
+			transformed += glm::abs(glm::vec3(transform[column])) * extents[column];
+		}
+		return FromCenterExtents(center, transformed);
+	}
+};
+
+struct Ray {
+	glm::vec3 origin = glm::vec3(0.0f);
+	// Normalised for distances to be in world units
+	glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+
+	// Ray through a pixel, for picking. `screen` is in pixels from the top left of a viewport of `viewportSize`.
+	static Ray FromScreen(const glm::vec2& screen, const glm::vec2& viewportSize, const glm::mat4& view, const glm::mat4& projection) {
+		const glm::vec2 ndc(2.0f * screen.x / viewportSize.x - 1.0f, 1.0f - 2.0f * screen.y / viewportSize.y);
+		const glm::mat4 inverse = glm::inverse(projection * view);
+		glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+		nearPoint /= nearPoint.w;
+		farPoint /= farPoint.w;
+		return { glm::vec3(nearPoint), glm::normalize(glm::vec3(farPoint - nearPoint)) };
+	}
+
+	// Slab test: distance along the ray where it enters the box (0 when starting inside), or a negative value on a miss.
+	float Intersect(const Aabb3D& box, const float maxDistance = std::numeric_limits<float>::max()) const {
+		const glm::vec3 inverse = 1.0f / this->direction;
+		const glm::vec3 t1 = (box.min - this->origin) * inverse;
+		const glm::vec3 t2 = (box.max - this->origin) * inverse;
+		const glm::vec3 near = glm::min(t1, t2);
+		const glm::vec3 far = glm::max(t1, t2);
+		const float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+		const float exit = std::min(std::min(far.x, far.y), std::min(far.z, maxDistance));
+		return enter <= exit ? enter : -1.0f;
+	}
+};
+
+// The six planes of a camera's view volume, normals pointing inwards.
+struct Frustum {
+	// xyz normal, w distance: a point p is inside when dot(normal, p) + w >= 0
+	std::array<glm::vec4, 6> planes;
+
+	enum class Test {
+		Outside,
+		Intersects,
+		Inside
+	};
+
+	// From projection * view (GL clip space, z in [-w, w]), Gribb-Hartmann plane extraction.
+	static Frustum FromMatrix(const glm::mat4& viewProjection) {
+		const glm::mat4 m = glm::transpose(viewProjection);
+		Frustum frustum;
+		frustum.planes = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+		for (auto& plane : frustum.planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	// Conservative: boxes near a corner of the frustum may report Intersects while being just outside.
+	Test Classify(const Aabb3D& box) const {
+		Test result = Test::Inside;
+		for (const auto& plane : this->planes) {
+			const glm::vec3 normal(plane);
+			// Corner furthest along the normal, and the one furthest against it
+			const glm::vec3 positive = glm::mix(box.min, box.max, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+			const glm::vec3 negative = glm::mix(box.max, box.min, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+			if (glm::dot(normal, positive) + plane.w < 0.0f) {
+				return Test::Outside;
+			}
+			if (glm::dot(normal, negative) + plane.w < 0.0f) {
+				result = Test::Intersects;
+			}
+		}
+		return result;
+	}
+
+	bool Intersects(const Aabb3D& box) const {
+		return this->Classify(box) != Test::Outside;
+	}
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "engine/bounds.hpp"
+
+// Dynamic bounding volume hierarchy for placed objects (model instances, props), used for frustum culling,
+// sphere queries and ray picking. Leaves store a "fat" box, the object's box grown by a margin, so small moves leave
+// the tree untouched; once a box leaves its fat box the leaf is reinserted and its ancestors refitted.
+// Insertion picks the sibling with the lowest surface-area cost and the tree is rebalanced with rotations on the way
+// up, so the height stays logarithmic whatever order objects are added in.
+// Not thread-safe to modify; queries are const and may run concurrently.
+class DynamicBvh {
+public:
+	using ProxyId = std::int32_t;
+	static constexpr ProxyId nullProxy = -1;
+
+	static constexpr float defaultMargin = 0.1f;
+
+	explicit DynamicBvh(const float margin = defaultMargin);
+
+	// `userData` is handed back by getUserData, e.g. an entity or instance index.
+	ProxyId Insert(const Aabb3D& box, const std::uint32_t userData);
+	void Remove(const ProxyId proxy);
+	// True if the leaf had to be reinserted, false if the new box still fits its fat box.
+	bool Move(const ProxyId proxy, const Aabb3D& box);
+	void Clear();
+
+	const Aabb3D& getFatBounds(const ProxyId proxy) const;
+	std::uint32_t getUserData(const ProxyId proxy) const;
+	std::size_t size() const;
+	// 0 when empty or a single leaf
+	int getHeight() const;
+	float getMargin() const;
+
+	// f(ProxyId) for every leaf whose fat box overlaps `box`.
+	template<typename F>
+	void QueryAabb(const Aabb3D& box, F&& f) const;
+	// f(ProxyId) for every leaf whose fat box is not outside `frustum`.
+	// Subtrees fully inside are reported without testing their leaves.
+	template<typename F>
+	void QueryFrustum(const Frustum& frustum, F&& f) const;
+	// f(ProxyId) for every leaf whose fat box overlaps the sphere.
+	template<typename F>
+	void QuerySphere(const glm::vec3& center, const float radius, F&& f) const;
+	// Closest hit along `ray` within maxDistance. f(ProxyId, float maxDistance) is called for every leaf whose fat box
+	// the ray enters closer than the best hit so far; it returns the exact hit distance, or a negative value for a miss
+	// (return the box distance from ray.Intersect(getFatBounds(proxy)) when boxes are precise enough).
+	// Returns nullProxy if nothing was hit, `hitDistance` is only written on a hit.
+	template<typename F>
+	ProxyId RayCast(const Ray& ray, const float maxDistance, F&& f, float* hitDistance = nullptr) const;
+
+private:
+	struct Node {
+		Aabb3D box;
+		ProxyId parent = nullProxy;
+		// Doubles as the free list link for unused nodes
+		ProxyId left = nullProxy;
+		ProxyId right = nullProxy;
+		// 0 for leaves, -1 for free nodes
+		int height = -1;
+		std::uint32_t userData = 0;
+
+		bool isLeaf() const {
+			return this->right == nullProxy;
+		}
+	};
+
+	float margin;
+	ProxyId root = nullProxy;
+	ProxyId freeList = nullProxy;
+	std::size_t leafCount = 0;
+	std::vector<Node> nodes;
+
+	ProxyId allocateNode();
+	void freeNode(const ProxyId index);
+	void insertLeaf(const ProxyId leaf);
+	void removeLeaf(const ProxyId leaf);
+	ProxyId findBestSibling(const Aabb3D& box) const;
+	// Refits and rebalances from `index` up to the root.
+	void refitAncestors(ProxyId index);
+	// Rotates the taller grandchild up if `index`'s children differ in height by more than one, returns the subtree root.
+	ProxyId balance(const ProxyId index);
+	const Node& checkedLeaf(const ProxyId proxy) const;
+
+	// Depth-first traversal, visit(node) returns whether to descend into a branch.
+	template<typename Visit>
+	void traverse(Visit&& visit) const;
+};
+
+template<typename Visit>
+void DynamicBvh::traverse(Visit&& visit) const {
+	if (this->root == nullProxy) {
+		return;
+	}
+	std::vector<ProxyId> stack;
+	stack.reserve(64);
+	stack.push_back(this->root);
+	while (!stack.empty()) {
+		const ProxyId index = stack.back();
+		stack.pop_back();
+		const Node& node = this->nodes[static_cast<std::size_t>(index)];
+		if (visit(index, node) && !node.isLeaf()) {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+}
+
+template<typename F>
+void DynamicBvh::QueryAabb(const Aabb3D& box, F&& f) const {
+	this->traverse([&box, &f](const ProxyId index, const Node& node) {
+		if (!node.box.Overlaps(box)) {
+			return false;
+		}
+		if (node.isLeaf()) {
+			f(index);
+		}
+		return true;
+	});
+}
+
+template<typename F>
+void DynamicBvh::QueryFrustum(const Frustum& frustum, F&& f) const {
+	std::vector<ProxyId> inside;
+	this->traverse([this, &frustum, &f, &inside](const ProxyId index, const Node& node) {
+		const Frustum::Test test = frustum.Classify(node.box);
+		if (test == Frustum::Test::Outside) {
+			return false;
+		}
+		if (node.isLeaf()) {
+			f(index);
+			return false;
+		}
+		if (test == Frustum::Test::Inside) {
+			// Everything below is visible, collect the leaves without any more plane tests.
+			inside.push_back(index);
+			while (!inside.empty()) {
+				const ProxyId next = inside.back();
+				inside.pop_back();
+				const Node& child = this->nodes[static_cast<std::size_t>(next)];
+				if (child.isLeaf()) {
+					f(next);
+				} else {
+					inside.push_back(child.left);
+					inside.push_back(child.right);
+				}
+			}
+			return false;
+		}
+		return true;
+	});
+}
+
+template<typename F>
+void DynamicBvh::QuerySphere(const glm::vec3& center, const float radius, F&& f) const {
+	this->traverse([&center, radius, &f](const ProxyId index, const Node& node) {
+		if (!node.box.OverlapsSphere(center, radius)) {
+			return false;
+		}
+		if (node.isLeaf()) {
+			f(index);
+		}
+		return true;
+	});
+}
+
+template<typename F>
+DynamicBvh::ProxyId DynamicBvh::RayCast(const Ray& ray, const float maxDistance, F&& f, float* hitDistance) const {
+	ProxyId closest = nullProxy;
+	float best = maxDistance;
+	if (this->root == nullProxy || ray.Intersect(this->nodes[static_cast<std::size_t>(this->root)].box, best) < 0.0f) {
+		return nullProxy;
+	}
+	// Nodes with the distance the ray enters them, the nearer child is visited first so later ones can be skipped.
+	std::vector<std::pair<ProxyId, float>> stack;
+	stack.reserve(64);
+	stack.emplace_back(this->root, 0.0f);
+	while (!stack.empty()) {
+		const auto [index, enter] = stack.back();
+		stack.pop_back();
+		if (enter > best) {
+			continue;
+		}
+		const Node& node = this->nodes[static_cast<std::size_t>(index)];
+		if (node.isLeaf()) {
+			const float distance = f(index, best);
+			if (distance >= 0.0f && distance <= best) {
+				best = distance;
+				closest = index;
+			}
+			continue;
+		}
+		const float enterLeft = ray.Intersect(this->nodes[static_cast<std::size_t>(node.left)].box, best);
+		const float enterRight = ray.Intersect(this->nodes[static_cast<std::size_t>(node.right)].box, best);
+		const bool leftFirst = enterRight < 0.0f || (enterLeft >= 0.0f && enterLeft <= enterRight);
+		const ProxyId first = leftFirst ? node.left : node.right;
+		const ProxyId second = leftFirst ? node.right : node.left;
+		const float enterFirst = leftFirst ? enterLeft : enterRight;
+		const float enterSecond = leftFirst ? enterRight : enterLeft;
+		if (enterSecond >= 0.0f) {
+			stack.emplace_back(second, enterSecond);
+		}
+		if (enterFirst >= 0.0f) {
+			stack.emplace_back(first, enterFirst);
+		}
+	}
+	if (closest != nullProxy && hitDistance) {
+		*hitDistance = best;
+	}
+	return closest;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque (Le et al. 2013, "Correct and Efficient Work-Stealing for Weak Memory Models").
+// The owning thread pushes and takes at the bottom, any thread may steal from the top.
+// Holds pointers, nullptr means empty (or a lost race for a steal).
+template<typename T>
+class ChaseLevDeque {
+public:
+	explicit ChaseLevDeque(const std::size_t initialCapacity = 1024) {
+		std::size_t capacity = 1;
+		while (capacity < initialCapacity) {
+			capacity <<= 1;
+		}
+		this->arrays.push_back(std::make_unique<Array>(capacity));
+		this->array.store(this->arrays.back().get(), std::memory_order_relaxed);
+	}
+
+	// Not copyable
+	ChaseLevDeque(const ChaseLevDeque&) = delete;
+	ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+	// Owner only
+	void Push(T* item) {
+		const std::int64_t b = this->bottom.load(std::memory_order_relaxed);
+		const std::int64_t t = this->top.load(std::memory_order_acquire);
+		Array* a = this->array.load(std::memory_order_relaxed);
+		if (b - t > static_cast<std::int64_t>(a->capacity) - 1) {
+			a = this->grow(a, b, t);
+		}
+		a->Put(b, item);
+		this->bottom.store(b + 1, std::memory_order_release);
+	}
+
+	// Owner only, LIFO
+	T* Take() {
+		const std::int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+		Array* a = this->array.load(std::memory_order_relaxed);
+		this->bottom.store(b, std::memory_order_seq_cst);
+		std::int64_t t = this->top.load(std::memory_order_seq_cst);
+		if (t > b) {
+			// Empty
+			this->bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T* item = a->Get(b);
+		if (t == b) {
+			// Last item, race the thieves for it.
+			if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				item = nullptr;
+			}
+			this->bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	// Any thread, FIFO
+	T* Steal() {
+		std::int64_t t = this->top.load(std::memory_order_seq_cst);
+		const std::int64_t b = this->bottom.load(std::memory_order_seq_cst);
+		if (t >= b) {
+			return nullptr;
+		}
+		Array* a = this->array.load(std::memory_order_acquire);
+		T* item = a->Get(t);
+		if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return item;
+	}
+
+	// Approximate when other threads are pushing/taking.
+	bool empty() const {
+		return this->bottom.load(std::memory_order_relaxed) <= this->top.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Array {
+		std::size_t capacity;
+		std::unique_ptr<std::atomic<T*>[]> items;
+
+		explicit Array(const std::size_t _capacity) : capacity(_capacity), items(std::make_unique<std::atomic<T*>[]>(_capacity)) {}
+
+		T* Get(const std::int64_t i) const {
+			return this->items[static_cast<std::size_t>(i) & (this->capacity - 1)].load(std::memory_order_relaxed);
+		}
+
+		void Put(const std::int64_t i, T* item) {
+			this->items[static_cast<std::size_t>(i) & (this->capacity - 1)].store(item, std::memory_order_relaxed);
+		}
+	};
+
+	alignas(64) std::atomic<std::int64_t> top{0};
+	alignas(64) std::atomic<std::int64_t> bottom{0};
+	std::atomic<Array*> array{nullptr};
+	// Thieves may still be reading an old array after a grow, so they are only freed with the deque.
+	std::vector<std::unique_ptr<Array>> arrays;
+
+	Array* grow(Array* old, const std::int64_t b, const std::int64_t t) {
+		auto bigger = std::make_unique<Array>(old->capacity * 2);
+		for (std::int64_t i = t; i < b; ++i) {
+			bigger->Put(i, old->Get(i));
+		}
+		Array* a = bigger.get();
+		this->arrays.push_back(std::move(bigger));
+		this->array.store(a, std::memory_order_release);
+		return a;
+	}
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#if ENGINE_ENABLE_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <utility>
+
+#include "gl_command_queue.hpp"
+
+template<typename T = void>
+class CoTask;
+
+// Shared by every CoTask promise: who to resume when done, and the exception if it threw.
+class CoTaskPromiseBase {
+public:
+	class FinalAwaiter {
+	public:
+		bool await_ready() noexcept {
+			return false;
+		}
+
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+			CoTaskPromiseBase& promise = handle.promise();
+			if (promise.continuation) {
+				// Symmetric transfer, so long co_await chains don't grow the stack.
+				return promise.continuation;
+			}
+			if (promise.detached) {
+				promise.reportDetachedException();
+				handle.destroy();
+			}
+			return std::noop_coroutine();
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	std::suspend_always initial_suspend() noexcept {
+		return {};
+	}
+
+	FinalAwaiter final_suspend() noexcept {
+		return {};
+	}
+
+	void unhandled_exception() noexcept {
+		this->exception = std::current_exception();
+	}
+
+protected:
+	template<typename U>
+	friend class CoTask;
+
+	std::coroutine_handle<> continuation;
+	std::exception_ptr exception;
+	// Started with CoTask::Detach, nobody will co_await it so it frees itself.
+	bool detached = false;
+
+	void rethrowIfFailed() const {
+		if (this->exception) {
+			std::rethrow_exception(this->exception);
+		}
+	}
+
+	void reportDetachedException() const noexcept {
+		if (!this->exception) {
+			return;
+		}
+		try {
+			std::rethrow_exception(this->exception);
+		} catch (const std::exception& e) {
+			std::cerr << "Unhandled exception in detached coroutine: " << e.what() << std::endl;
+		} catch (...) {
+			std::cerr << "Unhandled exception in detached coroutine" << std::endl;
+		}
+	}
+};
+
+// Lazily started coroutine, runs when first co_awaited (or detached) and resumes the awaiting coroutine when done.
+// Exceptions are rethrown from the co_await. Where it continues after a suspension depends on what it awaited:
+// Scheduler::schedule() moves it to a worker, Scheduler::nextFrame() and ResumeOn(GLCommandQueue&) to the main thread.
+template<typename T>
+class [[nodiscard]] CoTask {
+public:
+	class promise_type;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	class promise_type : public CoTaskPromiseBase {
+	public:
+		CoTask get_return_object() {
+			return CoTask(Handle::from_promise(*this));
+		}
+
+		template<typename U>
+		void return_value(U&& _value) {
+			this->value.emplace(std::forward<U>(_value));
+		}
+
+		T result() {
+			this->rethrowIfFailed();
+			return std::move(*this->value);
+		}
+
+	private:
+		std::optional<T> value;
+	};
+
+	CoTask() = default;
+	explicit CoTask(Handle _handle) : handle(_handle) {}
+	~CoTask() {
+		if (this->handle) {
+			this->handle.destroy();
+		}
+	}
+
+	// Not copyable
+	CoTask(const CoTask&) = delete;
+	CoTask& operator=(const CoTask&) = delete;
+
+	CoTask(CoTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+	CoTask& operator=(CoTask&& other) noexcept {
+		if (this != &other) {
+			if (this->handle) {
+				this->handle.destroy();
+			}
+			this->handle = std::exchange(other.handle, {});
+		}
+		return *this;
+	}
+
+	bool valid() const {
+		return static_cast<bool>(this->handle);
+	}
+	bool isDone() const {
+		return this->handle && this->handle.done();
+	}
+
+	bool await_ready() const noexcept {
+		return !this->handle || this->handle.done();
+	}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+		this->handle.promise().continuation = awaiting;
+		return this->handle;
+	}
+	T await_resume() {
+		return this->handle.promise().result();
+	}
+
+	// Starts it on the calling thread and lets it run to completion on its own, see Scheduler::Spawn.
+	void Detach() && {
+		Handle started = std::exchange(this->handle, {});
+		if (!started) {
+			return;
+		}
+		started.promise().detached = true;
+		started.resume();
+	}
+
+private:
+	Handle handle;
+};
+
+template<>
+class CoTask<void>::promise_type : public CoTaskPromiseBase {
+public:
+	CoTask get_return_object() {
+		return CoTask(Handle::from_promise(*this));
+	}
+
+	void return_void() noexcept {}
+
+	void result() {
+		this->rethrowIfFailed();
+	}
+};
+
+// co_await ResumeOn(queue): continues on the thread owning `queue`'s GL context (right away when already there).
+// Commands queued before it from the same thread have run by the time it resumes.
+class ResumeOn {
+public:
+	explicit ResumeOn(GLCommandQueue& _queue) : queue(&_queue) {}
+
+	bool await_ready() const {
+		return this->queue->isOwnerThread();
+	}
+	void await_suspend(std::coroutine_handle<> handle) {
+		this->queue->Submit([handle]() { handle.resume(); });
+	}
+	void await_resume() const noexcept {}
+
+private:
+	GLCommandQueue* queue;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
+#include <atomic>
+
 #if ENGINE_ENABLE_JSON
 #include <nlohmann/json.hpp>
 #endif
@@ -20,12 +22,27 @@
 #include "scheduler.hpp"
 #include "3d_renderer.hpp"
 #include "light_manager.hpp"
+#include "frame_pipeline.hpp"
+#include "frame_pacer.hpp"
+#include "input_queue.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
+#include "gpu_profiler.hpp"
+#include "engine_config.hpp"
+#include "startup_trace.hpp"
+#include "frame_arena.hpp"
+#include "gl_command_queue.hpp"
+#include "coroutine.hpp"
+#include "model_fwd.hpp"
 
 #include <constants/size.hpp>
 #include <constants/screen_size.hpp>
 
 class Engine {
 private:
+	EngineConfig config;
+	// Constructed first so its origin is the start of the Engine constructor.
+	StartupTrace startupTrace;
 	ScreenSize SCREEN_SIZE;
 	std::shared_ptr<Game> game = nullptr;
 
@@ -36,20 +53,65 @@ private:
 	std::unique_ptr<TextRenderer> textRenderer = nullptr;
 	ResourceManager resourceManager;
 	Scheduler scheduler;
+	// Per-thread scratch memory, reset at the end of every frame.
+	FrameMemory frameMemory;
+	// GL work queued by other threads, run on the main thread at the start of each frame.
+	GLCommandQueue glCommands;
+	GLCommandQueue::Clock::duration glCommandBudget = std::chrono::milliseconds(2);
+	Profiler profiler;
+	GpuProfiler gpuProfiler;
 
 #if ENGINE_ENABLE_VR
 	VRApplication vr;
 #endif
-	unsigned short leftStrength;
-	unsigned short rightStrength;
+	unsigned short leftStrength = 0;
+	unsigned short rightStrength = 0;
 
 	double deltaTime = 0.0;
 	double lastFrame = 0.0;
+	std::size_t frameNumber = 0;
+	double runTime = 0.0;
+
+	// Fixed timestep simulation
+	bool useFixedTimestep = false;
+	double fixedTimestep = 1.0 / 60.0;
+	unsigned int maxCatchUpSteps = 5;
+	double accumulator = 0.0;
+
+	// Runs input & update for the current frame, returns the interpolation alpha for rendering.
+	double stepSimulation(const double& frameTime);
+
+	// Pipelined update/render, 0 when disabled
+	std::size_t numStateBuffers = 0;
+	FramePipeline pipeline;
+
+	// Frame pacing
+	FramePacer pacer;
+	VSyncMode vsync = VSyncMode::On;
+	bool idleMode = false;
+	double idleTimeout = 0.5;
+
+	// Input, queued by key_callback and dispatched to the game at the start of the next simulation tick.
+	InputQueue inputQueue;
+	InputLatencyProbe inputLatency;
+	// Timestamps of events the last simulation step consumed, and of those the next swap will present.
+	std::vector<Profiler::Clock::time_point> steppedInput;
+	std::vector<Profiler::Clock::time_point> presentedInput;
+	void dispatchInput();
+	void collectSteppedInput();
 
 	// OpenGL Window
-	GLFWwindow* app_window;
+	GLFWwindow* app_window = nullptr;
+
+	std::atomic<bool> stopRequested{false};
 
+	void init_subsystems();
 	void init_opengl();
+	// Only windowed runs drive VR, headless ones run where no VR runtime is installed (CI, benchmarks).
+	bool usesVR() const;
+	void runSimulation();
+	void writeSummaryIfRequested() const;
+	void writeTraceIfRequested() const;
 	void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
 	// Utility Functions
@@ -60,8 +122,8 @@ private:
 	// Debug
 	Colour clearColour = Colour::black;
 public:
-	Engine(std::shared_ptr<Game> _g);
-	Engine(const ScreenSize& size, std::shared_ptr<Game> _g);
+	Engine(std::shared_ptr<Game> _g, const EngineConfig& _config = {});
+	Engine(const ScreenSize& size, std::shared_ptr<Game> _g, const EngineConfig& _config = {});
 	~Engine();
 
 	// Delete Copy Operators
@@ -79,12 +141,55 @@ public:
 
 	// Runs the Render Loop
 	void run();
+	// Makes run() return after the current frame, safe to call from any thread.
+	void requestStop();
+	// False in EngineMode::Simulation, where no window, GL context, audio, text or VR exists.
+	bool isRendering() const;
+
+	// Simulation
+	// Runs ProcessInput/Update at `tickRate` Hz, at most `maxCatchUp` ticks per frame.
+	void setFixedTimestep(const double tickRate, const unsigned int maxCatchUp = 5);
+	void disableFixedTimestep();
+	bool isFixedTimestep() const;
+	double getFixedTimestep() const;
+	// How far between the last fixed tick and the next one we are, what RenderInterpolated gets (1.0 when not fixed).
+	double getInterpolationAlpha() const;
+
+	// Overlap Game::Update for the next frame with rendering of the current one.
+	// Requires the game to implement PublishState/RenderState and return true from PublishesState, throws
+	// std::logic_error otherwise. `stateBuffers` must be 2 or 3.
+	void enablePipelining(const std::size_t stateBuffers = 2);
+	void disablePipelining();
+	bool isPipelined() const;
+
+	// Frame pacing
+	// Caps the render loop at `fps` (0 for uncapped), sleeping most of the remaining frame time instead of spinning.
+	void setTargetFrameRate(const double fps);
+	double getTargetFrameRate() const;
+	// Returns the mode actually applied (Adaptive falls back to On when the driver lacks swap_control_tear).
+	VSyncMode setVSync(const VSyncMode mode);
+	VSyncMode getVSync() const;
+	// While Game::NeedsRedraw() is false, block on input events for up to `timeout` seconds instead of polling.
+	void enableIdleMode(const double timeout = 0.5);
+	void disableIdleMode();
+	bool isIdleMode() const;
+	// How far achieved frame times are from the target (milliseconds).
+	ProfileStats getPacingStats() const;
+	FramePacer* getFramePacer();
+
+	// Input
+	// Queues an event as if GLFW had reported it, must be called from the main thread.
+	bool pushInput(const InputEvent& event);
+	// Input-to-photon latency, from the event to the glfwSwapBuffers presenting the first frame that saw it (milliseconds).
+	ProfileStats getInputLatencyStats() const;
+	std::uint64_t getDroppedInputCount() const;
 
 	// Debug
 	void setClearColour(const Colour& colour);
 
 
 	// 3D
+	// Camera and lights are read on the render thread, when pipelined only change them from Game::RenderState.
 	Renderer3D* get3DRenderer();
     // Lighting (3D)
     LightManager* getLightManager();
@@ -98,6 +203,7 @@ public:
 	AudioEngine* getAudioEngine();
 
 	// Text
+	// Created on first call (main thread only), nullptr in simulation mode.
 	TextRenderer* getTextRenderer();
 
 	// Resources
@@ -105,6 +211,45 @@ public:
 
 	// Resources
 	Scheduler* getScheduler();
+	// The calling thread's frame arena, everything allocated from it is released at the end of the frame.
+	// Use it (or FrameAllocator / FrameVector / FrameString) for transient work instead of the global heap.
+	FrameArena* getFrameArena();
+
+	// GPU work from other threads
+	// Loader/worker tasks submit GL calls here, the main thread runs them before the frame's update (inline when it submits itself).
+	// Nothing drains the queue in simulation mode.
+	GLCommandQueue* getGLCommandQueue();
+	// Time spent on queued GL commands per frame (seconds), so background loads can't cause hitches.
+	// At least one command runs every frame regardless.
+	void setGLCommandBudget(const double seconds);
+	double getGLCommandBudget() const;
+
+#if ENGINE_ENABLE_COROUTINES
+	// Coroutines, see also Scheduler::schedule/nextFrame/Spawn
+	// co_await engine->mainThread(): continues on the main (GL) thread, within the frame's GL command budget.
+	// Throws std::logic_error in EngineMode::Simulation, which has no main (GL) thread.
+	ResumeOn mainThread();
+	// Imports on a worker and decodes textures there, then builds the meshes on the main thread.
+	// Like mainThread, throws std::logic_error in EngineMode::Simulation.
+	// Same state as constructing the Model (call Init next), defined with the rest of the model loading.
+	CoTask<std::unique_ptr<Model>> loadModel(std::string path);
+#endif
+
+	// Profiling
+	Profiler* getProfiler();
+	// Stats over the profiler history (milliseconds)
+	ProfileStats getFrameStats(const FramePhase phase = FramePhase::Frame) const;
+	ProfileStats getZoneStats(const std::string& zone) const;
+	GpuProfiler* getGpuProfiler();
+	// JSON summary of the frame timings (what headless mode writes when run() returns).
+	void writeFrameSummary(std::ostream& out) const;
+
+	// Time-to-first-frame broken down by subsystem
+	const StartupTrace& getStartupTrace() const;
+
+	const EngineConfig& getConfig() const;
+	// Frames completed by run() so far.
+	std::size_t getFrameNumber() const;
 
 	// VR
 	void Update_VR_vibration(const unsigned short leftStrength, const unsigned short rightStrength);
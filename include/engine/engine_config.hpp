@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+enum class EngineMode {
+	// Visible window, the default
+	Windowed,
+	// Hidden GLFW window, for benchmarking and CI. Still needs a display (e.g. Xvfb) unless useOSMesa is set, VR is
+	// never started.
+	Headless,
+	// No window, GL, audio, text or VR; only Game::Init/ProcessInput/Update are driven.
+	// Touches no process-wide state, so many instances can run on separate threads.
+	Simulation
+};
+
+// Options fixed at Engine construction.
+struct EngineConfig {
+	EngineMode mode = EngineMode::Windowed;
+
+	// Stop run() after this many frames, 0 runs until the window is closed.
+	std::size_t frameCount = 0;
+	// When > 0, used as every frame's delta time instead of the measured one (deterministic runs).
+	double fixedDeltaTime = 0.0;
+
+	// Headless only: create the context through OSMesa instead of a hidden window (needs GLFW built with OSMesa).
+	bool useOSMesa = false;
+	// Headless/Simulation: where the JSON frame timing summary is written when run() returns, empty for stdout.
+	std::string summaryPath = "";
+	// When set, events are traced from the start of run() and written there as Chrome trace JSON when it returns.
+	// The tracer is process-wide: engines tracing at the same time share one recording, which runs until the last of
+	// them returns, so each file also holds the events of the other engines that overlapped it.
+	std::string tracePath = "";
+	// Seconds of trace to keep in that file (the end of the run), 0 for everything the buffers hold.
+	double traceWindow = 0.0;
+
+	static EngineConfig Headless(const std::size_t frames, const double dt = 1.0 / 60.0) {
+		EngineConfig config;
+		config.mode = EngineMode::Headless;
+		config.frameCount = frames;
+		config.fixedDeltaTime = dt;
+		return config;
+	}
+
+	static EngineConfig Simulation(const std::size_t frames, const double dt = 1.0 / 60.0) {
+		EngineConfig config;
+		config.mode = EngineMode::Simulation;
+		config.frameCount = frames;
+		config.fixedDeltaTime = dt;
+		return config;
+	}
+};
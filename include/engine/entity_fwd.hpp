@@ -0,0 +1,7 @@
+#pragma once
+#include "generational_handle.hpp"
+
+// Handle to an entity in an EntityRegistry, generations wrap after 1024 reuses of the same slot.
+using Entity = GenerationalHandle<22>;
+
+class EntityRegistry;
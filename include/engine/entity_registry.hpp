@@ -0,0 +1,395 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "entity_fwd.hpp"
+#include "scheduler.hpp"
+
+// Process-wide dense ids for component types, used to index the registry's pools.
+class ComponentType {
+public:
+	template<typename T>
+	static std::size_t id() {
+		static const std::size_t value = next();
+		return value;
+	}
+
+private:
+	static std::size_t next();
+};
+
+// Sparse set: `sparse` maps entity index to a position in the dense arrays, which stay packed (swap and pop on removal).
+class ComponentPoolBase {
+public:
+	static constexpr std::uint32_t npos = ~0u;
+
+	ComponentPoolBase() = default;
+	virtual ~ComponentPoolBase() = default;
+
+	// Not copyable
+	ComponentPoolBase(const ComponentPoolBase&) = delete;
+	ComponentPoolBase& operator=(const ComponentPoolBase&) = delete;
+
+	// Does nothing if the entity has no such component.
+	virtual void Remove(const Entity entity) = 0;
+
+	// Position of the entity's component in the dense arrays, npos if it has none.
+	std::uint32_t indexOf(const Entity entity) const;
+	bool contains(const Entity entity) const {
+		return this->indexOf(entity) != npos;
+	}
+	std::size_t size() const {
+		return this->entities.size();
+	}
+	// Owner of each component, in dense order.
+	const std::vector<Entity>& getEntities() const {
+		return this->entities;
+	}
+	// Changes whenever a component is added or removed, queries rebuild when it does.
+	std::uint64_t getVersion() const {
+		return this->version;
+	}
+
+protected:
+	std::vector<std::uint32_t> sparse;
+	std::vector<Entity> entities;
+	std::uint64_t version = 0;
+
+	// Adds `entity` at the end of the dense arrays, returns its position.
+	std::uint32_t insert(const Entity entity);
+	// Swaps the entity's slot with the last one and drops it, returns the position it had (npos if missing).
+	std::uint32_t erase(const Entity entity);
+};
+
+// All components of type T, contiguous so systems stream through them.
+template<typename T>
+class ComponentPool final : public ComponentPoolBase {
+public:
+	template<typename... Args>
+	T& Emplace(const Entity entity, Args&&... args);
+	void Remove(const Entity entity) override;
+
+	T* find(const Entity entity) {
+		const auto index = this->indexOf(entity);
+		return index == npos ? nullptr : &this->components[index];
+	}
+	const T* find(const Entity entity) const {
+		const auto index = this->indexOf(entity);
+		return index == npos ? nullptr : &this->components[index];
+	}
+
+	// Dense access, in the same order as getEntities().
+	T& at(const std::size_t index) {
+		return this->components[index];
+	}
+	std::vector<T>& getComponents() {
+		return this->components;
+	}
+	const std::vector<T>& getComponents() const {
+		return this->components;
+	}
+
+private:
+	std::vector<T> components;
+};
+
+class QueryBase {
+public:
+	QueryBase() = default;
+	virtual ~QueryBase() = default;
+
+	// Not copyable
+	QueryBase(const QueryBase&) = delete;
+	QueryBase& operator=(const QueryBase&) = delete;
+};
+
+class EntityRegistry;
+
+// Entities that have every one of Ts, with the positions of their components cached.
+// The match list is only rebuilt when a component of one of Ts was added or removed since the last run.
+// Components may be modified while iterating, but adding/removing components of Ts or destroying entities may not.
+template<typename... Ts>
+class Query final : public QueryBase {
+public:
+	static_assert(sizeof...(Ts) > 0, "A query needs at least one component type");
+
+	explicit Query(EntityRegistry* registry);
+
+	std::size_t size();
+	const std::vector<Entity>& getEntities();
+
+	// f(Entity, Ts&...) for every match, on the calling thread.
+	template<typename F>
+	void each(F&& f);
+	// Same as each, with the matches split into chunks of `grain` run across the scheduler's threads.
+	template<typename F>
+	void parallel_each(Scheduler& scheduler, F&& f, const std::size_t grain = Scheduler::defaultGrainSize);
+
+private:
+	static constexpr std::size_t N = sizeof...(Ts);
+
+	std::tuple<ComponentPool<Ts>*...> pools;
+	std::array<std::uint64_t, N> versions{};
+	bool built = false;
+
+	std::vector<Entity> entities;
+	// Dense positions of each match's components, one column per type in Ts
+	std::vector<std::array<std::uint32_t, N>> rows;
+
+	void refresh();
+	template<typename F, std::size_t... I>
+	void invoke(F& f, const std::size_t row, std::index_sequence<I...>);
+};
+
+// Entity/component store: entities are ids, components of each type live in their own packed array (sparse-set storage).
+// Systems iterate queries over the arrays instead of calling virtual methods on scattered objects.
+// Structural changes (Create, Destroy, Add, Remove) are single-threaded; Query::parallel_each updates components in parallel.
+class EntityRegistry {
+public:
+	EntityRegistry() = default;
+	~EntityRegistry() = default;
+
+	// Not copyable
+	EntityRegistry(const EntityRegistry&) = delete;
+	EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+	Entity Create();
+	// Removes all of its components, stale handles no longer match anything.
+	void Destroy(const Entity entity);
+	bool isAlive(const Entity entity) const;
+	// Number of live entities
+	std::size_t size() const;
+
+	// Constructs the component in place, replacing one the entity already has.
+	template<typename T, typename... Args>
+	T& Add(const Entity entity, Args&&... args);
+	template<typename T>
+	void Remove(const Entity entity);
+	template<typename T>
+	bool Has(const Entity entity) const;
+	// Throws std::out_of_range if the entity has no T.
+	template<typename T>
+	T& Get(const Entity entity);
+	template<typename T>
+	const T& Get(const Entity entity) const;
+	// nullptr if the entity has no T.
+	template<typename T>
+	T* TryGet(const Entity entity);
+
+	template<typename T>
+	ComponentPool<T>& Components();
+
+	// The cached query for Ts, created on first use and valid as long as the registry.
+	template<typename... Ts>
+	Query<Ts...>& query();
+
+	template<typename... Ts, typename F>
+	void each(F&& f) {
+		this->query<Ts...>().each(std::forward<F>(f));
+	}
+	template<typename... Ts, typename F>
+	void parallel_each(Scheduler& scheduler, F&& f, const std::size_t grain = Scheduler::defaultGrainSize) {
+		this->query<Ts...>().parallel_each(scheduler, std::forward<F>(f), grain);
+	}
+
+private:
+	std::vector<std::uint32_t> generations;
+	// Destroyed slots, reused last in first out
+	std::vector<std::uint32_t> freeSlots;
+	std::size_t alive = 0;
+
+	// Indexed by ComponentType::id
+	std::vector<std::unique_ptr<ComponentPoolBase>> pools;
+	std::unordered_map<std::type_index, std::unique_ptr<QueryBase>> queries;
+
+	template<typename T>
+	const ComponentPool<T>* findPool() const;
+};
+
+template<typename T>
+template<typename... Args>
+T& ComponentPool<T>::Emplace(const Entity entity, Args&&... args) {
+	const auto index = this->indexOf(entity);
+	if (index != npos) {
+		this->components[index] = T{ std::forward<Args>(args)... };
+		return this->components[index];
+	}
+	this->components.push_back(T{ std::forward<Args>(args)... });
+	this->insert(entity);
+	return this->components.back();
+}
+
+template<typename T>
+void ComponentPool<T>::Remove(const Entity entity) {
+	const auto index = this->erase(entity);
+	if (index == npos) {
+		return;
+	}
+	if (index + 1 != this->components.size()) {
+		this->components[index] = std::move(this->components.back());
+	}
+	this->components.pop_back();
+}
+
+template<typename... Ts>
+Query<Ts...>::Query(EntityRegistry* registry) : pools(&registry->Components<Ts>()...) {}
+
+template<typename... Ts>
+std::size_t Query<Ts...>::size() {
+	this->refresh();
+	return this->rows.size();
+}
+
+template<typename... Ts>
+const std::vector<Entity>& Query<Ts...>::getEntities() {
+	this->refresh();
+	return this->entities;
+}
+
+template<typename... Ts>
+void Query<Ts...>::refresh() {
+	const std::array<ComponentPoolBase*, N> bases{ { std::get<ComponentPool<Ts>*>(this->pools)... } };
+	bool changed = !this->built;
+	for (std::size_t i = 0; i < N; ++i) {
+		changed = changed || bases[i]->getVersion() != this->versions[i];
+	}
+	if (!changed) {
+		return;
+	}
+
+	// Walk the smallest pool, every match has to be in it.
+	std::size_t smallest = 0;
+	for (std::size_t i = 1; i < N; ++i) {
+		if (bases[i]->size() < bases[smallest]->size()) {
+			smallest = i;
+		}
+	}
+	this->entities.clear();
+	this->rows.clear();
+	for (const Entity entity : bases[smallest]->getEntities()) {
+		std::array<std::uint32_t, N> row{};
+		bool matches = true;
+		for (std::size_t i = 0; i < N && matches; ++i) {
+			row[i] = bases[i]->indexOf(entity);
+			matches = row[i] != ComponentPoolBase::npos;
+		}
+		if (matches) {
+			this->entities.push_back(entity);
+			this->rows.push_back(row);
+		}
+	}
+
+	for (std::size_t i = 0; i < N; ++i) {
+		this->versions[i] = bases[i]->getVersion();
+	}
+	this->built = true;
+}
+
+template<typename... Ts>
+template<typename F, std::size_t... I>
+void Query<Ts...>::invoke(F& f, const std::size_t row, std::index_sequence<I...>) {
+	f(this->entities[row], std::get<I>(this->pools)->at(this->rows[row][I])...);
+}
+
+template<typename... Ts>
+template<typename F>
+void Query<Ts...>::each(F&& f) {
+	this->refresh();
+	for (std::size_t row = 0; row < this->rows.size(); ++row) {
+		this->invoke(f, row, std::index_sequence_for<Ts...>{});
+	}
+}
+
+template<typename... Ts>
+template<typename F>
+void Query<Ts...>::parallel_each(Scheduler& scheduler, F&& f, const std::size_t grain) {
+	// Rebuilt here, so the workers only read the cache.
+	this->refresh();
+	scheduler.parallel_for_chunks(0, this->rows.size(), grain, [this, &f](const std::size_t chunkBegin, const std::size_t chunkEnd) {
+		for (std::size_t row = chunkBegin; row < chunkEnd; ++row) {
+			this->invoke(f, row, std::index_sequence_for<Ts...>{});
+		}
+	});
+}
+
+template<typename T, typename... Args>
+T& EntityRegistry::Add(const Entity entity, Args&&... args) {
+	if (!this->isAlive(entity)) {
+		throw std::invalid_argument("Cannot add a component to a destroyed entity");
+	}
+	return this->Components<T>().Emplace(entity, std::forward<Args>(args)...);
+}
+
+template<typename T>
+void EntityRegistry::Remove(const Entity entity) {
+	this->Components<T>().Remove(entity);
+}
+
+template<typename T>
+bool EntityRegistry::Has(const Entity entity) const {
+	const auto* pool = this->findPool<T>();
+	return pool && pool->contains(entity);
+}
+
+template<typename T>
+T& EntityRegistry::Get(const Entity entity) {
+	T* component = this->TryGet<T>(entity);
+	if (!component) {
+		throw std::out_of_range("Entity has no such component");
+	}
+	return *component;
+}
+
+template<typename T>
+const T& EntityRegistry::Get(const Entity entity) const {
+	const auto* pool = this->findPool<T>();
+	const T* component = pool ? pool->find(entity) : nullptr;
+	if (!component) {
+		throw std::out_of_range("Entity has no such component");
+	}
+	return *component;
+}
+
+template<typename T>
+T* EntityRegistry::TryGet(const Entity entity) {
+	return this->Components<T>().find(entity);
+}
+
+template<typename T>
+ComponentPool<T>& EntityRegistry::Components() {
+	const std::size_t id = ComponentType::id<T>();
+	if (id >= this->pools.size()) {
+		this->pools.resize(id + 1);
+	}
+	if (!this->pools[id]) {
+		this->pools[id] = std::make_unique<ComponentPool<T>>();
+	}
+	return static_cast<ComponentPool<T>&>(*this->pools[id]);
+}
+
+template<typename T>
+const ComponentPool<T>* EntityRegistry::findPool() const {
+	const std::size_t id = ComponentType::id<T>();
+	if (id >= this->pools.size() || !this->pools[id]) {
+		return nullptr;
+	}
+	return static_cast<const ComponentPool<T>*>(this->pools[id].get());
+}
+
+template<typename... Ts>
+Query<Ts...>& EntityRegistry::query() {
+	auto& cached = this->queries[std::type_index(typeid(Query<Ts...>))];
+	if (!cached) {
+		cached = std::make_unique<Query<Ts...>>(this);
+	}
+	return static_cast<Query<Ts...>&>(*cached);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Linear allocator for memory that only has to live until the end of the frame.
+// Allocating bumps a pointer, nothing is freed on its own, Reset() releases everything at once and keeps the memory.
+// Not thread safe, every thread gets its own through FrameArena::Local() / Engine::getFrameArena().
+class FrameArena {
+public:
+	static constexpr std::size_t defaultBlockSize = 256 * 1024;
+
+	explicit FrameArena(const std::size_t blockSize = defaultBlockSize);
+
+	// Not copyable
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// `alignment` must be a power of two. Never returns nullptr, throws std::bad_alloc like new.
+	void* Allocate(const std::size_t size, const std::size_t alignment = alignof(std::max_align_t));
+	// Uninitialized storage for `count` objects of T.
+	template<typename T>
+	T* AllocateArray(const std::size_t count);
+
+	// Invalidates everything allocated so far.
+	// Blocks added during the frame are merged into one, so a steady workload stops allocating after the first frame.
+	void Reset();
+
+	// Bytes handed out since the last reset, and bytes owned.
+	std::size_t getUsed() const;
+	std::size_t getCapacity() const;
+
+	// The calling thread's arena. Reset on first use after the FrameMemory it follows starts a new frame, threads that
+	// never called FrameMemory::Local follow FrameMemory::Global().
+	static FrameArena& Local();
+
+private:
+	struct Block {
+		std::unique_ptr<unsigned char[]> memory;
+		std::size_t size = 0;
+	};
+
+	std::size_t blockSize;
+	std::vector<Block> blocks;
+	// Block currently being bumped, and the offset into it
+	std::size_t current = 0;
+	std::size_t offset = 0;
+	std::size_t used = 0;
+
+	void addBlock(const std::size_t minSize);
+};
+
+// Frame counter the per-thread arenas follow, the Engine advances it at the end of every frame.
+// A thread follows the last FrameMemory it called Local() on, its arena is then reset lazily on next use,
+// so no thread ever touches another thread's arena.
+// Frame memory must not be kept past the end of the frame, including by tasks still running when it ends.
+class FrameMemory {
+public:
+	FrameMemory();
+
+	// Not copyable
+	FrameMemory(const FrameMemory&) = delete;
+	FrameMemory& operator=(const FrameMemory&) = delete;
+
+	// The calling thread's arena, following this FrameMemory from now on.
+	FrameArena& Local();
+	// Ends the current frame for every thread following this FrameMemory.
+	void NextFrame();
+	std::uint64_t getFrame() const;
+
+	// Followed by threads not bound to an engine's FrameMemory (scheduler workers, loader threads, default
+	// FrameAllocators), so their arenas are reset too. Every Engine ends its frame here as well, so with several
+	// engines running such memory only lasts until the first of them finishes its frame.
+	static FrameMemory& Global();
+
+private:
+	std::shared_ptr<std::atomic<std::uint64_t>> frame;
+};
+
+// STL allocator handing out frame memory, deallocate is a no-op.
+// Default constructed it uses the calling thread's arena, reserve() containers up front where possible since growth leaves the old storage behind.
+template<typename T>
+class FrameAllocator {
+public:
+	using value_type = T;
+
+	FrameAllocator() noexcept : arena(&FrameArena::Local()) {}
+	explicit FrameAllocator(FrameArena& _arena) noexcept : arena(&_arena) {}
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+	T* allocate(const std::size_t n) {
+		if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+		return this->arena->template AllocateArray<T>(n);
+	}
+	void deallocate(T*, std::size_t) noexcept {}
+
+	FrameArena* getArena() const noexcept {
+		return this->arena;
+	}
+
+private:
+	FrameArena* arena;
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) noexcept {
+	return a.getArena() == b.getArena();
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) noexcept {
+	return !(a == b);
+}
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+template<typename T>
+T* FrameArena::AllocateArray(const std::size_t count) {
+	return static_cast<T*>(this->Allocate(sizeof(T) * count, alignof(T)));
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "profiler.hpp"
+
+// Swap interval used by the render loop.
+enum class VSyncMode {
+	Off,
+	On,
+	// Sync when on time, tear instead of waiting a whole refresh when late (falls back to On if unsupported)
+	Adaptive
+};
+
+// Holds the render loop to a target frame rate without burning a core.
+// Sleeps until shortly before the deadline (OS sleep granularity is coarse), then spins the rest.
+class FramePacer {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t defaultHistorySize = 256;
+
+	explicit FramePacer(const std::size_t historySize = defaultHistorySize);
+	~FramePacer() = default;
+
+	// Not copyable
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	// 0 disables pacing.
+	void setTargetFps(const double fps);
+	double getTargetFps() const;
+	bool isEnabled() const;
+
+	// How long before the deadline to stop sleeping and start spinning.
+	void setSpinThreshold(const Clock::duration& threshold);
+	Clock::duration getSpinThreshold() const;
+
+	// Forget the current cadence (after a long stall, e.g. idle waiting), the next Wait() won't be measured.
+	void Reset();
+	// Blocks until this frame's deadline, then records how long the frame actually took.
+	void Wait();
+
+	// |achieved frame time - target| of the last N paced frames (milliseconds).
+	ProfileStats getDeviationStats() const;
+	// Achieved frame times of the last N paced frames (milliseconds).
+	ProfileStats getFrameTimeStats() const;
+
+private:
+	double targetFps = 0.0;
+	Clock::duration period = Clock::duration::zero();
+	Clock::duration spinThreshold = std::chrono::microseconds(1500);
+
+	Clock::time_point deadline;
+	Clock::time_point lastFrameEnd;
+	bool hasCadence = false;
+
+	mutable std::mutex mutex;
+	std::vector<std::uint64_t> frameTimes;
+	std::size_t nextSample = 0;
+	std::size_t numSamples = 0;
+
+	std::vector<std::uint64_t> collect(const bool deviation) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+// Runs one job per frame on a dedicated worker thread so it can overlap with the render thread.
+// The job writes one of 2 or 3 state buffers while the render thread reads another: Kick() starts the job on the
+// buffer after the read buffer, Wait() blocks until it finishes and makes that buffer the new read buffer.
+class FramePipeline {
+public:
+	using Job = std::function<void(const double& dt, const std::size_t& buffer)>;
+
+	FramePipeline() = default;
+	~FramePipeline();
+
+	// Not copyable
+	FramePipeline(const FramePipeline&) = delete;
+	FramePipeline& operator=(const FramePipeline&) = delete;
+
+	// Starts the worker, buffer 0 is the first read buffer. Throws std::invalid_argument unless `buffers` is 2 or 3.
+	void Start(const Job& job, const std::size_t buffers = 2);
+	void Stop();
+	bool IsRunning() const;
+
+	// Begin running the job for this frame on the worker.
+	void Kick(const double& dt);
+	// Blocks until the last kicked job has finished, rethrows anything it threw (keeping the old read buffer).
+	void Wait();
+	// The buffer the render thread may read, never the one a kicked job is writing.
+	std::size_t getReadBuffer() const;
+
+private:
+	Job job;
+	std::thread worker;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool pending = false;
+	bool busy = false;
+	bool stopping = false;
+	double pendingDt = 0.0;
+	std::size_t numBuffers = 2;
+	std::size_t readBuffer = 0;
+	std::size_t writeBuffer = 0;
+	std::exception_ptr error = nullptr;
+
+	void workerLoop();
+};
@@ -43,7 +43,26 @@ public:
     virtual void ProcessInput(const double& dt) noexcept;
     virtual void Update(const double& dt) noexcept;
     virtual void Render() const noexcept;
+    // alpha in [0, 1) is how far between the last two fixed updates we are, 1.0 when not using a fixed timestep.
+    virtual void RenderInterpolated(const double& alpha) const noexcept;
 
+    // Pipelined mode (Engine::enablePipelining), Update runs on a worker while the previous frame renders.
+    // Return true once PublishState and RenderState are implemented, the engine refuses to pipeline otherwise.
+    virtual bool PublishesState() const noexcept;
+    // Called on the update thread after Update, copy what rendering needs into snapshot `buffer`.
+    virtual void PublishState(const std::size_t& buffer) noexcept;
+    // Called on the render thread, must only read snapshot `buffer`. Draws nothing by default, live state is
+    // being updated at the same time.
+    // With 3 buffers the previous snapshot, (buffer + 2) % 3, is also safe to read for interpolation.
+    // The camera (Engine::get3DRenderer) and lights (Engine::getLightManager) are render side state here: set them
+    // from RenderState, not Update.
+    virtual void RenderState(const std::size_t& buffer, const double& alpha) const noexcept;
+
+    // Idle mode (Engine::enableIdleMode), return false when nothing changed so the engine can block on events.
+    virtual bool NeedsRedraw() const noexcept;
+
+    // Key events are queued and delivered at the start of the next simulation tick, before ProcessInput
+    // (on the update thread in pipelined mode).
     virtual void pressed(const int key) noexcept;
     virtual void released(const int key) noexcept;
 };
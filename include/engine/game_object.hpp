@@ -3,29 +3,86 @@
 #include <glm/glm.hpp>
 
 #include "sprite.hpp"
+#include "entity_fwd.hpp"
 
 #include <constants/colour.hpp>
 #include <constants/texture.hpp>
 
+// GameObject's 2D state as components, one packed array each (Colour is used as is).
+struct Position2D {
+	glm::vec2 value;
+};
+
+struct Size2D {
+	glm::vec2 value;
+};
+
+struct Velocity2D {
+	glm::vec2 value;
+};
+
+// A thin facade over an entity: position/size/velocity/colour are accessors onto its components.
+// Detached objects (default constructed, the 3D types deriving from it, Game::player) keep the same state inline.
+// Large numbers of objects belong in the registry itself, iterated with its queries.
 class GameObject {
 public:
+	GameObject() = default;
 #if !ENGINE_MIN_GAME_OBJECT
-	// Optional Object State
-	glm::vec2 position;
-	glm::vec2 size;
-	glm::vec2 velocity;
-
-	Colour colour;
+	// Creates an entity with all four components and attaches to it.
+	explicit GameObject(EntityRegistry& registry);
+	// Attaches to an existing entity, adding the components it lacks.
+	GameObject(EntityRegistry& registry, const Entity entity);
 #endif
-
-	GameObject() = default;
 	virtual ~GameObject() = default;
 
-	// Moveable and copyable
+	// Moveable and copyable, copies of an attached object share its entity.
+	// The registry owns the entity: destroying the object leaves it alive.
 	GameObject(const GameObject&) = default;
 	GameObject& operator=(const GameObject&) = default;
 	GameObject(GameObject&&) = default;
 	GameObject& operator=(GameObject&&) = default;
 
 	virtual void Draw(Renderer* renderer) const;
+
+#if !ENGINE_MIN_GAME_OBJECT
+	// Optional Object State
+	// When attached these reference the registry's component arrays, only valid until the next Add/Remove/Destroy.
+	// Throw std::out_of_range once the entity has been destroyed or lost the component.
+	glm::vec2& position() { return this->registry ? this->attached<Position2D>().value : this->state.position; }
+	const glm::vec2& position() const { return this->registry ? this->attached<Position2D>().value : this->state.position; }
+	glm::vec2& size() { return this->registry ? this->attached<Size2D>().value : this->state.size; }
+	const glm::vec2& size() const { return this->registry ? this->attached<Size2D>().value : this->state.size; }
+	glm::vec2& velocity() { return this->registry ? this->attached<Velocity2D>().value : this->state.velocity; }
+	const glm::vec2& velocity() const { return this->registry ? this->attached<Velocity2D>().value : this->state.velocity; }
+	Colour& colour() { return this->registry ? this->attached<Colour>() : this->state.colour; }
+	const Colour& colour() const { return this->registry ? this->attached<Colour>() : this->state.colour; }
+
+	// Moves the inline state into a new entity and attaches to it. Throws std::logic_error if already attached.
+	Entity Attach(EntityRegistry& registry);
+	// Copies the entity's state back inline and lets go of it, the entity itself is left alone.
+	void Detach();
+
+	bool isAttached() const;
+	// Null handle / nullptr when detached
+	Entity getEntity() const;
+	EntityRegistry* getRegistry() const;
+
+private:
+	struct State {
+		glm::vec2 position;
+		glm::vec2 size;
+		glm::vec2 velocity;
+
+		Colour colour;
+	};
+
+	// Only used while detached
+	State state;
+	EntityRegistry* registry = nullptr;
+	Entity entity;
+
+	// Defined in game_object.cpp for the four component types
+	template<typename T>
+	T& attached() const;
+#endif
 };
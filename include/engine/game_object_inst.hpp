@@ -1,13 +1,214 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <constants/position.hpp>
 #include "engine/game_object.hpp"
+#include "engine/generational_handle.hpp"
 
+// Handle to an object in a GameObjectInst.
+// Handles stay valid while other objects spawn and die, and resolve to nullptr once their own object is freed.
+using InstHandle = GenerationalHandle<20>;
+
+// Pool of T (bullets, particles, enemies): objects are packed in one array for iteration, found by handle in O(1).
+// Spawn and Free are O(1), freed slots are reused through a free list so steady spawning allocates nothing.
+// Freeing moves the last object into the hole, so pointers/references and iteration order change, handles don't.
+// A slot is retired once its generation is used up, so a stale handle can never alias a newer object.
 template<typename T>
 class GameObjectInst {
 public:
-	T game_object;
+	using iterator = typename std::vector<T>::iterator;
+	using const_iterator = typename std::vector<T>::const_iterator;
+
 	GameObjectInst() = default;
+	explicit GameObjectInst(const std::size_t capacity) {
+		this->Reserve(capacity);
+	}
 	~GameObjectInst() = default;
-};
\ No newline at end of file
+
+	// Moveable, not copyable (handles are tied to one pool)
+	GameObjectInst(const GameObjectInst&) = delete;
+	GameObjectInst& operator=(const GameObjectInst&) = delete;
+	GameObjectInst(GameObjectInst&&) = default;
+	GameObjectInst& operator=(GameObjectInst&&) = default;
+
+	void Reserve(const std::size_t capacity) {
+		this->objects.reserve(capacity);
+		this->owners.reserve(capacity);
+		this->slots.reserve(capacity);
+	}
+
+	template<typename... Args>
+	InstHandle Spawn(Args&&... args);
+	// False if the handle was null or already freed.
+	bool Free(const InstHandle handle);
+	// Frees every object pred(object) is true for, returns how many.
+	template<typename Pred>
+	std::size_t FreeIf(Pred&& pred);
+	// Frees everything, outstanding handles go stale.
+	void Clear();
+
+	bool isAlive(const InstHandle handle) const {
+		return this->denseIndex(handle) != npos;
+	}
+	// nullptr once the object is freed, the pointer is only good until the next Spawn/Free.
+	T* get(const InstHandle handle) {
+		const auto index = this->denseIndex(handle);
+		return index == npos ? nullptr : &this->objects[index];
+	}
+	const T* get(const InstHandle handle) const {
+		const auto index = this->denseIndex(handle);
+		return index == npos ? nullptr : &this->objects[index];
+	}
+	T& at(const InstHandle handle) {
+		T* object = this->get(handle);
+		if (!object) {
+			throw std::out_of_range("Stale or null GameObjectInst handle");
+		}
+		return *object;
+	}
+
+	// Handle of the object at `index` in iteration order.
+	InstHandle handleAt(const std::size_t index) const {
+		const auto slot = this->owners.at(index);
+		return InstHandle(slot, this->slots[slot].generation);
+	}
+
+	std::size_t size() const {
+		return this->objects.size();
+	}
+	bool empty() const {
+		return this->objects.empty();
+	}
+	T* data() {
+		return this->objects.data();
+	}
+
+	iterator begin() {
+		return this->objects.begin();
+	}
+	iterator end() {
+		return this->objects.end();
+	}
+	const_iterator begin() const {
+		return this->objects.begin();
+	}
+	const_iterator end() const {
+		return this->objects.end();
+	}
+
+private:
+	static constexpr std::uint32_t npos = ~0u;
+
+	struct Slot {
+		// Position in `objects` while alive, next free slot while free
+		std::uint32_t index = npos;
+		std::uint32_t generation = 0;
+	};
+
+	std::vector<T> objects;
+	// Slot of each object, parallel to `objects`
+	std::vector<std::uint32_t> owners;
+	std::vector<Slot> slots;
+	std::uint32_t freeHead = npos;
+
+	std::uint32_t denseIndex(const InstHandle handle) const {
+		const auto slot = handle.getIndex();
+		if (handle.isNull() || slot >= this->slots.size() || this->slots[slot].generation != handle.getGeneration()) {
+			return npos;
+		}
+		const auto index = this->slots[slot].index;
+		// Free slots keep their generation until reused, so check the slot still owns an object.
+		if (index >= this->owners.size() || this->owners[index] != slot) {
+			return npos;
+		}
+		return index;
+	}
+
+	void release(const std::uint32_t slot);
+};
+
+template<typename T>
+template<typename... Args>
+InstHandle GameObjectInst<T>::Spawn(Args&&... args) {
+	const bool newSlot = this->freeHead == npos;
+	if (newSlot && this->slots.size() >= InstHandle::MaxIndex) {
+		throw std::length_error("GameObjectInst is full");
+	}
+	// Construct first, so a throwing constructor leaves the pool untouched.
+	this->objects.emplace_back(std::forward<Args>(args)...);
+	const std::uint32_t slot = newSlot ? static_cast<std::uint32_t>(this->slots.size()) : this->freeHead;
+	try {
+		if (newSlot) {
+			this->slots.emplace_back();
+		}
+		this->owners.push_back(slot);
+	} catch (...) {
+		// Out of memory for the bookkeeping, give back the object and the slot.
+		if (newSlot && this->slots.size() > slot) {
+			this->slots.pop_back();
+		}
+		this->objects.pop_back();
+		throw;
+	}
+	if (!newSlot) {
+		this->freeHead = this->slots[slot].index;
+	}
+	this->slots[slot].index = static_cast<std::uint32_t>(this->objects.size() - 1);
+	return InstHandle(slot, this->slots[slot].generation);
+}
+
+template<typename T>
+bool GameObjectInst<T>::Free(const InstHandle handle) {
+	const auto index = this->denseIndex(handle);
+	if (index == npos) {
+		return false;
+	}
+	const auto last = static_cast<std::uint32_t>(this->objects.size() - 1);
+	if (index != last) {
+		this->objects[index] = std::move(this->objects[last]);
+		this->owners[index] = this->owners[last];
+		this->slots[this->owners[index]].index = index;
+	}
+	this->objects.pop_back();
+	this->owners.pop_back();
+	this->release(handle.getIndex());
+	return true;
+}
+
+template<typename T>
+template<typename Pred>
+std::size_t GameObjectInst<T>::FreeIf(Pred&& pred) {
+	std::size_t freed = 0;
+	// Backwards, so the object swapped into a hole has already been checked.
+	for (std::size_t i = this->objects.size(); i-- > 0;) {
+		if (pred(this->objects[i])) {
+			this->Free(this->handleAt(i));
+			freed += 1;
+		}
+	}
+	return freed;
+}
+
+template<typename T>
+void GameObjectInst<T>::Clear() {
+	while (!this->objects.empty()) {
+		this->Free(this->handleAt(this->objects.size() - 1));
+	}
+}
+
+template<typename T>
+void GameObjectInst<T>::release(const std::uint32_t slot) {
+	Slot& freed = this->slots[slot];
+	freed.generation += 1;
+	if (freed.generation > InstHandle::GenerationMask) {
+		// Out of generations, never hand this slot out again.
+		freed.index = npos;
+		return;
+	}
+	freed.index = this->freeHead;
+	this->freeHead = slot;
+}
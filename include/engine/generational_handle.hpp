@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// 32-bit handle: slot index in the low Bits, the slot's generation in the rest, so handles to freed slots stop matching.
+// Containers with a different Bits get a distinct handle type, so their handles can't be mixed up.
+template<std::uint32_t Bits>
+class GenerationalHandle {
+public:
+	static_assert(Bits > 0 && Bits < 32, "GenerationalHandle needs bits for both the index and the generation");
+
+	static constexpr std::uint32_t IndexBits = Bits;
+	static constexpr std::uint32_t MaxIndex = (1u << IndexBits) - 1;
+	static constexpr std::uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+	// Null handle
+	constexpr GenerationalHandle() = default;
+	constexpr GenerationalHandle(const std::uint32_t index, const std::uint32_t generation) : value((generation & GenerationMask) << IndexBits | (index & MaxIndex)) {}
+
+	constexpr std::uint32_t getIndex() const {
+		return this->value & MaxIndex;
+	}
+	constexpr std::uint32_t getGeneration() const {
+		return this->value >> IndexBits;
+	}
+	constexpr bool isNull() const {
+		return this->value == ~0u;
+	}
+
+	constexpr bool operator==(const GenerationalHandle& other) const {
+		return this->value == other.value;
+	}
+	constexpr bool operator!=(const GenerationalHandle& other) const {
+		return this->value != other.value;
+	}
+
+private:
+	std::uint32_t value = ~0u;
+};
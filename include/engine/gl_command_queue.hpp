@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Work that has to run on the thread owning the GL context (buffer/texture creation, uploads), submitted from any thread.
+// Producers push onto a lock-free MPSC queue (Vyukov's intrusive node queue), the owner runs the commands in Drain().
+// Commands still queued when the queue is destroyed are dropped, their futures then throw std::future_error (broken_promise).
+class GLCommandQueue {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	GLCommandQueue();
+	~GLCommandQueue();
+
+	// Not copyable
+	GLCommandQueue(const GLCommandQueue&) = delete;
+	GLCommandQueue& operator=(const GLCommandQueue&) = delete;
+
+	// The calling thread becomes the one commands run on (the engine does this once its context is current).
+	void BindToCurrentThread();
+	bool isOwnerThread() const;
+
+	// Queues f() for the owner thread, the future holds its result or exception.
+	// Called on the owner thread it runs inline instead, so waiting on the future there can't deadlock.
+	template<typename F>
+	auto Submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>>;
+
+	// Runs queued commands in submission order until the queue is empty or `budget` has been spent, owner thread only.
+	// At least one command runs (when there is one), so a command longer than the budget can't stall the queue.
+	// Returns how many ran.
+	std::size_t Drain(const Clock::duration budget);
+	std::size_t DrainAll();
+
+	// Approximate while producers are pushing
+	std::size_t size() const;
+
+private:
+	struct Command {
+		std::atomic<Command*> next{nullptr};
+
+		virtual ~Command() = default;
+		virtual void Run() = 0;
+	};
+
+	template<typename F, typename R>
+	struct TypedCommand final : Command {
+		F f;
+		std::promise<R> promise;
+
+		explicit TypedCommand(F&& _f) : f(std::move(_f)) {}
+
+		void Run() override {
+			try {
+				if constexpr (std::is_void<R>::value) {
+					this->f();
+					this->promise.set_value();
+				} else {
+					this->promise.set_value(this->f());
+				}
+			} catch (...) {
+				this->promise.set_exception(std::current_exception());
+			}
+		}
+	};
+
+	// Producers swap themselves in at `head`, the owner pops from `tail`. `stub` keeps the list non-empty.
+	alignas(64) std::atomic<Command*> head;
+	alignas(64) Command* tail;
+	std::unique_ptr<Command> stub;
+	std::atomic<std::size_t> pending{0};
+
+	std::atomic<std::thread::id> owner{std::thread::id()};
+
+	void push(Command* command);
+	// nullptr when empty, or when a producer is halfway through a push (its command shows up on the next call).
+	Command* pop();
+};
+
+template<typename F>
+auto GLCommandQueue::Submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+	using R = std::invoke_result_t<std::decay_t<F>&>;
+	auto command = std::make_unique<TypedCommand<std::decay_t<F>, R>>(std::decay_t<F>(std::forward<F>(f)));
+	auto future = command->promise.get_future();
+	if (this->isOwnerThread()) {
+		command->Run();
+	} else {
+		this->push(command.release());
+	}
+	return future;
+}
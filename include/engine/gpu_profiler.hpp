@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "profiler.hpp"
+
+// Times GPU work with GL_TIMESTAMP queries, and mirrors every scope as a KHR_debug group
+// so capture tools (RenderDoc, apitrace, Nsight) see the same structure.
+// Query results are read back `framesInFlight` frames late, and dropped if still not ready, so it never stalls.
+// Must only be used from the thread that owns the GL context.
+class GpuProfiler {
+public:
+	static constexpr std::size_t framesInFlight = 4;
+	static constexpr std::size_t defaultHistorySize = 256;
+
+	GpuProfiler() = default;
+	~GpuProfiler() = default;
+
+	// Not copyable
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// Requires a current GL context.
+	void Init();
+	void Shutdown();
+
+	// Off by default, every scope costs two queries.
+	void setEnabled(const bool enabled);
+	bool isEnabled() const;
+	bool hasTimerQueries() const;
+	bool hasDebugGroups() const;
+
+	void BeginFrame();
+	void EndFrame();
+
+	void PushScope(const std::string_view& name);
+	void PopScope();
+
+	// Stats over the last `defaultHistorySize` resolved samples of the scope (milliseconds).
+	ProfileStats getScopeStats(const std::string_view& name) const;
+	std::vector<std::string> getScopeNames() const;
+
+	// The profiler used by ENGINE_GPU_SCOPE on this thread, set by the engine that owns the GL context.
+	static GpuProfiler* Current();
+	static void MakeCurrent(GpuProfiler* profiler);
+
+private:
+	struct Scope {
+		std::size_t name;
+		std::size_t beginQuery;
+		std::size_t endQuery;
+	};
+
+	struct Frame {
+		std::vector<unsigned int> queries;
+		std::size_t usedQueries = 0;
+		std::vector<Scope> scopes;
+	};
+
+	bool enabled = false;
+	bool initialized = false;
+	bool timerQueries = false;
+	bool debugGroups = false;
+
+	std::array<Frame, framesInFlight> frames;
+	std::size_t frameIndex = 0;
+	bool inFrame = false;
+	std::vector<std::size_t> openScopes;
+
+	std::map<std::string, std::size_t, std::less<>> nameIds;
+	std::vector<std::string> names;
+	std::vector<std::deque<std::uint64_t>> history;
+
+	std::size_t internName(const std::string_view& name);
+	std::size_t nextQuery(Frame& frame);
+	void resolve(Frame& frame);
+};
+
+// Scoped GPU timer + debug group.
+class GpuScope {
+public:
+	GpuScope(GpuProfiler* profiler, const std::string_view& name);
+	~GpuScope();
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+	GpuProfiler* profiler;
+};
+
+#if ENGINE_ENABLE_PROFILING
+	// Usage: ENGINE_GPU_SCOPE("Skybox::Draw");
+	#define ENGINE_GPU_SCOPE(name) \
+		const GpuScope ENGINE_PROFILE_CONCAT(engine_gpu_scope_, __LINE__)(GpuProfiler::Current(), name)
+#else
+	#define ENGINE_GPU_SCOPE(name) static_cast<void>(0)
+#endif
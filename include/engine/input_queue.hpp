@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "profiler.hpp"
+
+// A key event as reported by GLFW, stamped when the callback ran.
+struct InputEvent {
+	int key = 0;
+	int scancode = 0;
+	int action = 0;
+	int mods = 0;
+	Profiler::Clock::time_point timestamp;
+};
+
+// Lock-free single producer / single consumer ring of input events.
+// GLFW callbacks (main thread) push, the engine pops once per frame before Game::ProcessInput,
+// which in pipelined mode runs on the update thread.
+class InputQueue {
+public:
+	static constexpr std::size_t Capacity = 256;
+
+	InputQueue() = default;
+
+	// Not copyable
+	InputQueue(const InputQueue&) = delete;
+	InputQueue& operator=(const InputQueue&) = delete;
+
+	// Producer only, returns false (and counts a drop) when full.
+	bool Push(const InputEvent& event) noexcept;
+	// Consumer only
+	bool Pop(InputEvent& event) noexcept;
+
+	bool empty() const noexcept;
+	std::uint64_t getDropped() const noexcept;
+
+private:
+	static_assert((Capacity & (Capacity - 1)) == 0, "InputQueue capacity must be a power of two");
+
+	std::array<InputEvent, Capacity> events{};
+	// Kept on separate cache lines so producer and consumer don't false share.
+	alignas(64) std::atomic<std::size_t> head{0};
+	alignas(64) std::atomic<std::size_t> tail{0};
+	alignas(64) std::atomic<std::uint64_t> dropped{0};
+};
+
+// Input-to-photon latency: time from an input event to the glfwSwapBuffers that first presents a frame reflecting it.
+class InputLatencyProbe {
+public:
+	static constexpr std::size_t defaultHistorySize = 256;
+
+	explicit InputLatencyProbe(const std::size_t historySize = defaultHistorySize);
+
+	// Not copyable
+	InputLatencyProbe(const InputLatencyProbe&) = delete;
+	InputLatencyProbe& operator=(const InputLatencyProbe&) = delete;
+
+	void Record(const Profiler::Clock::duration& latency);
+	// Milliseconds, over the last N events
+	ProfileStats getStats() const;
+
+private:
+	mutable std::mutex mutex;
+	std::vector<std::uint64_t> latencies;
+	std::size_t nextSample = 0;
+	std::size_t numSamples = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Scheduler;
+
+// Instruction sets the kinematics kernel can use, Auto picks the best one the CPU supports.
+enum class SimdLevel {
+	Auto = 0,
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+struct KinematicsParams {
+	// Decay rate in 1/s, applied as v *= exp(-damping * dt): speed falls by a factor of e every 1/damping seconds at any frame rate.
+	float damping = 0.0f;
+	// Keep positions inside [boundsMin, boundsMax]
+	bool clampToBounds = false;
+	glm::vec2 boundsMin = glm::vec2(0.0f);
+	glm::vec2 boundsMax = glm::vec2(0.0f);
+	// Share of the speed kept, pointing back inside, along an axis where a body hit the bounds. 0 stops it, 1 bounces.
+	float restitution = 0.0f;
+};
+
+// Positions and velocities of many 2D bodies stored as four float arrays (x, y, vx, vy), so one SIMD
+// instruction advances 4 (SSE2) or 8 (AVX2) bodies. Integration is semi-implicit Euler: damp, then move, then clamp.
+class KinematicBodies {
+public:
+	KinematicBodies() = default;
+	~KinematicBodies() = default;
+
+	std::size_t Add(const glm::vec2& position, const glm::vec2& velocity = glm::vec2(0.0f));
+	// Moves the last body into `index`.
+	void Remove(const std::size_t index);
+	void Reserve(const std::size_t capacity);
+	void Clear();
+	std::size_t size() const;
+
+	glm::vec2 getPosition(const std::size_t index) const;
+	glm::vec2 getVelocity(const std::size_t index) const;
+	void setPosition(const std::size_t index, const glm::vec2& position);
+	void setVelocity(const std::size_t index, const glm::vec2& velocity);
+
+	// Advances every body by dt, split into chunks across `scheduler`'s threads when given one.
+	void Integrate(const float dt, const KinematicsParams& params, Scheduler* scheduler = nullptr, const SimdLevel level = SimdLevel::Auto);
+
+	// The kernel on caller-owned arrays of `count` floats each.
+	// Levels the CPU doesn't support fall back to the best one it does.
+	static void IntegrateArrays(float* x, float* y, float* vx, float* vy, const std::size_t count, const float dt, const KinematicsParams& params, const SimdLevel level = SimdLevel::Auto);
+	// Detected once, Scalar on CPUs other than x86.
+	static SimdLevel getSupportedSimdLevel();
+
+private:
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> vx;
+	std::vector<float> vy;
+};
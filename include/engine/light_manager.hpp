@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
 struct DirLight {
     glm::vec3 direction;
 
@@ -37,11 +42,32 @@ struct SpotLight {
 
 using FlashLight = SpotLight;
 
+// The scene's lights. Mesh shaders read them from std140 uniform blocks, one buffer per light type, which Upload
+// refreshes once per frame and only when a light changed, instead of every mesh setting every light.
 class LightManager {
 public:
+    // Uniform buffer binding points, and the blocks generated shaders declare at them.
+    // Spotlights and flashlights share one block, spotlights first.
+    static constexpr unsigned int dirLightBinding = 0;
+    static constexpr unsigned int pointLightBinding = 1;
+    static constexpr unsigned int spotLightBinding = 2;
+    static constexpr const char* dirLightBlock = "DirLightBlock";
+    static constexpr const char* pointLightBlock = "PointLightBlock";
+    static constexpr const char* spotLightBlock = "SpotLightBlock";
+
     LightManager() = default;
     ~LightManager() = default;
 
+    // Not copyable, owns GL buffers
+    LightManager(const LightManager&) = delete;
+    LightManager& operator=(const LightManager&) = delete;
+
+    // Packs the lights into std140 layout and uploads whichever blocks differ from what the GPU has, then binds the
+    // buffers to their binding points. Requires a current GL context. Returns whether anything was uploaded.
+    bool Upload();
+    // Deletes the buffers, before the GL context goes away.
+    void Shutdown();
+
     void AddPointLight(const PointLight& pointLight) {
         this->point.push_back(pointLight);
     }
@@ -79,8 +105,23 @@ public:
     }
 
 private:
+    // A light type's uniform buffer and the bytes last uploaded to it
+    struct Block {
+        unsigned int buffer = 0;
+        std::size_t capacity = 0;
+        std::vector<unsigned char> uploaded;
+    };
+
     std::vector<PointLight> point;
     std::vector<DirLight> direction;
     std::vector<SpotLight> spotlight;
     std::vector<FlashLight> flashlight;
+
+    Block dirBlock;
+    Block pointBlock;
+    Block spotBlock;
+    // Reused between frames
+    std::vector<unsigned char> packed;
+
+    static bool uploadBlock(Block& block, const std::vector<unsigned char>& data, const unsigned int binding);
 };
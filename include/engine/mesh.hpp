@@ -11,6 +11,7 @@
 #include <constants/texture.hpp>
 #include <constants/shader.hpp>
 
+#include "bounds.hpp"
 #include "vertex.hpp"
 #include "material.hpp"
 #include "3d_renderer.hpp"
@@ -38,13 +39,31 @@ public:
 	Mesh& operator=(Mesh&& other) = default;
 
     std::string description() const;
+	// Of the vertex positions in model space, computed when loaded.
+	const Aabb3D& getBounds() const;
 
 private:
 	mutable Shader shader;
     bool use_textures;
 
+	// Resolved whenever the shader is (re)built, so Draw and UpdatePerspective don't look names up every frame.
+	struct Uniforms {
+		UniformHandle model;
+		UniformHandle lightAmbient;
+		UniformHandle lightDiffuse;
+		UniformHandle lightSpecular;
+		UniformHandle materialAmbient;
+		UniformHandle materialDiffuse;
+		UniformHandle materialSpecular;
+		UniformHandle materialShininess;
+		UniformHandle materialAmbientMix;
+		UniformHandle materialDiffuseMix;
+		UniformHandle materialSpecularMix;
+	} uniforms;
+
     // only accessible by Model.
     bool autoCreateShader(Engine* engine);
+    void resolveUniforms();
     void Cleanup();
     void Init();
     void UpdatePerspective(Engine* engine);
@@ -63,6 +82,7 @@ private:
 	std::vector<unsigned int> indices;
 	std::vector<Texture2D> textures;
     Material material;
+	Aabb3D bounds;
 
 
     // OpenGL Contexts
@@ -9,6 +9,10 @@
 #include "game_object.hpp"
 #include "3d_renderer.hpp"
 
+namespace Assimp {
+	class Importer;
+}
+
 class Model final : public GameObject {
 public:
 	std::string fragmentOutColour = "FragColour";
@@ -21,8 +25,19 @@ public:
     Model(Engine* engine, const std::string& path);
 	~Model();
 
+#if ENGINE_ENABLE_COROUTINES
+	// co_await variant of the constructor (also Engine::loadModel).
+	// Imports and decodes textures on a worker, then builds the meshes on the main thread. Call Init next, as usual.
+	// Throws std::logic_error in EngineMode::Simulation.
+	static CoTask<std::unique_ptr<Model>> Load(Engine* engine, std::string path);
+#endif
+
 	Mesh& getMesh(const std::size_t& i);
 	std::size_t numMeshes() const;
+	// Union of the meshes' bounds in model space. Node transforms aren't applied, same as Draw.
+	const Aabb3D& getBounds() const;
+	// Bounds after placing the model with `model`, e.g. to insert into a DynamicBvh for culling.
+	Aabb3D getWorldBounds(const glm::mat4& model) const;
 	void Init(Engine* engine);
 	using GameObject::Draw;
 	void UpdatePerspective(Engine* engine);
@@ -30,10 +45,20 @@ public:
 
 private:
 	std::vector<Mesh> meshes;
+	Aabb3D bounds;
 //    const bool gammaCorrection;
     std::size_t prevLightCount = 0;
 
+    Model() = default;
+
     void loadModel(Engine* engine, const std::string& path);
+#if ENGINE_ENABLE_COROUTINES
+    static CoTask<std::unique_ptr<Model>> loadOnWorker(Engine* engine, std::string path);
+#endif
+    // nullptr (after logging why) when the file couldn't be imported
+    static const aiScene* importScene(Assimp::Importer& importer, const std::string& path);
+    // Decodes every texture the scene's materials use and queues the uploads, safe off the main thread.
+    static void preloadTextures(Engine* engine, const aiScene& scene, const constants::fs::path& root_dir);
     void processNode(Engine* engine, const aiNode& node, const aiScene& scene, const constants::fs::path& root_dir);
     Mesh processMesh(Engine* engine, const aiMesh& mesh, const aiScene& scene, const constants::fs::path& root_dir);
 	std::vector<Texture2D> loadMaterialTextures(Engine* engine, const aiMaterial& mat, const aiTextureType& type, const std::string& typeName, const constants::fs::path& root_dir);
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Phases of Engine::run that are timed every frame.
+enum class FramePhase : std::size_t {
+	PollEvents = 0,
+	GLCommands, // Commands other threads queued for the GL context
+	VRInput,
+	ProcessInput,
+	Update,
+	UpdateWait, // Pipelined mode, time the render thread spent waiting on the update thread
+	Clear,
+	Render,
+	AudioUpdate,
+	SwapBuffers,
+	VRPose,
+	FrameWait, // Frame pacing, time spent sleeping/spinning until the target frame time
+	Frame, // Whole frame
+	Count
+};
+
+// All durations are in milliseconds.
+struct ProfileStats {
+	std::size_t samples = 0;
+	double min = 0.0;
+	double avg = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+// Keeps per-phase (and per-zone) timings of the last N frames.
+// Frames are committed by a single thread (the engine), stats can be queried from any thread without locking.
+class Profiler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t defaultHistorySize = 256;
+	static constexpr std::size_t NumPhases = static_cast<std::size_t>(FramePhase::Count);
+	static constexpr std::size_t MaxZones = 64;
+
+	explicit Profiler(const std::size_t historySize = defaultHistorySize);
+	~Profiler() = default;
+
+	// Not copyable
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	// Drops all history, not safe to call while the engine is running.
+	void SetHistorySize(const std::size_t historySize);
+	std::size_t getHistorySize() const;
+	// Total number of frames committed so far.
+	std::uint64_t getFrameCount() const;
+
+	// Called by the engine, safe to call from any thread.
+	void AddPhase(const FramePhase phase, const Clock::duration& duration) noexcept;
+	// Commits the in-progress frame into the history.
+	void EndFrame() noexcept;
+
+	// Zones are registered globally by name, the returned id is valid for every Profiler.
+	static std::size_t RegisterZone(const std::string& name);
+	void AddZone(const std::size_t zone, const Clock::duration& duration) noexcept;
+
+	ProfileStats getPhaseStats(const FramePhase phase) const;
+	// Only frames where the zone ran are counted, nested zones report inclusive time.
+	ProfileStats getZoneStats(const std::string& name) const;
+
+	static std::string PhaseName(const FramePhase phase);
+	// min/avg/percentiles of a set of samples in nanoseconds.
+	static ProfileStats Summarize(std::vector<std::uint64_t> samples);
+
+private:
+	static constexpr std::size_t NumColumns = NumPhases + MaxZones;
+	using Row = std::array<std::atomic<std::uint64_t>, NumColumns>;
+
+	// Sequence number is odd while the writer is updating the row.
+	struct FrameRecord {
+		std::atomic<std::uint64_t> seq{0};
+		Row nanos{};
+	};
+
+	std::size_t historySize;
+	std::unique_ptr<FrameRecord[]> history;
+	std::atomic<std::uint64_t> written{0};
+
+	// Frame currently being recorded
+	Row current{};
+
+	friend class ProfilePhase;
+	static const char* phaseLabel(const FramePhase phase);
+
+	ProfileStats collect(const std::size_t column, const bool skipEmpty) const;
+};
+
+// Times the enclosing scope into a user zone, see ENGINE_PROFILE_ZONE.
+class ProfileZone {
+public:
+	ProfileZone(Profiler* profiler, const std::size_t zone) noexcept;
+	~ProfileZone();
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	Profiler* profiler;
+	std::size_t zone;
+	Profiler::Clock::time_point start;
+};
+
+// Times the enclosing scope into one of the engine's frame phases.
+class ProfilePhase {
+public:
+	ProfilePhase(Profiler* profiler, const FramePhase phase) noexcept;
+	~ProfilePhase();
+
+	ProfilePhase(const ProfilePhase&) = delete;
+	ProfilePhase& operator=(const ProfilePhase&) = delete;
+
+private:
+	Profiler* profiler;
+	FramePhase phase;
+	Profiler::Clock::time_point start;
+};
+
+#define ENGINE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_IMPL(a, b)
+
+#if ENGINE_ENABLE_PROFILING
+	// Usage: ENGINE_PROFILE_ZONE(engine->getProfiler(), "AI");
+	#define ENGINE_PROFILE_ZONE(profiler, name) \
+		static const std::size_t ENGINE_PROFILE_CONCAT(engine_profile_zone_id_, __LINE__) = Profiler::RegisterZone(name); \
+		const ProfileZone ENGINE_PROFILE_CONCAT(engine_profile_zone_, __LINE__)(profiler, ENGINE_PROFILE_CONCAT(engine_profile_zone_id_, __LINE__))
+	#define ENGINE_PROFILE_PHASE(profiler, phase) \
+		const ProfilePhase ENGINE_PROFILE_CONCAT(engine_profile_phase_, __LINE__)(profiler, phase)
+#else
+	#define ENGINE_PROFILE_ZONE(profiler, name) static_cast<void>(0)
+	#define ENGINE_PROFILE_PHASE(profiler, phase) static_cast<void>(0)
+#endif
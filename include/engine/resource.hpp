@@ -1,12 +1,17 @@
 #pragma once
 #include <string>
 #include <map>
+#include <future>
 
 #if ENGINE_DEBUG
 #include <set>
 #endif
 
 #include "engine_fwd.hpp"
+#include "gl_command_queue.hpp"
+#include "coroutine.hpp"
+
+class Scheduler;
 
 #include <constants/cubemap.hpp>
 #include <constants/shader.hpp>
@@ -39,6 +44,15 @@ public:
 
     // loads (and generates) a texture from file
     Texture2D& LoadTexture(const std::string& file, const std::string& name, const bool flip_vertically, const bool generate_mipmap = false);
+    // Decodes the image on the calling thread and uploads it through the engine's GL command queue.
+    // Safe to call from loader/worker tasks, the future is ready once the texture is stored.
+    // Throws std::logic_error without a GL command queue, i.e. outside an Engine or in EngineMode::Simulation.
+    std::future<Texture2D&> LoadTextureAsync(const std::string& file, const std::string& name, const bool flip_vertically, const bool generate_mipmap = false);
+#if ENGINE_ENABLE_COROUTINES
+    // co_await variant, decodes on a worker and resumes on the main thread once the texture is uploaded.
+    // Like LoadTextureAsync, throws std::logic_error (when called) outside an Engine or in EngineMode::Simulation.
+    CoTask<Texture2D*> AwaitTexture(std::string file, std::string name, const bool flip_vertically, const bool generate_mipmap = false);
+#endif
     Texture2D& LoadCubeMap(const CubeMap& faces, const bool flip_vertically, const std::string& name);
     bool TextureLoaded(const std::string& name) const;
 
@@ -52,6 +66,13 @@ public:
 private:
     friend Engine;
 
+    // Set by the Engine, main thread GL work for the async loaders (no queue in simulation mode)
+    GLCommandQueue* glCommands = nullptr;
+    Scheduler* scheduler = nullptr;
+#if ENGINE_ENABLE_COROUTINES
+    CoTask<Texture2D*> awaitTextureUpload(std::string file, std::string name, const bool flip_vertically, const bool generate_mipmap);
+#endif
+
     // properly de-allocates all loaded resources
     void Clear();
 
@@ -66,6 +87,9 @@ private:
 
     void loadImageFile(unsigned char** data, ScreenSize* size, int* nrChannels, const std::string& file, const bool flip_vertically = true);
 
+    // wrap, filter & format for a decoded image, everything but the upload
+    Texture2D describeTexture(const int nrChannels, const bool generate_mipmap) const;
+
     // loads a single texture from file
     Texture2D loadTextureFromFile(const std::string& file, const bool flip_vertically = true, const bool generate_mipmap = false);
 
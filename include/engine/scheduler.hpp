@@ -5,20 +5,294 @@
 	#include <ftl/task_scheduler.h>
 #endif
 
-#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "work_stealing_pool.hpp"
+#include "coroutine.hpp"
+
+class Scheduler;
+class TaskGraph;
+
+enum class SchedulerBackend {
+	// FiberTaskingLib, needs ENGINE_ENABLE_MULTITHREADED
+	Fibers,
+	// The built-in WorkStealingPool
+	WorkStealing
+};
+
+struct SchedulerOptions {
+	// 0 uses one thread per hardware thread, the caller counts as one (it helps while waiting).
+	std::size_t numThreads = 0;
+#if ENGINE_ENABLE_MULTITHREADED
+	SchedulerBackend backend = SchedulerBackend::Fibers;
+#else
+	SchedulerBackend backend = SchedulerBackend::WorkStealing;
+#endif
+
+	// Work stealing only, see WorkStealingPool::Options.
+	// Reserving the main thread leaves its core alone, with pinning the main thread pins itself to CPU 0 through
+	// Scheduler::PinMainThread (the engine does this for its own scheduler).
+	bool reserveMainThread = true;
+	bool pinThreads = false;
+	std::vector<unsigned int> cpus;
+};
+
+// Tracks a batch of tasks started with Scheduler::AddTask, wait on it with Scheduler::WaitForCounter.
+class TaskCounter {
+public:
+	explicit TaskCounter(Scheduler* scheduler);
+
+	// Not copyable
+	TaskCounter(const TaskCounter&) = delete;
+	TaskCounter& operator=(const TaskCounter&) = delete;
+
+	// True once every task added with this counter has finished.
+	bool isDone() const;
 
-class Scheduler {
 private:
+	friend Scheduler;
+
+	std::atomic<std::size_t> pending{0};
+	// The first exception thrown by one of the tasks, rethrown by Scheduler::WaitForCounter
+	std::mutex failureMutex;
+	std::exception_ptr failure;
 #if ENGINE_ENABLE_MULTITHREADED
-	ftl::TaskScheduler taskScheduler;
+	// Only with the Fibers backend
+	std::unique_ptr<ftl::AtomicCounter> counter;
 #endif
+};
 
+// Data-parallel primitives for game code.
+// Backed by FiberTaskingLib (default with ENGINE_ENABLE_MULTITHREADED) or the built-in work-stealing pool.
+// With FTL, work can be started from the main thread or from inside another task, other threads run it inline.
+class Scheduler {
 public:
-	Scheduler();
+	using Task = std::function<void()>;
+
+	static constexpr std::size_t defaultGrainSize = 64;
+
+	// 0 uses one thread per hardware thread (the caller counts as one, it helps while waiting).
+	explicit Scheduler(const std::size_t numThreads = 0);
+	explicit Scheduler(const SchedulerOptions& options);
 	~Scheduler();
 
 	// Not copyable
 	Scheduler(const Scheduler&) = delete;
 	Scheduler& operator=(const Scheduler&) = delete;
+
+	std::size_t getNumThreads() const;
+	SchedulerBackend getBackend() const;
+
+	// Pins the calling thread to CPU 0 when the options ask for pinning with a reserved main thread, false otherwise.
+	// Call it from the main thread, the constructor doesn't pin whichever thread happens to create the scheduler.
+	bool PinMainThread();
+
+	// Fire and forget, `counter` (if any) is decremented when the task finishes, even if it throws.
+	// Exceptions from tasks without a counter are reported on std::cerr when they ran on a worker.
+	void AddTask(Task task, TaskCounter* counter = nullptr);
+	void AddTasks(std::vector<Task> tasks, TaskCounter* counter = nullptr);
+	// Blocks until every task on `counter` is done, the calling thread runs queued work meanwhile.
+	// Then rethrows the first exception one of them threw.
+	void WaitForCounter(TaskCounter& counter);
+
+	// Calls f(i) for every i in [begin, end), in chunks of at least `grain` indices.
+	template<typename F>
+	void parallel_for(const std::size_t begin, const std::size_t end, const std::size_t grain, F&& f);
+	template<typename F>
+	void parallel_for(const std::size_t begin, const std::size_t end, F&& f);
+
+	// Calls f(chunkBegin, chunkEnd) for consecutive chunks covering [begin, end).
+	template<typename F>
+	void parallel_for_chunks(const std::size_t begin, const std::size_t end, const std::size_t grain, F&& f);
+
+	// out[i] = f(data[i])
+	template<typename Seq, typename F>
+	auto map(const Seq& data, F&& f, const std::size_t grain = defaultGrainSize) -> std::vector<std::decay_t<decltype(f(*std::begin(data)))>>;
+
+	// Folds `op` over data with `identity` as the starting value of every chunk, then folds the chunk results.
+	// `op` must be associative and accept (T, element) as well as (T, T), e.g. std::plus<>.
+	template<typename Seq, typename T, typename Op>
+	T reduce(const Seq& data, T identity, Op&& op, const std::size_t grain = defaultGrainSize);
+
+	// Runs every node once its dependencies are done and blocks until the whole graph has finished.
+	// Compiles the graph first if it changed, a graph must not be run from two threads at once.
+	void RunGraph(TaskGraph& graph);
+
+#if ENGINE_ENABLE_COROUTINES
+	// Coroutines
+	class ScheduleAwaiter {
+	public:
+		explicit ScheduleAwaiter(Scheduler* _scheduler) : scheduler(_scheduler) {}
+		bool await_ready() const noexcept {
+			return false;
+		}
+		void await_suspend(std::coroutine_handle<> handle) {
+			this->scheduler->AddTask([handle]() { handle.resume(); });
+		}
+		void await_resume() const noexcept {}
+
+	private:
+		Scheduler* scheduler;
+	};
+
+	class FrameAwaiter {
+	public:
+		explicit FrameAwaiter(Scheduler* _scheduler) : scheduler(_scheduler) {}
+		bool await_ready() const noexcept {
+			return false;
+		}
+		void await_suspend(std::coroutine_handle<> handle) {
+			std::lock_guard<std::mutex> lock(this->scheduler->frameWaitersMutex);
+			this->scheduler->frameWaiters.push_back(handle);
+		}
+		void await_resume() const noexcept {}
+
+	private:
+		Scheduler* scheduler;
+	};
+
+	// co_await scheduler->schedule(): continues on a worker thread (inline when there are none).
+	ScheduleAwaiter schedule();
+	// co_await scheduler->nextFrame(): continues on the main thread at the start of the next frame.
+	FrameAwaiter nextFrame();
+	// Starts `task` on the calling thread, it then runs to completion on its own.
+	// Pass coroutine functions rather than capturing lambdas, the captures die with the closure while the coroutine is suspended.
+	void Spawn(CoTask<> task);
+	// Resumes every coroutine waiting on nextFrame(), the engine calls this on the main thread once per frame.
+	// Returns how many were resumed, ones that await nextFrame() again wait for the following call.
+	std::size_t ResumeFrameWaiters();
+#endif
+
+private:
+	friend TaskCounter;
+
+	// Runs `node`, then keeps going with one of the successors it made ready and schedules the rest.
+	void runGraphNode(TaskGraph& graph, std::size_t node, TaskCounter& counter);
+	// Decrements `counter` once `task` returns or throws, keeping the exception for WaitForCounter.
+	static Task withCounter(Task task, TaskCounter* counter);
+	// WaitForCounter without rethrowing
+	void waitFor(TaskCounter& counter);
+
+	SchedulerOptions options;
+	std::size_t numThreads;
+#if ENGINE_ENABLE_MULTITHREADED
+	std::unique_ptr<ftl::TaskScheduler> taskScheduler;
+	std::thread::id mainThread;
+
+	// Only the main thread and FTL workers may wait on FTL counters.
+	bool canUseFibers() const;
+#endif
+	// Workers are only started on first use, so engines that never fan out (or run many at once) stay cheap.
+	std::once_flag poolOnce;
+	std::unique_ptr<WorkStealingPool> pool;
+
+	bool usesFibers() const;
+	WorkStealingPool& getPool();
+
+#if ENGINE_ENABLE_COROUTINES
+	std::mutex frameWaitersMutex;
+	std::vector<std::coroutine_handle<>> frameWaiters;
+	// Swapped with frameWaiters, keeps its capacity between frames.
+	std::vector<std::coroutine_handle<>> resuming;
+#endif
 };
+
+template<typename F>
+void Scheduler::parallel_for_chunks(const std::size_t begin, const std::size_t end, const std::size_t grain, F&& f) {
+	if (end <= begin) {
+		return;
+	}
+	const std::size_t count = end - begin;
+	const std::size_t chunkSize = std::max<std::size_t>(grain, 1);
+	if (count <= chunkSize || this->numThreads <= 1) {
+		f(begin, end);
+		return;
+	}
+
+	TaskCounter counter(this);
+	std::vector<Task> tasks;
+	tasks.reserve((count + chunkSize - 1) / chunkSize);
+	// The caller runs the first chunk itself.
+	for (std::size_t chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize) {
+		const std::size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+		tasks.emplace_back([&f, chunkBegin, chunkEnd]() { f(chunkBegin, chunkEnd); });
+	}
+	this->AddTasks(std::move(tasks), &counter);
+	try {
+		f(begin, std::min(begin + chunkSize, end));
+	} catch (...) {
+		// The other chunks still use `f` and `counter`.
+		this->waitFor(counter);
+		throw;
+	}
+	this->WaitForCounter(counter);
+}
+
+template<typename F>
+void Scheduler::parallel_for(const std::size_t begin, const std::size_t end, const std::size_t grain, F&& f) {
+	this->parallel_for_chunks(begin, end, grain, [&f](const std::size_t chunkBegin, const std::size_t chunkEnd) {
+		for (std::size_t i = chunkBegin; i < chunkEnd; ++i) {
+			f(i);
+		}
+	});
+}
+
+template<typename F>
+void Scheduler::parallel_for(const std::size_t begin, const std::size_t end, F&& f) {
+	this->parallel_for(begin, end, defaultGrainSize, std::forward<F>(f));
+}
+
+template<typename Seq, typename F>
+auto Scheduler::map(const Seq& data, F&& f, const std::size_t grain) -> std::vector<std::decay_t<decltype(f(*std::begin(data)))>> {
+	using Output = std::decay_t<decltype(f(*std::begin(data)))>;
+	// std::vector<bool> packs bits, so writing neighbouring elements from different threads would race.
+	static_assert(!std::is_same<Output, bool>::value, "Scheduler::map can't produce bools, return char or int instead");
+	const auto first = std::begin(data);
+	const auto size = static_cast<std::size_t>(std::distance(first, std::end(data)));
+
+	std::vector<Output> out(size);
+	this->parallel_for_chunks(0, size, grain, [&out, &f, first](const std::size_t chunkBegin, const std::size_t chunkEnd) {
+		auto it = std::next(first, static_cast<std::ptrdiff_t>(chunkBegin));
+		for (std::size_t i = chunkBegin; i < chunkEnd; ++i, ++it) {
+			out[i] = f(*it);
+		}
+	});
+	return out;
+}
+
+template<typename Seq, typename T, typename Op>
+T Scheduler::reduce(const Seq& data, T identity, Op&& op, const std::size_t grain) {
+	const auto first = std::begin(data);
+	const auto size = static_cast<std::size_t>(std::distance(first, std::end(data)));
+	if (size == 0) {
+		return identity;
+	}
+
+	const std::size_t chunkSize = std::max<std::size_t>(grain, 1);
+	std::vector<T> partials((size + chunkSize - 1) / chunkSize, identity);
+	this->parallel_for_chunks(0, size, chunkSize, [&partials, &op, first, chunkSize](const std::size_t chunkBegin, const std::size_t chunkEnd) {
+		T& partial = partials[chunkBegin / chunkSize];
+		auto it = std::next(first, static_cast<std::ptrdiff_t>(chunkBegin));
+		for (std::size_t i = chunkBegin; i < chunkEnd; ++i, ++it) {
+			partial = op(partial, *it);
+		}
+	});
+
+	// Combine in chunk order so non-commutative ops still get a deterministic result.
+	T result = identity;
+	for (const auto& partial : partials) {
+		result = op(result, partial);
+	}
+	return result;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Scheduler;
+
+// Axis-aligned box, GameObjects span [position, position + size].
+struct Aabb2D {
+	glm::vec2 min = glm::vec2(0.0f);
+	glm::vec2 max = glm::vec2(0.0f);
+
+	static Aabb2D FromPositionSize(const glm::vec2& position, const glm::vec2& size) {
+		return { position, position + size };
+	}
+
+	// Touching edges count as overlapping.
+	bool Overlaps(const Aabb2D& other) const {
+		return this->min.x <= other.max.x && other.min.x <= this->max.x && this->min.y <= other.max.y && other.min.y <= this->max.y;
+	}
+};
+
+// Broad-phase for 2D overlap tests: an unbounded uniform grid whose cells are hashed into a fixed number of buckets.
+// Every box is listed in the buckets of all cells it touches, so the cell size should be about the size of a typical
+// object; much larger objects still work but cost one bucket entry per cell.
+// Objects are identified by caller-chosen ids (an index or handle), kept dense since entries are indexed by id.
+// Insert/Update/Remove are incremental and single-threaded; queries are const and may run concurrently.
+class SpatialHash2D {
+public:
+	using Id = std::uint32_t;
+	using Pair = std::pair<Id, Id>;
+
+	static constexpr std::size_t defaultBucketCount = 4096;
+
+	// The bucket count is rounded up to a power of two, about one bucket per object keeps the buckets short.
+	explicit SpatialHash2D(const float cellSize, const std::size_t bucketCount = defaultBucketCount);
+
+	// Throws std::invalid_argument if the id is already present.
+	void Insert(const Id id, const Aabb2D& box);
+	// Only touches the buckets when the box moved into different cells.
+	void Update(const Id id, const Aabb2D& box);
+	void Remove(const Id id);
+	bool contains(const Id id) const;
+	void Clear();
+	// Replaces everything with boxes[i] as id i, the buckets are filled in parallel when given a scheduler.
+	void Rebuild(const std::vector<Aabb2D>& boxes, Scheduler* scheduler = nullptr);
+
+	std::size_t size() const;
+	float getCellSize() const;
+
+	// Ids whose box overlaps `region`, in ascending order.
+	void QueryRegion(const Aabb2D& region, std::vector<Id>& out) const;
+	// Every overlapping pair once as (smaller id, larger id), sorted, so the order doesn't depend on the thread count.
+	void FindPairs(std::vector<Pair>& out, Scheduler* scheduler = nullptr) const;
+
+private:
+	struct CellRange {
+		int x0 = 0;
+		int y0 = 0;
+		int x1 = -1;
+		int y1 = -1;
+
+		bool operator==(const CellRange& other) const {
+			return this->x0 == other.x0 && this->y0 == other.y0 && this->x1 == other.x1 && this->y1 == other.y1;
+		}
+	};
+
+	struct Entry {
+		Aabb2D box;
+		CellRange cells;
+		bool present = false;
+	};
+
+	float cellSize;
+	float inverseCellSize;
+	std::size_t bucketMask;
+	// An id shows up once per touched cell, cells that collide share a bucket.
+	std::vector<std::vector<Id>> buckets;
+	std::vector<Entry> entries;
+	std::size_t count = 0;
+
+	CellRange cellsOf(const Aabb2D& box) const;
+	std::size_t bucketOf(const int x, const int y) const;
+	void addToBuckets(const Id id, const CellRange& cells);
+	void removeFromBuckets(const Id id, const CellRange& cells);
+	// Overlapping pairs found in buckets [begin, end), unsorted.
+	void collectPairs(const std::size_t begin, const std::size_t end, std::vector<Pair>& out) const;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Breaks time-to-first-frame down by subsystem.
+// Times are milliseconds since the Engine was constructed, Record is safe to call from any thread.
+class StartupTrace {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry {
+		std::string name;
+		double start = 0.0;
+		double duration = 0.0;
+		// False when the subsystem was brought up on a background thread.
+		bool mainThread = true;
+	};
+
+	StartupTrace();
+
+	// Not copyable
+	StartupTrace(const StartupTrace&) = delete;
+	StartupTrace& operator=(const StartupTrace&) = delete;
+
+	void Record(const std::string& name, const Clock::time_point& start, const Clock::time_point& end);
+	// Only the first call counts.
+	void MarkFirstFrame();
+
+	// 0 until the first frame has been presented.
+	double getTimeToFirstFrame() const;
+	std::vector<Entry> getEntries() const;
+
+private:
+	Clock::time_point origin;
+	std::thread::id mainThread;
+
+	mutable std::mutex mutex;
+	std::vector<Entry> entries;
+	double timeToFirstFrame = 0.0;
+
+	double sinceOrigin(const Clock::time_point& time) const;
+};
+
+// Records the enclosing scope into a StartupTrace.
+class StartupScope {
+public:
+	StartupScope(StartupTrace* trace, const std::string& name);
+	~StartupScope();
+
+	StartupScope(const StartupScope&) = delete;
+	StartupScope& operator=(const StartupScope&) = delete;
+
+private:
+	StartupTrace* trace;
+	std::string name;
+	StartupTrace::Clock::time_point start;
+};
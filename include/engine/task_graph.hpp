@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Scheduler;
+
+// A DAG of frame work, built once and run every frame with Scheduler::RunGraph.
+// Compile() validates the graph and lays out the roots, successor lists and predecessor counts once, so a run only
+// resets the counters. Each node that runs in parallel is still submitted as its own scheduler task, which allocates.
+class TaskGraph {
+public:
+	using NodeId = std::size_t;
+	using Task = std::function<void()>;
+
+	TaskGraph() = default;
+
+	// Not copyable
+	TaskGraph(const TaskGraph&) = delete;
+	TaskGraph& operator=(const TaskGraph&) = delete;
+
+	NodeId AddNode(const std::string& name, Task task);
+	// `after` only starts once `before` has finished.
+	void AddDependency(const NodeId before, const NodeId after);
+
+	// Throws std::invalid_argument if the dependencies form a cycle.
+	void Compile();
+	bool isCompiled() const;
+
+	std::size_t size() const;
+	const std::string& getName(const NodeId node) const;
+	// A valid serial order, only available once compiled.
+	const std::vector<NodeId>& getExecutionOrder() const;
+
+private:
+	friend Scheduler;
+
+	struct Node {
+		std::string name;
+		// Interned copy of `name` for trace events
+		const char* traceName = nullptr;
+		Task task;
+		std::vector<NodeId> successors;
+		std::size_t numPredecessors = 0;
+	};
+
+	std::vector<Node> nodes;
+	bool compiled = false;
+
+	// Filled by Compile
+	std::vector<NodeId> roots;
+	std::vector<NodeId> order;
+	// Predecessors still running in the current run
+	std::unique_ptr<std::atomic<std::size_t>[]> remaining;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+// Timeline of engine, scheduler and game events, written as Chrome trace-event JSON (opens in Perfetto and chrome://tracing).
+// Every thread records into its own ring buffer without locking, once full the oldest events are overwritten,
+// so a trace always holds the last stretch of time. Names and details must outlive the trace (string literals or Intern()).
+// Removed entirely with ENGINE_ENABLE_TRACING=0, a single relaxed load per event while compiled in but not started.
+class Tracer {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t defaultEventsPerThread = 16384;
+
+	// Starts recording, dropping whatever the buffers held. Buffer size is fixed by the first call.
+	static void Start(const std::size_t eventsPerThread = defaultEventsPerThread);
+	// Stops recording, the buffers keep their events for writing.
+	static void Stop();
+	// Counted Start/Stop for owners that may overlap, e.g. several engines each writing a trace: only the first
+	// BeginSession starts (and clears the buffers) and only the last EndSession stops. Everyone shares one recording.
+	static void BeginSession(const std::size_t eventsPerThread = defaultEventsPerThread);
+	static void EndSession();
+	static bool isEnabled() noexcept {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	static void Complete(const char* category, const char* name, const Clock::time_point& start, const Clock::time_point& end, const char* detail = nullptr) noexcept;
+	static void Instant(const char* category, const char* name, const char* detail = nullptr) noexcept;
+	// Names the calling thread's track.
+	static void SetThreadName(const std::string& name);
+	// Copy of `text` that lives until exit, equal strings share one copy.
+	static const char* Intern(const std::string& text);
+
+	// Everything the buffers hold, or only events that ended within the last `window` when it is non-zero.
+	// Safe while other threads keep recording.
+	static void WriteChromeTrace(std::ostream& out, const Clock::duration& window = Clock::duration::zero());
+	// False if the file couldn't be opened.
+	static bool WriteChromeTrace(const std::string& path, const Clock::duration& window = Clock::duration::zero());
+
+private:
+	static std::atomic<bool> enabled;
+};
+
+// Records the enclosing scope as one event, see ENGINE_TRACE_SCOPE.
+class TraceScope {
+public:
+	TraceScope(const char* category, const char* name, const char* detail = nullptr) noexcept;
+	~TraceScope();
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	const char* category;
+	const char* name;
+	const char* detail;
+	Tracer::Clock::time_point start;
+	bool active;
+};
+
+#define ENGINE_TRACE_CONCAT_IMPL(a, b) a##b
+#define ENGINE_TRACE_CONCAT(a, b) ENGINE_TRACE_CONCAT_IMPL(a, b)
+
+#if ENGINE_ENABLE_TRACING
+	// Usage: ENGINE_TRACE_SCOPE("asset", "LoadTexture");
+	#define ENGINE_TRACE_SCOPE(category, name) \
+		const TraceScope ENGINE_TRACE_CONCAT(engine_trace_scope_, __LINE__)(category, name)
+	// `detail` is a std::string, only interned while tracing.
+	#define ENGINE_TRACE_SCOPE_DETAIL(category, name, detail) \
+		const TraceScope ENGINE_TRACE_CONCAT(engine_trace_scope_, __LINE__)(category, name, Tracer::isEnabled() ? Tracer::Intern(detail) : nullptr)
+	#define ENGINE_TRACE_INSTANT(category, name) Tracer::Instant(category, name)
+	#define ENGINE_TRACE_THREAD_NAME(name) Tracer::SetThreadName(name)
+#else
+	#define ENGINE_TRACE_SCOPE(category, name) static_cast<void>(0)
+	#define ENGINE_TRACE_SCOPE_DETAIL(category, name, detail) static_cast<void>(0)
+	#define ENGINE_TRACE_INSTANT(category, name) static_cast<void>(0)
+	#define ENGINE_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
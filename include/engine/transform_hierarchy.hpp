@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+class Scheduler;
+
+// Local translation, rotation and scale relative to the parent, applied as T * R * S.
+struct Transform {
+	glm::vec3 translation = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+
+	glm::mat4 toMatrix() const;
+};
+
+// Scene graph of transforms with cached world matrices, e.g. one node per placed Model, passed to Model::Draw.
+// Nodes are kept in one contiguous array in depth-first order, so every parent comes before its children and each
+// subtree is a contiguous range. Update walks that array once, recomputing only nodes whose local transform changed
+// or that sit below one that did; static props cost a flag check. Separate subtrees are updated in parallel.
+// Node ids stay valid until the node is destroyed. Not thread-safe to modify.
+class TransformHierarchy {
+public:
+	using NodeId = std::uint32_t;
+	static constexpr NodeId nullNode = 0xFFFFFFFFu;
+
+	TransformHierarchy() = default;
+	~TransformHierarchy() = default;
+
+	// A root node when parent is nullNode, otherwise the last child of parent.
+	NodeId Create(const Transform& local = Transform(), const NodeId parent = nullNode);
+	// Destroys the node and everything below it.
+	void Destroy(const NodeId node);
+	// Keeps the local transform, so the node's world matrix changes with its new parent.
+	// Throws std::invalid_argument if that would make a node its own ancestor.
+	void SetParent(const NodeId node, const NodeId parent);
+	bool isAlive(const NodeId node) const;
+	std::size_t size() const;
+
+	NodeId getParent(const NodeId node) const;
+	const Transform& getLocal(const NodeId node) const;
+	void setLocal(const NodeId node, const Transform& local);
+	// As of the last Update
+	const glm::mat4& getWorld(const NodeId node) const;
+	// Whether the last Update recomputed the node's world matrix, e.g. to move it in a DynamicBvh.
+	bool isWorldChanged(const NodeId node) const;
+
+	// Recomputes the world matrices of dirty nodes and their descendants, across `scheduler`'s threads when given one.
+	void Update(Scheduler* scheduler = nullptr);
+
+	// Node ids in depth-first order as of the last Update, parents before their children.
+	const std::vector<NodeId>& getOrder() const;
+
+private:
+	static constexpr std::uint32_t noParent = 0xFFFFFFFFu;
+
+	// Per id, stable while the node lives
+	struct Link {
+		NodeId parent = nullNode;
+		NodeId firstChild = nullNode;
+		NodeId lastChild = nullNode;
+		NodeId nextSibling = nullNode;
+		NodeId previousSibling = nullNode;
+		// Position in the arrays below; nodes created since the last Update are appended at the end
+		std::uint32_t index = 0;
+		bool alive = false;
+	};
+
+	std::vector<Link> links;
+	std::vector<NodeId> freeIds;
+	NodeId firstRoot = nullNode;
+	NodeId lastRoot = nullNode;
+	std::size_t count = 0;
+	// Set when nodes were added, removed or reparented, the order is rebuilt in the next Update.
+	bool orderChanged = false;
+
+	// Ordered by depth-first traversal
+	std::vector<NodeId> order;
+	// noParent for roots
+	std::vector<std::uint32_t> parentIndex;
+	// One past the last node of each subtree
+	std::vector<std::uint32_t> subtreeEnd;
+	std::vector<Transform> locals;
+	std::vector<glm::mat4> worlds;
+	// Local transform changed since the last Update
+	std::vector<std::uint8_t> dirty;
+	// World matrix recomputed by the last Update
+	std::vector<std::uint8_t> changed;
+
+	// Subtree ranges updated as one task each, after the nodes above them (`heads`) are done serially.
+	struct Range {
+		std::uint32_t begin;
+		std::uint32_t end;
+	};
+	std::vector<std::uint32_t> heads;
+	std::vector<Range> ranges;
+	std::size_t plannedThreads = 0;
+
+	const Link& checkedLink(const NodeId node) const;
+	void attach(const NodeId node, const NodeId parent);
+	void detach(const NodeId node);
+	void rebuildOrder();
+	void planRanges(const std::size_t numThreads);
+	void updateNode(const std::uint32_t index);
+	void updateRange(const std::uint32_t begin, const std::uint32_t end);
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "chase_lev_deque.hpp"
+
+// Fixed set of worker threads, each with its own Chase-Lev deque.
+// Workers push follow-up work onto their own deque and steal from others when they run dry,
+// other threads submit through a shared injection queue.
+class WorkStealingPool {
+public:
+	using Task = std::function<void()>;
+
+	struct Options {
+		// 0 uses every hardware thread, minus one when the main thread is reserved.
+		std::size_t numWorkers = 0;
+		// Keep a core for the main (GL) thread, workers are then never pinned to the main thread's CPU.
+		bool reserveMainThread = true;
+		// Pin worker i to cpus[i % cpus.size()], or to consecutive CPUs when `cpus` is empty.
+		bool pinWorkers = false;
+		std::vector<unsigned int> cpus;
+	};
+
+	explicit WorkStealingPool(const Options& options);
+	~WorkStealingPool();
+
+	// Not copyable
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	std::size_t getNumWorkers() const;
+
+	void Submit(Task task);
+	void Submit(std::vector<Task>& tasks);
+	// Runs one pending task on the calling thread, false if none could be found.
+	bool RunOne();
+
+	// Pins the calling thread to `cpu`, false when unsupported (macOS) or it failed.
+	static bool PinCurrentThread(const unsigned int cpu);
+
+private:
+	struct Worker {
+		ChaseLevDeque<Task> deque;
+		std::thread thread;
+		std::uint32_t rng = 0;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	// Submissions from threads outside the pool
+	std::mutex injectionMutex;
+	std::deque<Task*> injection;
+	std::atomic<std::size_t> injectionSize{0};
+
+	// Idle workers sleep until `epoch` changes.
+	std::mutex sleepMutex;
+	std::condition_variable sleepCv;
+	std::atomic<std::uint64_t> epoch{0};
+	std::atomic<std::size_t> sleepers{0};
+	std::atomic<bool> stopping{false};
+
+	void workerLoop(const std::size_t index);
+	Task* findTask(Worker* self, std::uint32_t& rng);
+	Task* popInjection();
+	void wake(const std::size_t count);
+};
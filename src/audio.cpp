@@ -1,4 +1,6 @@
 #include "engine/audio.hpp"
+#include "engine/frame_arena.hpp"
+#include "engine/trace.hpp"
 
 #include <vector>
 
@@ -8,6 +10,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 #if ENGINE_ENABLE_AUDIO
 #include "AL/alc.h"
@@ -262,20 +265,20 @@ namespace openal {
             if (buffersProcessed <= 0) {
                 return;
             }
+            ENGINE_TRACE_SCOPE("audio", "StreamRefill");
+
+            // Scratch space for the refill, from the frame arena instead of a fresh 64 KiB heap block per buffer.
+            char* data = FrameArena::Local().AllocateArray<char>(SoundDefinition::BUFFER_SIZE);
 
             while (buffersProcessed--) {
                 ALuint buffer;
                 alCall(alSourceUnqueueBuffers, audioData->source, 1, &buffer);
 
-                std::vector<char> data;
-                data.resize(SoundDefinition::BUFFER_SIZE);
-                data.erase(data.begin(), data.end());
-
                 long dataSizeToBuffer = 0;
                 long sizeRead = 0;
 
                 while (sizeRead < SoundDefinition::BUFFER_SIZE) {
-                    const long result = ov_read(&audioData->oggVorbisFile, &data.data()[sizeRead], SoundDefinition::BUFFER_SIZE - static_cast<int>(sizeRead), 0, 2, 1, &audioData->oggCurrentSection);
+                    const long result = ov_read(&audioData->oggVorbisFile, &data[sizeRead], SoundDefinition::BUFFER_SIZE - static_cast<int>(sizeRead), 0, 2, 1, &audioData->oggCurrentSection);
                     if (result == OV_HOLE) {
                         std::cerr << "ERROR: OV_HOLE found in update of buffer " << std::endl;
                         break;
@@ -310,7 +313,7 @@ namespace openal {
                 dataSizeToBuffer = sizeRead;
 
                 if (dataSizeToBuffer > 0) {
-                    alCall(alBufferData, buffer, audioData->format, data.data(), static_cast<int>(dataSizeToBuffer), audioData->sampleRate);
+                    alCall(alBufferData, buffer, audioData->format, data, static_cast<int>(dataSizeToBuffer), audioData->sampleRate);
                     alCall(alSourceQueueBuffers, audioData->source, 1, &buffer);
                 }
 
@@ -613,9 +616,7 @@ namespace openal {
 // Start AudioEngine Impl
 //////////////////////////////////////////
 
-AudioEngine::AudioEngine() : isShutdown(false), sounds() {
-    this->Init();
-}
+AudioEngine::AudioEngine(const bool _enabled, StartupTrace* _trace) : enabled(_enabled), initialized(false), isShutdown(false), trace(_trace), pendingInit(), sounds() {}
 
 AudioEngine::~AudioEngine() {
     if (!this->isShutdown) {
@@ -623,16 +624,45 @@ AudioEngine::~AudioEngine() {
     }
 }
 
-void AudioEngine::Init() {
+void AudioEngine::openDevice() {
+    if (!this->enabled || this->initialized.load()) {
+        return;
+    }
+    const StartupScope scope(this->trace, "Audio");
 #if ENGINE_ENABLE_AUDIO
     if (openal::InitAL() != 0) {
         throw std::runtime_error("Failed to initalize OpenAL");
     }
 #endif
+    this->initialized.store(true);
+}
+
+void AudioEngine::Init() {
+    if (this->pendingInit.valid()) {
+        // Rethrows if the background init failed.
+        this->pendingInit.get();
+    }
+    this->openDevice();
+}
+
+void AudioEngine::InitAsync() {
+    if (!this->enabled || this->initialized.load() || this->pendingInit.valid()) {
+        return;
+    }
+    // OpenAL's current context is process-wide, so it doesn't matter which thread creates it.
+    this->pendingInit = std::async(std::launch::async, [this]() { this->openDevice(); });
+}
+
+bool AudioEngine::isInitialized() const {
+    return this->initialized.load();
 }
 
 void AudioEngine::Update() {
 #if ENGINE_ENABLE_AUDIO
+    // Nothing can be playing before the first sound is loaded.
+    if (!this->enabled || this->sounds.empty()) {
+        return;
+    }
     for (auto& thisSound : this->sounds) {
         if ((alGetError() == AL_NO_ERROR && thisSound.second->state == AL_PLAYING) || thisSound.second->is_ogg) {
             if (thisSound.second->is_ogg) {
@@ -651,13 +681,27 @@ void AudioEngine::Update() {
 }
 
 void AudioEngine::Shutdown() {
+    if (this->pendingInit.valid()) {
+        try {
+            this->pendingInit.get();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
 #if ENGINE_ENABLE_AUDIO
-    openal::CloseAL();
+    if (this->initialized.load()) {
+        openal::CloseAL();
+    }
 #endif
+    this->initialized.store(false);
     this->isShutdown = true;
 }
 
 void AudioEngine::LoadSound([[maybe_unused]] const std::string& strSoundName, [[maybe_unused]] bool bLooping) {
+    if (!this->enabled) {
+        return;
+    }
+    this->Init();
     this->sounds.emplace(strSoundName, std::make_unique<SoundDefinition>()); // Create default SoundDefinition
 #if ENGINE_ENABLE_AUDIO
     auto* sound = this->sounds.at(strSoundName).get();
@@ -695,6 +739,9 @@ void AudioEngine::LoadSound([[maybe_unused]] const std::string& strSoundName, [[
 
 void AudioEngine::Play([[maybe_unused]] const std::string& strSoundName) {
 #if ENGINE_ENABLE_AUDIO
+    if (!this->enabled) {
+        return;
+    }
     auto* thisSound = this->sounds.at(strSoundName).get();
     alSourceStop(thisSound->source);
     alSourcePlay(thisSound->source);
@@ -702,6 +749,9 @@ void AudioEngine::Play([[maybe_unused]] const std::string& strSoundName) {
 }
 
 void AudioEngine::UnLoadSound(const std::string& strSoundName) {
+    if (!this->isLoaded(strSoundName)) {
+        return;
+    }
 #if ENGINE_ENABLE_AUDIO
     auto& thisSound = this->sounds.at(strSoundName);
 
@@ -723,3 +773,7 @@ bool AudioEngine::IsPlaying([[maybe_unused]] const std::string& strSoundName) co
 bool AudioEngine::isLoaded(const std::string& soundName) const {
     return this->sounds.find(soundName) != this->sounds.end();
 }
+
+bool AudioEngine::isEnabled() const {
+    return this->enabled;
+}
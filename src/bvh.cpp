@@ -0,0 +1,262 @@
+#include "engine/bvh.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+DynamicBvh::DynamicBvh(const float _margin) : margin(_margin) {
+	if (!(_margin >= 0.0f)) {
+		throw std::invalid_argument("DynamicBvh margin must not be negative");
+	}
+}
+
+DynamicBvh::ProxyId DynamicBvh::allocateNode() {
+	if (this->freeList == nullProxy) {
+		this->nodes.emplace_back();
+		this->nodes.back().height = 0;
+		return static_cast<ProxyId>(this->nodes.size() - 1);
+	}
+	const ProxyId index = this->freeList;
+	Node& node = this->nodes[static_cast<std::size_t>(index)];
+	this->freeList = node.left;
+	node = Node();
+	node.height = 0;
+	return index;
+}
+
+void DynamicBvh::freeNode(const ProxyId index) {
+	Node& node = this->nodes[static_cast<std::size_t>(index)];
+	node.left = this->freeList;
+	node.right = nullProxy;
+	node.height = -1;
+	this->freeList = index;
+}
+
+const DynamicBvh::Node& DynamicBvh::checkedLeaf(const ProxyId proxy) const {
+	if (proxy < 0 || static_cast<std::size_t>(proxy) >= this->nodes.size() || this->nodes[static_cast<std::size_t>(proxy)].height != 0) {
+		throw std::out_of_range("DynamicBvh has no proxy " + std::to_string(proxy));
+	}
+	return this->nodes[static_cast<std::size_t>(proxy)];
+}
+
+DynamicBvh::ProxyId DynamicBvh::Insert(const Aabb3D& box, const std::uint32_t userData) {
+	const ProxyId leaf = this->allocateNode();
+	Node& node = this->nodes[static_cast<std::size_t>(leaf)];
+	node.box = box.Inflated(this->margin);
+	node.userData = userData;
+	this->insertLeaf(leaf);
+	this->leafCount += 1;
+	return leaf;
+}
+
+void DynamicBvh::Remove(const ProxyId proxy) {
+	this->checkedLeaf(proxy);
+	this->removeLeaf(proxy);
+	this->freeNode(proxy);
+	this->leafCount -= 1;
+}
+
+bool DynamicBvh::Move(const ProxyId proxy, const Aabb3D& box) {
+	if (this->checkedLeaf(proxy).box.Contains(box)) {
+		return false;
+	}
+	this->removeLeaf(proxy);
+	this->nodes[static_cast<std::size_t>(proxy)].box = box.Inflated(this->margin);
+	this->insertLeaf(proxy);
+	return true;
+}
+
+void DynamicBvh::Clear() {
+	this->nodes.clear();
+	this->root = nullProxy;
+	this->freeList = nullProxy;
+	this->leafCount = 0;
+}
+
+const Aabb3D& DynamicBvh::getFatBounds(const ProxyId proxy) const {
+	return this->checkedLeaf(proxy).box;
+}
+
+std::uint32_t DynamicBvh::getUserData(const ProxyId proxy) const {
+	return this->checkedLeaf(proxy).userData;
+}
+
+std::size_t DynamicBvh::size() const {
+	return this->leafCount;
+}
+
+int DynamicBvh::getHeight() const {
+	return this->root == nullProxy ? 0 : this->nodes[static_cast<std::size_t>(this->root)].height;
+}
+
+float DynamicBvh::getMargin() const {
+	return this->margin;
+}
+
+DynamicBvh::ProxyId DynamicBvh::findBestSibling(const Aabb3D& box) const {
+	// Surface area heuristic: pairing `box` with node N costs the area of their union plus how much every ancestor
+	// of N grows. Walks down towards the child with the lower bound on that cost and stops once neither child can
+	// beat the best node seen, so an insertion looks at two nodes per level.
+	const float boxArea = box.getSurfaceArea();
+	ProxyId index = this->root;
+	ProxyId best = index;
+	float bestCost = box.Merged(this->nodes[static_cast<std::size_t>(index)].box).getSurfaceArea();
+	// Growth of the ancestors above the children of `index`
+	float inherited = 0.0f;
+	while (!this->nodes[static_cast<std::size_t>(index)].isLeaf()) {
+		const Node& node = this->nodes[static_cast<std::size_t>(index)];
+		inherited += box.Merged(node.box).getSurfaceArea() - node.box.getSurfaceArea();
+
+		ProxyId next = nullProxy;
+		float nextBound = bestCost;
+		for (const ProxyId childIndex : { node.left, node.right }) {
+			const Node& child = this->nodes[static_cast<std::size_t>(childIndex)];
+			const float merged = box.Merged(child.box).getSurfaceArea();
+			const float cost = merged + inherited;
+			if (cost < bestCost) {
+				best = childIndex;
+				bestCost = cost;
+			}
+			// Anything below costs at least the box's own area plus the growth down to here.
+			const float bound = child.isLeaf() ? cost : boxArea + inherited + merged - child.box.getSurfaceArea();
+			if (!child.isLeaf() && bound < nextBound) {
+				next = childIndex;
+				nextBound = bound;
+			}
+		}
+		if (next == nullProxy || nextBound >= bestCost) {
+			break;
+		}
+		index = next;
+	}
+	return best;
+}
+
+void DynamicBvh::insertLeaf(const ProxyId leaf) {
+	if (this->root == nullProxy) {
+		this->root = leaf;
+		this->nodes[static_cast<std::size_t>(leaf)].parent = nullProxy;
+		return;
+	}
+
+	const Aabb3D box = this->nodes[static_cast<std::size_t>(leaf)].box;
+	const ProxyId sibling = this->findBestSibling(box);
+
+	// Nodes may move when allocating, take references afterwards.
+	const ProxyId parent = this->allocateNode();
+	const ProxyId oldParent = this->nodes[static_cast<std::size_t>(sibling)].parent;
+	Node& newParent = this->nodes[static_cast<std::size_t>(parent)];
+	newParent.parent = oldParent;
+	newParent.box = box.Merged(this->nodes[static_cast<std::size_t>(sibling)].box);
+	newParent.height = this->nodes[static_cast<std::size_t>(sibling)].height + 1;
+	newParent.left = sibling;
+	newParent.right = leaf;
+	this->nodes[static_cast<std::size_t>(sibling)].parent = parent;
+	this->nodes[static_cast<std::size_t>(leaf)].parent = parent;
+
+	if (oldParent == nullProxy) {
+		this->root = parent;
+	} else {
+		Node& grandparent = this->nodes[static_cast<std::size_t>(oldParent)];
+		if (grandparent.left == sibling) {
+			grandparent.left = parent;
+		} else {
+			grandparent.right = parent;
+		}
+	}
+	this->refitAncestors(this->nodes[static_cast<std::size_t>(leaf)].parent);
+}
+
+void DynamicBvh::removeLeaf(const ProxyId leaf) {
+	if (leaf == this->root) {
+		this->root = nullProxy;
+		return;
+	}
+
+	const ProxyId parent = this->nodes[static_cast<std::size_t>(leaf)].parent;
+	const Node& parentNode = this->nodes[static_cast<std::size_t>(parent)];
+	const ProxyId grandparent = parentNode.parent;
+	const ProxyId sibling = parentNode.left == leaf ? parentNode.right : parentNode.left;
+
+	// The sibling takes the parent's place.
+	this->nodes[static_cast<std::size_t>(sibling)].parent = grandparent;
+	this->freeNode(parent);
+	if (grandparent == nullProxy) {
+		this->root = sibling;
+		return;
+	}
+	Node& grandparentNode = this->nodes[static_cast<std::size_t>(grandparent)];
+	if (grandparentNode.left == parent) {
+		grandparentNode.left = sibling;
+	} else {
+		grandparentNode.right = sibling;
+	}
+	this->refitAncestors(grandparent);
+}
+
+void DynamicBvh::refitAncestors(ProxyId index) {
+	while (index != nullProxy) {
+		index = this->balance(index);
+		Node& node = this->nodes[static_cast<std::size_t>(index)];
+		const Node& left = this->nodes[static_cast<std::size_t>(node.left)];
+		const Node& right = this->nodes[static_cast<std::size_t>(node.right)];
+		node.box = left.box.Merged(right.box);
+		node.height = 1 + std::max(left.height, right.height);
+		index = node.parent;
+	}
+}
+
+DynamicBvh::ProxyId DynamicBvh::balance(const ProxyId a) {
+	Node& nodeA = this->nodes[static_cast<std::size_t>(a)];
+	if (nodeA.isLeaf() || nodeA.height < 2) {
+		return a;
+	}
+
+	const ProxyId b = nodeA.left;
+	const ProxyId c = nodeA.right;
+	const int difference = this->nodes[static_cast<std::size_t>(c)].height - this->nodes[static_cast<std::size_t>(b)].height;
+	if (difference >= -1 && difference <= 1) {
+		return a;
+	}
+
+	// Lift the taller child `up` into a's place; a keeps the shorter child and the shorter of up's children,
+	// up keeps its taller child.
+	const ProxyId up = difference > 1 ? c : b;
+	const ProxyId other = difference > 1 ? b : c;
+	Node& nodeUp = this->nodes[static_cast<std::size_t>(up)];
+	const ProxyId f = nodeUp.left;
+	const ProxyId g = nodeUp.right;
+	Node& nodeF = this->nodes[static_cast<std::size_t>(f)];
+	Node& nodeG = this->nodes[static_cast<std::size_t>(g)];
+
+	nodeUp.left = a;
+	nodeUp.parent = nodeA.parent;
+	nodeA.parent = up;
+	if (nodeUp.parent == nullProxy) {
+		this->root = up;
+	} else {
+		Node& parent = this->nodes[static_cast<std::size_t>(nodeUp.parent)];
+		if (parent.left == a) {
+			parent.left = up;
+		} else {
+			parent.right = up;
+		}
+	}
+
+	const bool keepF = nodeF.height > nodeG.height;
+	const ProxyId kept = keepF ? f : g;
+	const ProxyId moved = keepF ? g : f;
+	Node& nodeMoved = this->nodes[static_cast<std::size_t>(moved)];
+	nodeUp.right = kept;
+	nodeA.left = other;
+	nodeA.right = moved;
+	nodeMoved.parent = a;
+
+	const Node& nodeOther = this->nodes[static_cast<std::size_t>(other)];
+	const Node& nodeKept = this->nodes[static_cast<std::size_t>(kept)];
+	nodeA.box = nodeOther.box.Merged(nodeMoved.box);
+	nodeA.height = 1 + std::max(nodeOther.height, nodeMoved.height);
+	nodeUp.box = nodeA.box.Merged(nodeKept.box);
+	nodeUp.height = 1 + std::max(nodeA.height, nodeKept.height);
+	return up;
+}
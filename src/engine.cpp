@@ -2,6 +2,12 @@
 #include "engine/debug.hpp"
 
 #include <memory>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <fstream>
+#include <iostream>
+#include <future>
 #include <glad/glad.h>
 
 // Helper function for opengl
@@ -15,20 +21,30 @@ void framebuffer_size_callback([[maybe_unused]] GLFWwindow* window, int width, i
     glCheckError();
 }
 
-Engine::Engine(std::shared_ptr<Game> _g) : SCREEN_SIZE(_g->window_size), game(_g), audioEngine() {
-    this->init_opengl();
+Engine::Engine(std::shared_ptr<Game> _g, const EngineConfig& _config) : config(_config), SCREEN_SIZE(_g->window_size), game(_g), audioEngine(_config.mode != EngineMode::Simulation, &this->startupTrace) {
+    this->steppedInput.reserve(InputQueue::Capacity);
+    this->presentedInput.reserve(InputQueue::Capacity);
+    this->init_subsystems();
     this->game->SetEngineDelegate(this);
 
     // Configure the game
-    this->game->Init();
+    {
+        const StartupScope scope(&this->startupTrace, "Game::Init");
+        this->game->Init();
+    }
 }
 
-Engine::Engine(const ScreenSize& size, std::shared_ptr<Game> _g) : SCREEN_SIZE(size), game(_g), spriteRenderer() {
-    this->init_opengl();
+Engine::Engine(const ScreenSize& size, std::shared_ptr<Game> _g, const EngineConfig& _config) : config(_config), SCREEN_SIZE(size), game(_g), spriteRenderer(), audioEngine(_config.mode != EngineMode::Simulation, &this->startupTrace) {
+    this->steppedInput.reserve(InputQueue::Capacity);
+    this->presentedInput.reserve(InputQueue::Capacity);
+    this->init_subsystems();
     this->game->SetEngineDelegate(this);
 
     // Configure the game
-    this->game->Init();
+    {
+        const StartupScope scope(&this->startupTrace, "Game::Init");
+        this->game->Init();
+    }
 }
 
 Engine::~Engine() {
@@ -36,31 +52,101 @@ Engine::~Engine() {
 }
 
 void Engine::setCustomSpriteRendering(const std::string& resourceName) {
+    if (!this->isRendering()) {
+        return;
+    }
     this->spriteRenderer = SpriteRenderer::UniqueFromCustomShader(this->resourceManager.GetShader(resourceName, __FILE__, __LINE__));
 }
 
-void Engine::key_callback(GLFWwindow* window, int key, [[maybe_unused]] int scancode, int action, [[maybe_unused]] int mode) {
+void Engine::key_callback(GLFWwindow* window, int key, int scancode, int action, int mode) {
     // When a user presses the escape key, we set the WindowShouldClose property to true, closing the application
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
     }
 
-    if (key >= 0 && key < 1024) {
-        if (action == GLFW_PRESS) {
-            // Update 'pressed' after the bool array
-            this->game->Keys[static_cast<std::size_t>(key)] = true;
-            this->game->pressed(key);
+    InputEvent event;
+    event.key = key;
+    event.scancode = scancode;
+    event.action = action;
+    event.mods = mode;
+    event.timestamp = Profiler::Clock::now();
+    this->pushInput(event);
+}
+
+bool Engine::pushInput(const InputEvent& event) {
+    if (event.key < 0 || event.key >= static_cast<int>(this->game->Keys.size())) {
+        return false;
+    }
+    if (event.action != GLFW_PRESS && event.action != GLFW_RELEASE) {
+        return false;
+    }
+    if (!this->inputQueue.Push(event)) {
+#if ENGINE_DEBUG
+        std::cout << "Input queue full, dropping key event" << std::endl;
+#endif
+        return false;
+    }
+    return true;
+}
 
-        } else if (action == GLFW_RELEASE) {
-            this->game->Keys[static_cast<std::size_t>(key)] = false;
-            this->game->KeysProcessed[static_cast<std::size_t>(key)] = false;
-            this->game->released(key);
+void Engine::dispatchInput() {
+    InputEvent event;
+    while (this->inputQueue.Pop(event)) {
+        const auto key = static_cast<std::size_t>(event.key);
+        if (event.action == GLFW_PRESS) {
+            // Update 'pressed' after the bool array
+            this->game->Keys[key] = true;
+            this->game->pressed(event.key);
+        } else {
+            this->game->Keys[key] = false;
+            this->game->KeysProcessed[key] = false;
+            this->game->released(event.key);
         }
+        this->steppedInput.push_back(event.timestamp);
+    }
+}
+
+void Engine::collectSteppedInput() {
+    // Whatever the last step consumed is shown by the next swap.
+    this->presentedInput.insert(this->presentedInput.end(), this->steppedInput.begin(), this->steppedInput.end());
+    this->steppedInput.clear();
+}
+
+ProfileStats Engine::getInputLatencyStats() const {
+    return this->inputLatency.getStats();
+}
+
+std::uint64_t Engine::getDroppedInputCount() const {
+    return this->inputQueue.getDropped();
+}
+
+void Engine::init_subsystems() {
+    this->resourceManager.scheduler = &this->scheduler;
+    if (this->isRendering()) {
+        // Simulation runs never drain the queue (and have no context), so async loads refuse instead of hanging.
+        this->resourceManager.glCommands = &this->glCommands;
+        this->init_opengl();
+    } else {
+        // Simulation only: no GLFW, GL, OpenAL, text or VR, so nothing here touches process-wide state.
+        // The 3D renderer only holds camera matrices, keep it so game code doesn't need to special case.
+        this->renderer3d = std::make_unique<Renderer3D>();
     }
 }
 
 void Engine::init_opengl() {
+#if ENGINE_ENABLE_VR
+    // The VR runtime needs no GL context, bring it up while GLFW creates the window.
+    std::future<void> vrRuntime;
+    if (this->usesVR()) {
+        vrRuntime = std::async(std::launch::async, [this]() {
+            const StartupScope scope(&this->startupTrace, "VR runtime");
+            this->vr.InitRuntime();
+        });
+    }
+#endif
+
     // Initialize OpenGL
+    const auto windowStart = StartupTrace::Clock::now();
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -79,6 +165,15 @@ void Engine::init_opengl() {
     glfwWindowHint(GLFW_SCALE_TO_MONITOR, false);
 #endif
 
+    const bool headless = this->config.mode == EngineMode::Headless;
+    if (headless) {
+        // Renders into the hidden window's default framebuffer, works on Mesa llvmpipe (with Xvfb) or OSMesa.
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        if (this->config.useOSMesa) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        }
+    }
+
     this->app_window = glfwCreateWindow(this->SCREEN_SIZE.WIDTH, this->SCREEN_SIZE.HEIGHT, this->game->name.c_str(), nullptr, nullptr);
     if (this->app_window == nullptr) {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -86,12 +181,26 @@ void Engine::init_opengl() {
         throw std::runtime_error("Failed to create GLFW window");
     }
     glfwMakeContextCurrent(this->app_window);
+    this->glCommands.BindToCurrentThread();
+    // Never block on vsync when benchmarking.
+    this->setVSync(headless ? VSyncMode::Off : VSyncMode::On);
+    this->startupTrace.Record("Window", windowStart, StartupTrace::Clock::now());
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
-    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        throw std::runtime_error("Failed to initialize GLAD");
+    {
+        const StartupScope scope(&this->startupTrace, "glad");
+        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            throw std::runtime_error("Failed to initialize GLAD");
+        }
+    }
+
+    // GPU timers & debug groups, ENGINE_GPU_SCOPE on this thread reports here.
+    {
+        const StartupScope scope(&this->startupTrace, "GpuProfiler");
+        this->gpuProfiler.Init();
+        GpuProfiler::MakeCurrent(&this->gpuProfiler);
     }
 
     // Hack to get the engine to register
@@ -114,14 +223,14 @@ void Engine::init_opengl() {
     // -----------------------------
     glEnable(GL_DEPTH_TEST);
 
-#if ENGINE_ENABLE_TEXT
-    // Initalize TextRenderer after OpenGL has been initializd
-    this->textRenderer = std::make_unique<TextRenderer>();
-    this->textRenderer->Init(this, scaled_size);
-#endif
+    // The TextRenderer is created on first use, see getTextRenderer.
 
 #if ENGINE_ENABLE_VR
-    this->vr.Init();
+    if (this->usesVR()) {
+        vrRuntime.get();
+        const StartupScope scope(&this->startupTrace, "VR graphics");
+        this->vr.InitGraphics();
+    }
 #endif
 
     this->renderer3d = std::make_unique<Renderer3D>();
@@ -132,11 +241,17 @@ void Engine::setClearColour(const Colour& colour) {
 }
 
 void Engine::enableBlending() const {
+    if (!this->isRendering()) {
+        return;
+    }
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 double Engine::getScaleRatio() const {
+    if (this->app_window == nullptr) {
+        return 1.0;
+    }
     ScreenSize scaled_size;
     glfwGetFramebufferSize(this->app_window, &scaled_size.WIDTH, &scaled_size.HEIGHT);
     return scaled_size.WIDTH / this->SCREEN_SIZE.WIDTH;
@@ -164,73 +279,460 @@ ScreenSize Engine::getScaledWindowSize() const {
 }
 
 void Engine::resizeable(bool value) {
+    if (!this->isRendering()) {
+        return;
+    }
     glfwWindowHint(GLFW_RESIZABLE, value);
 }
 
+void Engine::setFixedTimestep(const double tickRate, const unsigned int maxCatchUp) {
+    if (tickRate <= 0.0) {
+        throw std::invalid_argument("Fixed timestep tick rate must be positive");
+    }
+    this->useFixedTimestep = true;
+    this->fixedTimestep = 1.0 / tickRate;
+    this->maxCatchUpSteps = std::max(maxCatchUp, 1u);
+    this->accumulator = 0.0;
+}
+
+void Engine::disableFixedTimestep() {
+    this->useFixedTimestep = false;
+    this->accumulator = 0.0;
+}
+
+bool Engine::isFixedTimestep() const {
+    return this->useFixedTimestep;
+}
+
+double Engine::getFixedTimestep() const {
+    return this->fixedTimestep;
+}
+
+double Engine::getInterpolationAlpha() const {
+    return this->useFixedTimestep ? this->accumulator / this->fixedTimestep : 1.0;
+}
+
+double Engine::stepSimulation(const double& frameTime) {
+    bool inputDispatched = false;
+    auto tick = [this, &inputDispatched](const double& dt) {
+#if ENGINE_DEBUG
+        // In pipelined mode this runs on the update thread, which has no GL context.
+        const bool checkGL = this->isRendering() && !this->isPipelined();
+#endif
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::ProcessInput);
+            // Queued events are only consumed by a frame that actually ticks, so latency is measured to the frame showing them.
+            if (!inputDispatched) {
+                this->dispatchInput();
+                inputDispatched = true;
+            }
+            this->game->ProcessInput(dt);
+#if ENGINE_DEBUG
+            if (checkGL) {
+                glCheckError();
+            }
+#endif
+        }
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::Update);
+            this->game->Update(dt);
+#if ENGINE_DEBUG
+            if (checkGL) {
+                glCheckError();
+            }
+#endif
+        }
+    };
+
+    if (!this->useFixedTimestep) {
+        tick(frameTime);
+        return 1.0;
+    }
+
+    // Clamp the backlog, a long frame (asset load, shader regen) drops time rather than spiralling.
+    this->accumulator = std::min(this->accumulator + frameTime, this->fixedTimestep * this->maxCatchUpSteps);
+    while (this->accumulator >= this->fixedTimestep) {
+        tick(this->fixedTimestep);
+        this->accumulator -= this->fixedTimestep;
+    }
+
+    // How far we are between the last tick and the next one.
+    return this->getInterpolationAlpha();
+}
+
+void Engine::enablePipelining(const std::size_t stateBuffers) {
+    if (stateBuffers < 2 || stateBuffers > 3) {
+        throw std::invalid_argument("Pipelining requires double or triple buffered game state");
+    }
+    if (!this->game || !this->game->PublishesState()) {
+        // Rendering live state while Update changes it on the pipeline thread would race.
+        throw std::logic_error("Pipelining requires a game that implements PublishState/RenderState (Game::PublishesState)");
+    }
+    this->numStateBuffers = stateBuffers;
+}
+
+void Engine::disablePipelining() {
+    this->numStateBuffers = 0;
+}
+
+bool Engine::isPipelined() const {
+    return this->numStateBuffers > 0;
+}
+
+bool Engine::isRendering() const {
+    return this->config.mode != EngineMode::Simulation;
+}
+
+bool Engine::usesVR() const {
+#if ENGINE_ENABLE_VR
+    return this->config.mode == EngineMode::Windowed;
+#else
+    return false;
+#endif
+}
+
+void Engine::requestStop() {
+    this->stopRequested.store(true);
+}
+
+void Engine::setTargetFrameRate(const double fps) {
+    this->pacer.setTargetFps(fps);
+}
+
+double Engine::getTargetFrameRate() const {
+    return this->pacer.getTargetFps();
+}
+
+VSyncMode Engine::setVSync(const VSyncMode mode) {
+    this->vsync = mode;
+    if (this->app_window == nullptr) {
+        return this->vsync;
+    }
+
+    if (mode == VSyncMode::Adaptive && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+#if ENGINE_DEBUG
+        std::cout << "Adaptive vsync not supported, using vsync" << std::endl;
+#endif
+        this->vsync = VSyncMode::On;
+    }
+
+    switch (this->vsync) {
+    case VSyncMode::Off:
+        glfwSwapInterval(0);
+        break;
+    case VSyncMode::On:
+        glfwSwapInterval(1);
+        break;
+    case VSyncMode::Adaptive:
+        // Negative intervals enable swap_control_tear
+        glfwSwapInterval(-1);
+        break;
+    }
+    return this->vsync;
+}
+
+VSyncMode Engine::getVSync() const {
+    return this->vsync;
+}
+
+void Engine::enableIdleMode(const double timeout) {
+    if (timeout <= 0.0) {
+        throw std::invalid_argument("Idle timeout must be positive");
+    }
+    this->idleMode = true;
+    this->idleTimeout = timeout;
+}
+
+void Engine::disableIdleMode() {
+    this->idleMode = false;
+}
+
+bool Engine::isIdleMode() const {
+    return this->idleMode;
+}
+
+ProfileStats Engine::getPacingStats() const {
+    return this->pacer.getDeviationStats();
+}
+
+FramePacer* Engine::getFramePacer() {
+    return &this->pacer;
+}
+
+void Engine::runSimulation() {
+    // Only Game::ProcessInput & Update, measured with the engine's own clock since GLFW is never initialized.
+    auto previousFrame = Profiler::Clock::now();
+    while (!this->stopRequested.load() && (this->config.frameCount == 0 || this->frameNumber < this->config.frameCount)) {
+        ENGINE_TRACE_SCOPE("frame", "Frame");
+        const auto frameStart = Profiler::Clock::now();
+        const double measured = std::chrono::duration<double>(frameStart - previousFrame).count();
+        this->deltaTime = this->config.fixedDeltaTime > 0.0 ? this->config.fixedDeltaTime : measured;
+        previousFrame = frameStart;
+
+#if ENGINE_ENABLE_COROUTINES
+        this->scheduler.ResumeFrameWaiters();
+#endif
+        this->stepSimulation(this->deltaTime);
+        // Nothing is presented, so there is no latency to measure.
+        this->steppedInput.clear();
+        if (this->frameNumber == 0) {
+            this->startupTrace.MarkFirstFrame();
+        }
+
+#if ENGINE_ENABLE_PROFILING
+        this->profiler.AddPhase(FramePhase::Frame, Profiler::Clock::now() - frameStart);
+        this->profiler.EndFrame();
+#endif
+        this->frameNumber += 1;
+        this->frameMemory.NextFrame();
+        FrameMemory::Global().NextFrame();
+    }
+}
+
+void Engine::writeSummaryIfRequested() const {
+    if (this->config.mode == EngineMode::Windowed) {
+        return;
+    }
+    if (this->config.summaryPath.empty()) {
+        this->writeFrameSummary(std::cout);
+    } else {
+        std::ofstream summary(this->config.summaryPath);
+        if (!summary.good()) {
+            std::cerr << "Failed to open frame summary file: " << this->config.summaryPath << std::endl;
+        } else {
+            this->writeFrameSummary(summary);
+        }
+    }
+}
+
+void Engine::writeTraceIfRequested() const {
+    if (this->config.tracePath.empty()) {
+        return;
+    }
+#if ENGINE_ENABLE_TRACING
+    // Other engines may still be tracing, recording only stops once the last of them is done.
+    Tracer::EndSession();
+#endif
+    const auto window = std::chrono::duration_cast<Tracer::Clock::duration>(std::chrono::duration<double>(this->config.traceWindow));
+    if (!Tracer::WriteChromeTrace(this->config.tracePath, window)) {
+        std::cerr << "Failed to open trace file: " << this->config.tracePath << std::endl;
+    }
+}
+
 void Engine::run() {
     this->deltaTime = 0;
-    this->lastFrame = 0;
+    this->accumulator = 0.0;
+    this->frameNumber = 0;
+
+    this->stopRequested.store(false);
+    this->pacer.Reset();
+    this->steppedInput.clear();
+    this->presentedInput.clear();
+    // Follow this engine's frames on the main thread (the audio engine's scratch buffers live there too).
+    this->frameMemory.Local();
+    if (this->isRendering()) {
+        // Rendering runs on the main thread, a no-op unless the scheduler was set up to pin threads.
+        this->scheduler.PinMainThread();
+    }
+    ENGINE_TRACE_THREAD_NAME("Main");
+    if (!this->config.tracePath.empty()) {
+#if ENGINE_ENABLE_TRACING
+        Tracer::BeginSession();
+#else
+        std::cerr << "Engine built without tracing (ENGINE_ENABLE_TRACING), the trace will be empty" << std::endl;
+#endif
+    }
 
+    if (this->config.frameCount > this->profiler.getHistorySize()) {
+        // Keep every frame of a fixed-length run for the summary.
+        this->profiler.SetHistorySize(this->config.frameCount);
+    }
+    const auto runStart = Profiler::Clock::now();
+
+    if (!this->isRendering()) {
+        this->runSimulation();
+        this->runTime = std::chrono::duration<double>(Profiler::Clock::now() - runStart).count();
+        this->resourceManager.Clear();
+        this->writeSummaryIfRequested();
+        this->writeTraceIfRequested();
+        return;
+    }
+
+    this->lastFrame = glfwGetTime();
     auto stopCondition = [this]() {
+        if (this->stopRequested.load()) {
+            return false;
+        }
+        if (this->config.frameCount > 0 && this->frameNumber >= this->config.frameCount) {
+            return false;
+        }
 #if ENGINE_ENABLE_VR
-        return !glfwWindowShouldClose(this->app_window) || this->vr.ShouldShutdown();
+        return !glfwWindowShouldClose(this->app_window) || (this->usesVR() && this->vr.ShouldShutdown());
 #else
         return !glfwWindowShouldClose(this->app_window);
 #endif
     };
 
+    // Pipelined mode: the update for frame N+1 runs on `pipeline` while this thread renders frame N.
+    // Events are only polled while the update thread is idle, so input callbacks never race Update.
+    const bool pipelined = this->isPipelined();
+    double readAlpha = 1.0;
+    double writeAlpha = 1.0;
+    if (pipelined) {
+        this->pipeline.Start([this, &writeAlpha](const double& dt, const std::size_t& buffer) {
+            writeAlpha = this->stepSimulation(dt);
+            this->game->PublishState(buffer);
+        }, this->numStateBuffers);
+        // Prime the first snapshot so there is something to render, the worker is idle until the first Kick.
+        readAlpha = this->stepSimulation(0.0);
+        this->game->PublishState(this->pipeline.getReadBuffer());
+        this->collectSteppedInput();
+    }
+
     // Do the game loop
     while (stopCondition()) {
+        if (this->idleMode && this->config.mode == EngineMode::Windowed && !this->game->NeedsRedraw()) {
+            // Nothing changed, sleep until input arrives (or the timeout, so timers in Update still run).
+            glfwWaitEventsTimeout(this->idleTimeout);
+            this->pacer.Reset();
+        }
+        ENGINE_TRACE_SCOPE("frame", "Frame");
+#if ENGINE_ENABLE_PROFILING
+        const auto frameStart = Profiler::Clock::now();
+#endif
         // calculate delta time
         // --------------------
         const double currentFrame = glfwGetTime();
-        this->deltaTime = currentFrame - lastFrame;
+        this->deltaTime = this->config.fixedDeltaTime > 0.0 ? this->config.fixedDeltaTime : currentFrame - lastFrame;
         this->lastFrame = currentFrame;
-        glfwPollEvents();
-
-        // manage user input
-        // -----------------
-#if ENGINE_ENABLE_VR
-        this->vr.GetInput();
-#endif
-        this->game->ProcessInput(deltaTime);
-#if ENGINE_DEBUG
-        glCheckError();
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::PollEvents);
+            glfwPollEvents();
+        }
+        {
+            // Before the update is kicked off, so the update thread never sees resources change under it.
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::GLCommands);
+            this->glCommands.Drain(this->glCommandBudget);
+        }
+#if ENGINE_ENABLE_COROUTINES
+        this->scheduler.ResumeFrameWaiters();
 #endif
 
-        // update game state
-        // -----------------
-        this->game->Update(deltaTime);
-#if ENGINE_DEBUG
-        glCheckError();
+        // manage user input & update game state
+        // -------------------------------------
+#if ENGINE_ENABLE_VR
+        if (this->usesVR()) {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::VRInput);
+            this->vr.GetInput();
+        }
 #endif
+        if (pipelined) {
+            this->pipeline.Kick(this->deltaTime);
+        } else {
+            readAlpha = this->stepSimulation(this->deltaTime);
+            this->collectSteppedInput();
+        }
 
 #if ENGINE_ENABLE_VR
-        this->vr.RunVibration(this->leftStrength, this->rightStrength);
+        if (this->usesVR()) {
+            this->vr.RunVibration(this->leftStrength, this->rightStrength);
+        }
 #endif
         // render
         // ------
-        glClearColor(clearColour.R, clearColour.G, clearColour.B, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        this->gpuProfiler.BeginFrame();
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::Clear);
+            ENGINE_GPU_SCOPE("Clear");
+            glClearColor(clearColour.R, clearColour.G, clearColour.B, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
-        this->game->Render();
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::Render);
+            ENGINE_GPU_SCOPE("Render");
+            // Once for every mesh shader, and only what changed. Pipelined games only set these from RenderState.
+            this->renderer3d->Upload();
+            this->lightManager.Upload();
+            if (pipelined) {
+                this->game->RenderState(this->pipeline.getReadBuffer(), readAlpha);
+            } else {
+                this->game->RenderInterpolated(readAlpha);
+            }
 #if ENGINE_DEBUG
-        glCheckError();
+            glCheckError();
 #endif
+        }
+        this->gpuProfiler.EndFrame();
+
         // Run Audio Tick
-        this->audioEngine.Update();
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::AudioUpdate);
+            this->audioEngine.Update();
+        }
 
-        glfwSwapBuffers(this->app_window);
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::SwapBuffers);
+            glfwSwapBuffers(this->app_window);
+        }
+        // Swap returning is the closest we get to photons without display feedback.
+        const auto presentTime = Profiler::Clock::now();
+        for (const auto& inputTime : this->presentedInput) {
+            this->inputLatency.Record(presentTime - inputTime);
+        }
+        this->presentedInput.clear();
+        if (this->frameNumber == 0) {
+            this->startupTrace.MarkFirstFrame();
+        }
 
 #if ENGINE_ENABLE_VR
         // Fetch new HMD position
-        this->vr.GetTrackingPose();
+        if (this->usesVR()) {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::VRPose);
+            this->vr.GetTrackingPose();
+        }
 #endif
-}
+
+        if (pipelined) {
+            // The next frame renders what the update thread just published.
+            {
+                ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::UpdateWait);
+                this->pipeline.Wait();
+            }
+            readAlpha = writeAlpha;
+            this->collectSteppedInput();
+        }
+
+        {
+            ENGINE_PROFILE_PHASE(&this->profiler, FramePhase::FrameWait);
+            this->pacer.Wait();
+        }
+
+#if ENGINE_ENABLE_PROFILING
+        this->profiler.AddPhase(FramePhase::Frame, Profiler::Clock::now() - frameStart);
+        this->profiler.EndFrame();
+#endif
+        this->frameNumber += 1;
+        this->frameMemory.NextFrame();
+        FrameMemory::Global().NextFrame();
+    }
+    this->runTime = std::chrono::duration<double>(Profiler::Clock::now() - runStart).count();
+
+    this->pipeline.Stop();
+    this->gpuProfiler.Shutdown();
+    GpuProfiler::MakeCurrent(nullptr);
+
+    this->writeSummaryIfRequested();
+    this->writeTraceIfRequested();
+
+    // Finish uploads still queued so their futures resolve, and Clear frees what they created.
+    this->glCommands.DrainAll();
 
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
     this->resourceManager.Clear();
+    this->lightManager.Shutdown();
+    this->renderer3d->Shutdown();
 
     glfwTerminate();
 }
@@ -247,8 +749,90 @@ LightManager* Engine::getLightManager() {
     return &this->lightManager;
 }
 
+Profiler* Engine::getProfiler() {
+    return &this->profiler;
+}
+
+ProfileStats Engine::getFrameStats(const FramePhase phase) const {
+    return this->profiler.getPhaseStats(phase);
+}
+
+ProfileStats Engine::getZoneStats(const std::string& zone) const {
+    return this->profiler.getZoneStats(zone);
+}
+
+GpuProfiler* Engine::getGpuProfiler() {
+    return &this->gpuProfiler;
+}
+
+void Engine::writeFrameSummary(std::ostream& out) const {
+    auto writeStats = [&out](const std::string& name, const ProfileStats& stats, const bool last) {
+        out << "    \"" << name << "\": { \"samples\": " << stats.samples
+            << ", \"min\": " << stats.min
+            << ", \"avg\": " << stats.avg
+            << ", \"p95\": " << stats.p95
+            << ", \"p99\": " << stats.p99
+            << ", \"max\": " << stats.max << " }" << (last ? "" : ",") << "\n";
+    };
+
+    out << "{\n";
+    out << "  \"game\": \"" << this->game->name << "\",\n";
+    out << "  \"frames\": " << this->frameNumber << ",\n";
+    out << "  \"fixed_dt\": " << this->config.fixedDeltaTime << ",\n";
+    out << "  \"wall_time_s\": " << this->runTime << ",\n";
+    out << "  \"units\": \"ms\",\n";
+    out << "  \"cpu\": {\n";
+    for (std::size_t i = 0; i < Profiler::NumPhases; ++i) {
+        const auto phase = static_cast<FramePhase>(i);
+        writeStats(Profiler::PhaseName(phase), this->profiler.getPhaseStats(phase), i + 1 == Profiler::NumPhases);
+    }
+    out << "  },\n";
+    out << "  \"gpu\": {\n";
+    const auto scopes = this->gpuProfiler.getScopeNames();
+    for (std::size_t i = 0; i < scopes.size(); ++i) {
+        writeStats(scopes.at(i), this->gpuProfiler.getScopeStats(scopes.at(i)), i + 1 == scopes.size());
+    }
+    out << "  },\n";
+    out << "  \"pacing\": {\n";
+    out << "    \"target_fps\": " << this->pacer.getTargetFps() << ",\n";
+    writeStats("frame_time", this->pacer.getFrameTimeStats(), false);
+    writeStats("deviation", this->pacer.getDeviationStats(), true);
+    out << "  },\n";
+    out << "  \"input\": {\n";
+    out << "    \"dropped\": " << this->inputQueue.getDropped() << ",\n";
+    writeStats("latency", this->inputLatency.getStats(), true);
+    out << "  },\n";
+    out << "  \"startup\": {\n";
+    out << "    \"time_to_first_frame\": " << this->startupTrace.getTimeToFirstFrame() << ",\n";
+    out << "    \"subsystems\": [\n";
+    const auto subsystems = this->startupTrace.getEntries();
+    for (std::size_t i = 0; i < subsystems.size(); ++i) {
+        const auto& subsystem = subsystems.at(i);
+        out << "      { \"name\": \"" << subsystem.name << "\""
+            << ", \"start\": " << subsystem.start
+            << ", \"duration\": " << subsystem.duration
+            << ", \"thread\": \"" << (subsystem.mainThread ? "main" : "background") << "\" }"
+            << (i + 1 == subsystems.size() ? "" : ",") << "\n";
+    }
+    out << "    ]\n";
+    out << "  }\n";
+    out << "}" << std::endl;
+}
+
+const StartupTrace& Engine::getStartupTrace() const {
+    return this->startupTrace;
+}
+
+const EngineConfig& Engine::getConfig() const {
+    return this->config;
+}
+
+std::size_t Engine::getFrameNumber() const {
+    return this->frameNumber;
+}
+
 void Engine::enableSpriteRendering(const bool is_enabled) {
-    if (is_enabled) {
+    if (is_enabled && this->isRendering()) {
         this->spriteRenderer = std::make_unique<SpriteRenderer>();
     } else {
         this->spriteRenderer.release();
@@ -271,6 +855,16 @@ AudioEngine* Engine::getAudioEngine() {
 
 // MARK: Text
 TextRenderer* Engine::getTextRenderer() {
+#if ENGINE_ENABLE_TEXT
+    if (!this->textRenderer && this->isRendering()) {
+        // Initalize TextRenderer after OpenGL has been initializd, most games never draw text.
+        const StartupScope scope(&this->startupTrace, "TextRenderer");
+        ScreenSize scaled_size;
+        glfwGetFramebufferSize(this->app_window, &scaled_size.WIDTH, &scaled_size.HEIGHT);
+        this->textRenderer = std::make_unique<TextRenderer>();
+        this->textRenderer->Init(this, scaled_size);
+    }
+#endif
     return this->textRenderer.get();
 }
 
@@ -282,6 +876,35 @@ Scheduler* Engine::getScheduler() {
     return &this->scheduler;
 }
 
+FrameArena* Engine::getFrameArena() {
+    return &this->frameMemory.Local();
+}
+
+GLCommandQueue* Engine::getGLCommandQueue() {
+    return &this->glCommands;
+}
+
+void Engine::setGLCommandBudget(const double seconds) {
+    if (!std::isfinite(seconds) || seconds < 0.0) {
+        throw std::invalid_argument("GL command budget must be a finite, non-negative number of seconds");
+    }
+    this->glCommandBudget = std::chrono::duration_cast<GLCommandQueue::Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+double Engine::getGLCommandBudget() const {
+    return std::chrono::duration<double>(this->glCommandBudget).count();
+}
+
+#if ENGINE_ENABLE_COROUTINES
+ResumeOn Engine::mainThread() {
+    if (!this->isRendering()) {
+        // Nothing drains the GL command queue, the coroutine would never resume.
+        throw std::logic_error("Engine::mainThread needs a rendering Engine, there is no main (GL) thread in EngineMode::Simulation");
+    }
+    return ResumeOn(this->glCommands);
+}
+#endif
+
 void Engine::Update_VR_vibration([[maybe_unused]] const unsigned short newLeftStrength, [[maybe_unused]] const unsigned short newRightStrength) {
 #if ENGINE_ENABLE_VR
     this->leftStrength = newLeftStrength;
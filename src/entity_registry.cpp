@@ -0,0 +1,87 @@
+#include "engine/entity_registry.hpp"
+
+#include <atomic>
+
+std::size_t ComponentType::next() {
+	static std::atomic<std::size_t> counter{0};
+	return counter.fetch_add(1);
+}
+
+std::uint32_t ComponentPoolBase::indexOf(const Entity entity) const {
+	const auto slot = entity.getIndex();
+	if (entity.isNull() || slot >= this->sparse.size()) {
+		return npos;
+	}
+	const auto index = this->sparse[slot];
+	// The slot may have been reused by a newer entity.
+	if (index == npos || this->entities[index] != entity) {
+		return npos;
+	}
+	return index;
+}
+
+std::uint32_t ComponentPoolBase::insert(const Entity entity) {
+	const auto slot = entity.getIndex();
+	if (slot >= this->sparse.size()) {
+		this->sparse.resize(slot + 1, npos);
+	}
+	const auto index = static_cast<std::uint32_t>(this->entities.size());
+	this->sparse[slot] = index;
+	this->entities.push_back(entity);
+	this->version += 1;
+	return index;
+}
+
+std::uint32_t ComponentPoolBase::erase(const Entity entity) {
+	const auto index = this->indexOf(entity);
+	if (index == npos) {
+		return npos;
+	}
+	const Entity last = this->entities.back();
+	this->entities[index] = last;
+	this->sparse[last.getIndex()] = index;
+	this->entities.pop_back();
+	this->sparse[entity.getIndex()] = npos;
+	this->version += 1;
+	return index;
+}
+
+Entity EntityRegistry::Create() {
+	std::uint32_t slot = 0;
+	if (!this->freeSlots.empty()) {
+		slot = this->freeSlots.back();
+		this->freeSlots.pop_back();
+	} else {
+		if (this->generations.size() >= Entity::MaxIndex) {
+			throw std::length_error("Too many entities");
+		}
+		slot = static_cast<std::uint32_t>(this->generations.size());
+		this->generations.push_back(0);
+	}
+	this->alive += 1;
+	return Entity(slot, this->generations[slot]);
+}
+
+void EntityRegistry::Destroy(const Entity entity) {
+	if (!this->isAlive(entity)) {
+		return;
+	}
+	for (auto& pool : this->pools) {
+		if (pool) {
+			pool->Remove(entity);
+		}
+	}
+	const auto slot = entity.getIndex();
+	this->generations[slot] = (this->generations[slot] + 1) & Entity::GenerationMask;
+	this->freeSlots.push_back(slot);
+	this->alive -= 1;
+}
+
+bool EntityRegistry::isAlive(const Entity entity) const {
+	const auto slot = entity.getIndex();
+	return !entity.isNull() && slot < this->generations.size() && this->generations[slot] == entity.getGeneration();
+}
+
+std::size_t EntityRegistry::size() const {
+	return this->alive;
+}
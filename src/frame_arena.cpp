@@ -0,0 +1,130 @@
+#include "engine/frame_arena.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	struct LocalArena {
+		FrameArena arena;
+		// The FrameMemory this thread follows, nullptr until its first Local() call.
+		std::shared_ptr<const std::atomic<std::uint64_t>> frame;
+		std::uint64_t seenFrame = 0;
+	};
+
+	LocalArena& localArena() {
+		thread_local LocalArena local;
+		return local;
+	}
+
+	void catchUp(LocalArena& local) {
+		if (!local.frame) {
+			return;
+		}
+		const std::uint64_t frame = local.frame->load(std::memory_order_acquire);
+		if (frame != local.seenFrame) {
+			local.arena.Reset();
+			local.seenFrame = frame;
+		}
+	}
+}
+
+FrameArena::FrameArena(const std::size_t _blockSize) : blockSize(std::max<std::size_t>(_blockSize, 1)) {}
+
+void FrameArena::addBlock(const std::size_t minSize) {
+	Block block;
+	block.size = std::max(this->blockSize, minSize);
+	block.memory = std::make_unique<unsigned char[]>(block.size);
+	this->blocks.push_back(std::move(block));
+	this->current = this->blocks.size() - 1;
+	this->offset = 0;
+}
+
+void* FrameArena::Allocate(const std::size_t size, const std::size_t alignment) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		throw std::invalid_argument("FrameArena alignment must be a power of two");
+	}
+	// Zero sized requests still get a distinct address.
+	const std::size_t bytes = std::max<std::size_t>(size, 1);
+
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!this->blocks.empty()) {
+			Block& block = this->blocks[this->current];
+			const auto base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+			const std::uintptr_t aligned = (base + this->offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+			const std::size_t start = aligned - base;
+			if (start <= block.size && bytes <= block.size - start) {
+				this->offset = start + bytes;
+				this->used += bytes;
+				return block.memory.get() + start;
+			}
+		}
+		if (bytes > static_cast<std::size_t>(-1) - alignment) {
+			throw std::bad_alloc();
+		}
+		this->addBlock(bytes + alignment);
+	}
+	// A fresh block always fits
+	throw std::bad_alloc();
+}
+
+void FrameArena::Reset() {
+	if (this->blocks.size() > 1) {
+		std::size_t total = 0;
+		for (const auto& block : this->blocks) {
+			total += block.size;
+		}
+		this->blocks.clear();
+		this->addBlock(total);
+	}
+	this->current = 0;
+	this->offset = 0;
+	this->used = 0;
+}
+
+std::size_t FrameArena::getUsed() const {
+	return this->used;
+}
+
+std::size_t FrameArena::getCapacity() const {
+	std::size_t total = 0;
+	for (const auto& block : this->blocks) {
+		total += block.size;
+	}
+	return total;
+}
+
+FrameArena& FrameArena::Local() {
+	LocalArena& local = localArena();
+	if (!local.frame) {
+		return FrameMemory::Global().Local();
+	}
+	catchUp(local);
+	return local.arena;
+}
+
+FrameMemory::FrameMemory() : frame(std::make_shared<std::atomic<std::uint64_t>>(0)) {}
+
+FrameArena& FrameMemory::Local() {
+	LocalArena& local = localArena();
+	if (local.frame != this->frame) {
+		// Whatever the thread allocated for its previous owner stays valid until this frame ends.
+		local.frame = this->frame;
+		local.seenFrame = this->frame->load(std::memory_order_acquire);
+	} else {
+		catchUp(local);
+	}
+	return local.arena;
+}
+
+void FrameMemory::NextFrame() {
+	this->frame->fetch_add(1, std::memory_order_acq_rel);
+}
+
+std::uint64_t FrameMemory::getFrame() const {
+	return this->frame->load(std::memory_order_acquire);
+}
+
+FrameMemory& FrameMemory::Global() {
+	static FrameMemory global;
+	return global;
+}
@@ -0,0 +1,108 @@
+#include "engine/frame_pacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+FramePacer::FramePacer(const std::size_t historySize) : frameTimes(historySize, 0) {
+	if (historySize == 0) {
+		throw std::invalid_argument("FramePacer history must hold at least one frame");
+	}
+}
+
+void FramePacer::setTargetFps(const double fps) {
+	if (fps < 0.0 || !std::isfinite(fps)) {
+		throw std::invalid_argument("Target frame rate must be positive (or 0 to disable)");
+	}
+	this->targetFps = fps;
+	this->period = fps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) : Clock::duration::zero();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->nextSample = 0;
+	this->numSamples = 0;
+	this->hasCadence = false;
+}
+
+double FramePacer::getTargetFps() const {
+	return this->targetFps;
+}
+
+bool FramePacer::isEnabled() const {
+	return this->targetFps > 0.0;
+}
+
+void FramePacer::setSpinThreshold(const Clock::duration& threshold) {
+	this->spinThreshold = threshold;
+}
+
+FramePacer::Clock::duration FramePacer::getSpinThreshold() const {
+	return this->spinThreshold;
+}
+
+void FramePacer::Reset() {
+	this->hasCadence = false;
+}
+
+void FramePacer::Wait() {
+	if (!this->isEnabled()) {
+		return;
+	}
+
+	if (!this->hasCadence) {
+		// First frame (or after a stall), start a fresh cadence from now.
+		this->lastFrameEnd = Clock::now();
+		this->deadline = this->lastFrameEnd + this->period;
+		this->hasCadence = true;
+		return;
+	}
+
+	const auto now = Clock::now();
+	if (this->deadline - now > this->spinThreshold) {
+		std::this_thread::sleep_for(this->deadline - now - this->spinThreshold);
+	}
+	while (Clock::now() < this->deadline) {
+		std::this_thread::yield();
+	}
+
+	const auto frameEnd = Clock::now();
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->frameTimes.at(this->nextSample) = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(frameEnd - this->lastFrameEnd).count());
+		this->nextSample = (this->nextSample + 1) % this->frameTimes.size();
+		this->numSamples = std::min(this->numSamples + 1, this->frameTimes.size());
+	}
+	this->lastFrameEnd = frameEnd;
+
+	// Keep a steady cadence, but don't try to catch up (burst frames) after missing a deadline.
+	this->deadline += this->period;
+	if (this->deadline < frameEnd) {
+		this->deadline = frameEnd + this->period;
+	}
+}
+
+std::vector<std::uint64_t> FramePacer::collect(const bool deviation) const {
+	const std::int64_t target = std::chrono::duration_cast<std::chrono::nanoseconds>(this->period).count();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<std::uint64_t> samples;
+	samples.reserve(this->numSamples);
+	for (std::size_t i = 0; i < this->numSamples; ++i) {
+		const auto frameTime = this->frameTimes.at(i);
+		if (deviation) {
+			samples.push_back(static_cast<std::uint64_t>(std::abs(static_cast<std::int64_t>(frameTime) - target)));
+		} else {
+			samples.push_back(frameTime);
+		}
+	}
+	return samples;
+}
+
+ProfileStats FramePacer::getDeviationStats() const {
+	return Profiler::Summarize(this->collect(true));
+}
+
+ProfileStats FramePacer::getFrameTimeStats() const {
+	return Profiler::Summarize(this->collect(false));
+}
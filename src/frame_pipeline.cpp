@@ -0,0 +1,99 @@
+#include "engine/frame_pipeline.hpp"
+#include "engine/trace.hpp"
+
+#include <stdexcept>
+
+FramePipeline::~FramePipeline() {
+	this->Stop();
+}
+
+void FramePipeline::Start(const Job& _job, const std::size_t buffers) {
+	if (buffers < 2 || buffers > 3) {
+		throw std::invalid_argument("FramePipeline requires double or triple buffered state");
+	}
+	this->Stop();
+	this->job = _job;
+	this->stopping = false;
+	this->numBuffers = buffers;
+	this->readBuffer = 0;
+	this->writeBuffer = 0;
+	this->worker = std::thread(&FramePipeline::workerLoop, this);
+}
+
+void FramePipeline::Stop() {
+	if (!this->worker.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->cv.notify_all();
+	this->worker.join();
+}
+
+bool FramePipeline::IsRunning() const {
+	return this->worker.joinable();
+}
+
+void FramePipeline::Kick(const double& dt) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->pendingDt = dt;
+		this->writeBuffer = (this->readBuffer + 1) % this->numBuffers;
+		this->pending = true;
+		this->busy = true;
+	}
+	this->cv.notify_all();
+}
+
+void FramePipeline::Wait() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->cv.wait(lock, [this]() { return !this->busy; });
+	if (this->error) {
+		auto thrown = this->error;
+		this->error = nullptr;
+		this->writeBuffer = this->readBuffer;
+		std::rethrow_exception(thrown);
+	}
+	this->readBuffer = this->writeBuffer;
+}
+
+std::size_t FramePipeline::getReadBuffer() const {
+	// Only changed by Start/Wait, which run on the render thread too.
+	return this->readBuffer;
+}
+
+void FramePipeline::workerLoop() {
+	ENGINE_TRACE_THREAD_NAME("Update");
+	while (true) {
+		double dt = 0.0;
+		std::size_t buffer = 0;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->cv.wait(lock, [this]() { return this->pending || this->stopping; });
+			if (this->stopping) {
+				this->busy = false;
+				this->cv.notify_all();
+				return;
+			}
+			this->pending = false;
+			dt = this->pendingDt;
+			buffer = this->writeBuffer;
+		}
+
+		std::exception_ptr thrown = nullptr;
+		try {
+			this->job(dt, buffer);
+		} catch (...) {
+			thrown = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->error = thrown;
+			this->busy = false;
+		}
+		this->cv.notify_all();
+	}
+}
@@ -22,3 +22,20 @@ void Game::pressed([[maybe_unused]] const int key) noexcept {}
 void Game::released([[maybe_unused]] const int key) noexcept {}
 
 void Game::Render() const noexcept {}
+
+
+void Game::RenderInterpolated([[maybe_unused]] const double& alpha) const noexcept {
+	this->Render();
+}
+
+bool Game::PublishesState() const noexcept {
+	return false;
+}
+
+void Game::PublishState([[maybe_unused]] const std::size_t& buffer) noexcept {}
+
+void Game::RenderState([[maybe_unused]] const std::size_t& buffer, [[maybe_unused]] const double& alpha) const noexcept {}
+
+bool Game::NeedsRedraw() const noexcept {
+	return true;
+}
@@ -1,3 +1,77 @@
 #include "engine/game_object.hpp"
+#include "engine/entity_registry.hpp"
 
-void GameObject::Draw([[maybe_unused]] Renderer* renderer) const {}
\ No newline at end of file
+#include <stdexcept>
+
+void GameObject::Draw([[maybe_unused]] Renderer* renderer) const {}
+
+#if !ENGINE_MIN_GAME_OBJECT
+GameObject::GameObject(EntityRegistry& _registry) : state(), registry(&_registry), entity(_registry.Create()) {
+	this->registry->Add<Position2D>(this->entity);
+	this->registry->Add<Size2D>(this->entity);
+	this->registry->Add<Velocity2D>(this->entity);
+	this->registry->Add<Colour>(this->entity);
+}
+
+GameObject::GameObject(EntityRegistry& _registry, const Entity _entity) : state(), registry(&_registry), entity(_entity) {
+	if (!this->registry->isAlive(this->entity)) {
+		throw std::invalid_argument("GameObject can't attach to a destroyed entity");
+	}
+	if (!this->registry->Has<Position2D>(this->entity)) {
+		this->registry->Add<Position2D>(this->entity);
+	}
+	if (!this->registry->Has<Size2D>(this->entity)) {
+		this->registry->Add<Size2D>(this->entity);
+	}
+	if (!this->registry->Has<Velocity2D>(this->entity)) {
+		this->registry->Add<Velocity2D>(this->entity);
+	}
+	if (!this->registry->Has<Colour>(this->entity)) {
+		this->registry->Add<Colour>(this->entity);
+	}
+}
+
+Entity GameObject::Attach(EntityRegistry& _registry) {
+	if (this->registry) {
+		throw std::logic_error("GameObject is already attached to an entity");
+	}
+	this->registry = &_registry;
+	this->entity = _registry.Create();
+	this->registry->Add<Position2D>(this->entity, this->state.position);
+	this->registry->Add<Size2D>(this->entity, this->state.size);
+	this->registry->Add<Velocity2D>(this->entity, this->state.velocity);
+	this->registry->Add<Colour>(this->entity, this->state.colour);
+	return this->entity;
+}
+
+void GameObject::Detach() {
+	if (!this->registry) {
+		return;
+	}
+	this->state = State{ this->position(), this->size(), this->velocity(), this->colour() };
+	this->registry = nullptr;
+	this->entity = Entity();
+}
+
+bool GameObject::isAttached() const {
+	return this->registry != nullptr;
+}
+
+Entity GameObject::getEntity() const {
+	return this->entity;
+}
+
+EntityRegistry* GameObject::getRegistry() const {
+	return this->registry;
+}
+
+template<typename T>
+T& GameObject::attached() const {
+	return this->registry->Get<T>(this->entity);
+}
+
+template Position2D& GameObject::attached<Position2D>() const;
+template Size2D& GameObject::attached<Size2D>() const;
+template Velocity2D& GameObject::attached<Velocity2D>() const;
+template Colour& GameObject::attached<Colour>() const;
+#endif
@@ -0,0 +1,92 @@
+#include "engine/gl_command_queue.hpp"
+
+GLCommandQueue::GLCommandQueue() {
+	struct StubCommand final : Command {
+		void Run() override {}
+	};
+	this->stub = std::make_unique<StubCommand>();
+	this->head.store(this->stub.get(), std::memory_order_relaxed);
+	this->tail = this->stub.get();
+}
+
+GLCommandQueue::~GLCommandQueue() {
+	// Dropping the commands breaks their promises.
+	while (Command* command = this->pop()) {
+		delete command;
+	}
+}
+
+void GLCommandQueue::BindToCurrentThread() {
+	this->owner.store(std::this_thread::get_id());
+}
+
+bool GLCommandQueue::isOwnerThread() const {
+	return this->owner.load() == std::this_thread::get_id();
+}
+
+void GLCommandQueue::push(Command* command) {
+	command->next.store(nullptr, std::memory_order_relaxed);
+	this->pending.fetch_add(1, std::memory_order_relaxed);
+	Command* previous = this->head.exchange(command, std::memory_order_acq_rel);
+	// Between the exchange and this store the list is briefly disconnected, pop() treats that as empty.
+	previous->next.store(command, std::memory_order_release);
+}
+
+GLCommandQueue::Command* GLCommandQueue::pop() {
+	Command* first = this->tail;
+	Command* next = first->next.load(std::memory_order_acquire);
+	if (first == this->stub.get()) {
+		if (next == nullptr) {
+			return nullptr;
+		}
+		this->tail = next;
+		first = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+	if (next != nullptr) {
+		this->tail = next;
+		this->pending.fetch_sub(1, std::memory_order_relaxed);
+		return first;
+	}
+	if (first != this->head.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+	// `first` is the last command, put the stub back behind it so it can be detached.
+	this->push(this->stub.get());
+	this->pending.fetch_sub(1, std::memory_order_relaxed);
+	next = first->next.load(std::memory_order_acquire);
+	if (next != nullptr) {
+		this->tail = next;
+		this->pending.fetch_sub(1, std::memory_order_relaxed);
+		return first;
+	}
+	return nullptr;
+}
+
+std::size_t GLCommandQueue::Drain(const Clock::duration budget) {
+	const auto deadline = Clock::now() + budget;
+	std::size_t ran = 0;
+	while (Command* command = this->pop()) {
+		std::unique_ptr<Command> owned(command);
+		owned->Run();
+		++ran;
+		if (Clock::now() >= deadline) {
+			break;
+		}
+	}
+	return ran;
+}
+
+std::size_t GLCommandQueue::DrainAll() {
+	std::size_t ran = 0;
+	while (Command* command = this->pop()) {
+		std::unique_ptr<Command> owned(command);
+		owned->Run();
+		++ran;
+	}
+	return ran;
+}
+
+std::size_t GLCommandQueue::size() const {
+	return this->pending.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,204 @@
+#include "engine/gpu_profiler.hpp"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+	thread_local GpuProfiler* currentGpuProfiler = nullptr;
+}
+
+GpuProfiler* GpuProfiler::Current() {
+	return currentGpuProfiler;
+}
+
+void GpuProfiler::MakeCurrent(GpuProfiler* profiler) {
+	currentGpuProfiler = profiler;
+}
+
+void GpuProfiler::Init() {
+	// Timer queries are core in 3.3, debug groups need KHR_debug (4.3 or the extension, available on Mesa llvmpipe).
+	GLint major = 0;
+	GLint minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	this->timerQueries = major > 3 || (major == 3 && minor >= 3) || glfwExtensionSupported("GL_ARB_timer_query");
+	this->debugGroups = GLAD_GL_KHR_debug != 0;
+
+	if (this->timerQueries) {
+		// GL_QUERY_COUNTER_BITS of 0 means the implementation doesn't actually record timestamps.
+		GLint bits = 0;
+		glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+		this->timerQueries = bits > 0;
+	}
+#if ENGINE_DEBUG
+	std::cout << "GPU profiler: timer queries " << (this->timerQueries ? "on" : "off") << ", debug groups " << (this->debugGroups ? "on" : "off") << std::endl;
+#endif
+	this->initialized = true;
+}
+
+void GpuProfiler::Shutdown() {
+	for (auto& frame : this->frames) {
+		if (!frame.queries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+		}
+		frame.queries.clear();
+		frame.scopes.clear();
+		frame.usedQueries = 0;
+	}
+	this->openScopes.clear();
+	this->initialized = false;
+}
+
+void GpuProfiler::setEnabled(const bool _enabled) {
+	this->enabled = _enabled;
+}
+
+bool GpuProfiler::isEnabled() const {
+	return this->enabled;
+}
+
+bool GpuProfiler::hasTimerQueries() const {
+	return this->timerQueries;
+}
+
+bool GpuProfiler::hasDebugGroups() const {
+	return this->debugGroups;
+}
+
+void GpuProfiler::BeginFrame() {
+	// Enabling/disabling only takes effect between frames, so push/pop always stay balanced.
+	this->inFrame = this->enabled && this->initialized;
+	if (!this->inFrame) {
+		return;
+	}
+	this->frameIndex += 1;
+	// This slot was last used `framesInFlight` frames ago, its queries should be long done.
+	this->resolve(this->frames[this->frameIndex % framesInFlight]);
+}
+
+void GpuProfiler::EndFrame() {
+	while (!this->openScopes.empty()) {
+		this->PopScope();
+	}
+	this->inFrame = false;
+}
+
+void GpuProfiler::PushScope(const std::string_view& name) {
+	if (!this->inFrame) {
+		return;
+	}
+
+	if (this->debugGroups) {
+		glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
+	}
+
+	if (this->timerQueries) {
+		auto& frame = this->frames[this->frameIndex % framesInFlight];
+		Scope scope;
+		scope.name = this->internName(name);
+		scope.beginQuery = this->nextQuery(frame);
+		scope.endQuery = scope.beginQuery;
+		glQueryCounter(frame.queries[scope.beginQuery], GL_TIMESTAMP);
+		this->openScopes.push_back(frame.scopes.size());
+		frame.scopes.push_back(scope);
+	} else {
+		// Keep push/pop balanced for debug groups.
+		this->openScopes.push_back(0);
+	}
+}
+
+void GpuProfiler::PopScope() {
+	if (this->openScopes.empty()) {
+		return;
+	}
+	const auto scopeIndex = this->openScopes.back();
+	this->openScopes.pop_back();
+
+	if (this->timerQueries) {
+		auto& frame = this->frames[this->frameIndex % framesInFlight];
+		auto& scope = frame.scopes.at(scopeIndex);
+		scope.endQuery = this->nextQuery(frame);
+		glQueryCounter(frame.queries[scope.endQuery], GL_TIMESTAMP);
+	}
+
+	if (this->debugGroups) {
+		glPopDebugGroup();
+	}
+}
+
+std::size_t GpuProfiler::internName(const std::string_view& name) {
+	const auto found = this->nameIds.find(name);
+	if (found != this->nameIds.end()) {
+		return found->second;
+	}
+	const auto id = this->names.size();
+	this->names.emplace_back(name);
+	this->nameIds.emplace(this->names.back(), id);
+	this->history.emplace_back();
+	return id;
+}
+
+std::size_t GpuProfiler::nextQuery(Frame& frame) {
+	if (frame.usedQueries == frame.queries.size()) {
+		// Grow the pool, it settles after the first few frames.
+		const std::size_t grow = std::max<std::size_t>(frame.queries.size(), 32);
+		frame.queries.resize(frame.queries.size() + grow);
+		glGenQueries(static_cast<GLsizei>(grow), &frame.queries[frame.usedQueries]);
+	}
+	return frame.usedQueries++;
+}
+
+void GpuProfiler::resolve(Frame& frame) {
+	if (!frame.scopes.empty()) {
+		// Queries complete in order, if the last one isn't ready drop the frame rather than stall.
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			for (const auto& scope : frame.scopes) {
+				if (scope.endQuery == scope.beginQuery) {
+					continue;
+				}
+				GLuint64 begin = 0;
+				GLuint64 end = 0;
+				glGetQueryObjectui64v(frame.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+				glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+
+				auto& samples = this->history[scope.name];
+				samples.push_back(end > begin ? end - begin : 0);
+				if (samples.size() > defaultHistorySize) {
+					samples.pop_front();
+				}
+			}
+		}
+	}
+	frame.scopes.clear();
+	frame.usedQueries = 0;
+}
+
+ProfileStats GpuProfiler::getScopeStats(const std::string_view& name) const {
+	const auto found = this->nameIds.find(name);
+	if (found == this->nameIds.end()) {
+		return {};
+	}
+	const auto& samples = this->history[found->second];
+	return Profiler::Summarize({ samples.begin(), samples.end() });
+}
+
+std::vector<std::string> GpuProfiler::getScopeNames() const {
+	return this->names;
+}
+
+GpuScope::GpuScope(GpuProfiler* _profiler, const std::string_view& name) : profiler(_profiler) {
+	if (this->profiler) {
+		this->profiler->PushScope(name);
+	}
+}
+
+GpuScope::~GpuScope() {
+	if (this->profiler) {
+		this->profiler->PopScope();
+	}
+}
@@ -0,0 +1,51 @@
+#include "engine/input_queue.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+bool InputQueue::Push(const InputEvent& event) noexcept {
+	const auto currentTail = this->tail.load(std::memory_order_relaxed);
+	if (currentTail - this->head.load(std::memory_order_acquire) == Capacity) {
+		this->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	this->events[currentTail & (Capacity - 1)] = event;
+	this->tail.store(currentTail + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::Pop(InputEvent& event) noexcept {
+	const auto currentHead = this->head.load(std::memory_order_relaxed);
+	if (currentHead == this->tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+	event = this->events[currentHead & (Capacity - 1)];
+	this->head.store(currentHead + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::empty() const noexcept {
+	return this->head.load(std::memory_order_acquire) == this->tail.load(std::memory_order_acquire);
+}
+
+std::uint64_t InputQueue::getDropped() const noexcept {
+	return this->dropped.load(std::memory_order_relaxed);
+}
+
+InputLatencyProbe::InputLatencyProbe(const std::size_t historySize) : latencies(historySize, 0) {
+	if (historySize == 0) {
+		throw std::invalid_argument("InputLatencyProbe history must hold at least one event");
+	}
+}
+
+void InputLatencyProbe::Record(const Profiler::Clock::duration& latency) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->latencies.at(this->nextSample) = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+	this->nextSample = (this->nextSample + 1) % this->latencies.size();
+	this->numSamples = std::min(this->numSamples + 1, this->latencies.size());
+}
+
+ProfileStats InputLatencyProbe::getStats() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return Profiler::Summarize(std::vector<std::uint64_t>(this->latencies.begin(), this->latencies.begin() + static_cast<std::ptrdiff_t>(this->numSamples)));
+}
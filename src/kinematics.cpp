@@ -0,0 +1,257 @@
+#include "engine/kinematics.hpp"
+#include "engine/scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ENGINE_KINEMATICS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC allows any intrinsic without a per-function target.
+#define ENGINE_TARGET_SSE2
+#define ENGINE_TARGET_AVX2
+#else
+#define ENGINE_TARGET_SSE2 __attribute__((target("sse2")))
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define ENGINE_KINEMATICS_X86 0
+#endif
+
+namespace {
+	// Parameters resolved once per call
+	struct Step {
+		float dt;
+		float factor;
+		bool clamp;
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+		float restitution;
+	};
+
+	void clampAxis(float& position, float& velocity, const float min, const float max, const float restitution) {
+		if (position < min) {
+			position = min;
+			velocity = std::abs(velocity) * restitution;
+		} else if (position > max) {
+			position = max;
+			velocity = -std::abs(velocity) * restitution;
+		}
+	}
+
+	void integrateScalar(float* x, float* y, float* vx, float* vy, const std::size_t begin, const std::size_t end, const Step& step) {
+		for (std::size_t i = begin; i < end; ++i) {
+			float velocityX = vx[i] * step.factor;
+			float velocityY = vy[i] * step.factor;
+			float positionX = x[i] + velocityX * step.dt;
+			float positionY = y[i] + velocityY * step.dt;
+			if (step.clamp) {
+				clampAxis(positionX, velocityX, step.minX, step.maxX, step.restitution);
+				clampAxis(positionY, velocityY, step.minY, step.maxY, step.restitution);
+			}
+			x[i] = positionX;
+			y[i] = positionY;
+			vx[i] = velocityX;
+			vy[i] = velocityY;
+		}
+	}
+
+#if ENGINE_KINEMATICS_X86
+	// SSE2 has no blend, select with and/andnot/or.
+	ENGINE_TARGET_SSE2 void clampAxisSSE2(__m128& position, __m128& velocity, const __m128 min, const __m128 max, const __m128 restitution) {
+		const __m128 sign = _mm_set1_ps(-0.0f);
+		const __m128 below = _mm_cmplt_ps(position, min);
+		const __m128 above = _mm_cmpgt_ps(position, max);
+		position = _mm_min_ps(_mm_max_ps(position, min), max);
+		const __m128 bounced = _mm_mul_ps(_mm_andnot_ps(sign, velocity), restitution);
+		velocity = _mm_or_ps(_mm_and_ps(below, bounced), _mm_andnot_ps(below, velocity));
+		velocity = _mm_or_ps(_mm_and_ps(above, _mm_xor_ps(bounced, sign)), _mm_andnot_ps(above, velocity));
+	}
+
+	// Returns how many bodies it did, the caller finishes the tail.
+	ENGINE_TARGET_SSE2 std::size_t integrateSSE2(float* x, float* y, float* vx, float* vy, const std::size_t count, const Step& step) {
+		const __m128 dt = _mm_set1_ps(step.dt);
+		const __m128 factor = _mm_set1_ps(step.factor);
+		const __m128 minX = _mm_set1_ps(step.minX);
+		const __m128 minY = _mm_set1_ps(step.minY);
+		const __m128 maxX = _mm_set1_ps(step.maxX);
+		const __m128 maxY = _mm_set1_ps(step.maxY);
+		const __m128 restitution = _mm_set1_ps(step.restitution);
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 velocityX = _mm_mul_ps(_mm_loadu_ps(vx + i), factor);
+			__m128 velocityY = _mm_mul_ps(_mm_loadu_ps(vy + i), factor);
+			__m128 positionX = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velocityX, dt));
+			__m128 positionY = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(velocityY, dt));
+			if (step.clamp) {
+				clampAxisSSE2(positionX, velocityX, minX, maxX, restitution);
+				clampAxisSSE2(positionY, velocityY, minY, maxY, restitution);
+			}
+			_mm_storeu_ps(x + i, positionX);
+			_mm_storeu_ps(y + i, positionY);
+			_mm_storeu_ps(vx + i, velocityX);
+			_mm_storeu_ps(vy + i, velocityY);
+		}
+		return i;
+	}
+
+	ENGINE_TARGET_AVX2 void clampAxisAVX2(__m256& position, __m256& velocity, const __m256 min, const __m256 max, const __m256 restitution) {
+		const __m256 sign = _mm256_set1_ps(-0.0f);
+		const __m256 below = _mm256_cmp_ps(position, min, _CMP_LT_OQ);
+		const __m256 above = _mm256_cmp_ps(position, max, _CMP_GT_OQ);
+		position = _mm256_min_ps(_mm256_max_ps(position, min), max);
+		const __m256 bounced = _mm256_mul_ps(_mm256_andnot_ps(sign, velocity), restitution);
+		velocity = _mm256_blendv_ps(velocity, bounced, below);
+		velocity = _mm256_blendv_ps(velocity, _mm256_xor_ps(bounced, sign), above);
+	}
+
+	ENGINE_TARGET_AVX2 std::size_t integrateAVX2(float* x, float* y, float* vx, float* vy, const std::size_t count, const Step& step) {
+		const __m256 dt = _mm256_set1_ps(step.dt);
+		const __m256 factor = _mm256_set1_ps(step.factor);
+		const __m256 minX = _mm256_set1_ps(step.minX);
+		const __m256 minY = _mm256_set1_ps(step.minY);
+		const __m256 maxX = _mm256_set1_ps(step.maxX);
+		const __m256 maxY = _mm256_set1_ps(step.maxY);
+		const __m256 restitution = _mm256_set1_ps(step.restitution);
+		std::size_t i = 0;
+		// No FMA, so every level rounds exactly like the scalar loop.
+		for (; i + 8 <= count; i += 8) {
+			__m256 velocityX = _mm256_mul_ps(_mm256_loadu_ps(vx + i), factor);
+			__m256 velocityY = _mm256_mul_ps(_mm256_loadu_ps(vy + i), factor);
+			__m256 positionX = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(velocityX, dt));
+			__m256 positionY = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(velocityY, dt));
+			if (step.clamp) {
+				clampAxisAVX2(positionX, velocityX, minX, maxX, restitution);
+				clampAxisAVX2(positionY, velocityY, minY, maxY, restitution);
+			}
+			_mm256_storeu_ps(x + i, positionX);
+			_mm256_storeu_ps(y + i, positionY);
+			_mm256_storeu_ps(vx + i, velocityX);
+			_mm256_storeu_ps(vy + i, velocityY);
+		}
+		return i;
+	}
+
+	SimdLevel detectSimdLevel() {
+#if defined(_MSC_VER)
+		int info[4] = { 0, 0, 0, 0 };
+		__cpuid(info, 1);
+		// AVX also needs the OS to save the YMM registers (OSXSAVE + XCR0).
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = osxsave && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(info, 7, 0);
+		if (avx && (info[1] & (1 << 5)) != 0) {
+			return SimdLevel::AVX2;
+		}
+		return SimdLevel::SSE2;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			return SimdLevel::AVX2;
+		}
+		if (__builtin_cpu_supports("sse2")) {
+			return SimdLevel::SSE2;
+		}
+		return SimdLevel::Scalar;
+#endif
+	}
+#else
+	SimdLevel detectSimdLevel() {
+		return SimdLevel::Scalar;
+	}
+#endif
+}
+
+std::size_t KinematicBodies::Add(const glm::vec2& position, const glm::vec2& velocity) {
+	this->x.push_back(position.x);
+	this->y.push_back(position.y);
+	this->vx.push_back(velocity.x);
+	this->vy.push_back(velocity.y);
+	return this->x.size() - 1;
+}
+
+void KinematicBodies::Remove(const std::size_t index) {
+	for (auto* column : { &this->x, &this->y, &this->vx, &this->vy }) {
+		column->at(index) = column->back();
+		column->pop_back();
+	}
+}
+
+void KinematicBodies::Reserve(const std::size_t capacity) {
+	for (auto* column : { &this->x, &this->y, &this->vx, &this->vy }) {
+		column->reserve(capacity);
+	}
+}
+
+void KinematicBodies::Clear() {
+	for (auto* column : { &this->x, &this->y, &this->vx, &this->vy }) {
+		column->clear();
+	}
+}
+
+std::size_t KinematicBodies::size() const {
+	return this->x.size();
+}
+
+glm::vec2 KinematicBodies::getPosition(const std::size_t index) const {
+	return glm::vec2(this->x.at(index), this->y.at(index));
+}
+
+glm::vec2 KinematicBodies::getVelocity(const std::size_t index) const {
+	return glm::vec2(this->vx.at(index), this->vy.at(index));
+}
+
+void KinematicBodies::setPosition(const std::size_t index, const glm::vec2& position) {
+	this->x.at(index) = position.x;
+	this->y.at(index) = position.y;
+}
+
+void KinematicBodies::setVelocity(const std::size_t index, const glm::vec2& velocity) {
+	this->vx.at(index) = velocity.x;
+	this->vy.at(index) = velocity.y;
+}
+
+void KinematicBodies::Integrate(const float dt, const KinematicsParams& params, Scheduler* scheduler, const SimdLevel level) {
+	if (!scheduler) {
+		IntegrateArrays(this->x.data(), this->y.data(), this->vx.data(), this->vy.data(), this->size(), dt, params, level);
+		return;
+	}
+	// Chunks are a multiple of 8 bodies, so only the last one has a scalar tail.
+	constexpr std::size_t grain = 8192;
+	scheduler->parallel_for_chunks(0, this->size(), grain, [this, dt, &params, level](const std::size_t chunkBegin, const std::size_t chunkEnd) {
+		IntegrateArrays(this->x.data() + chunkBegin, this->y.data() + chunkBegin, this->vx.data() + chunkBegin, this->vy.data() + chunkBegin, chunkEnd - chunkBegin, dt, params, level);
+	});
+}
+
+void KinematicBodies::IntegrateArrays(float* x, float* y, float* vx, float* vy, const std::size_t count, const float dt, const KinematicsParams& params, const SimdLevel level) {
+	Step step;
+	step.dt = dt;
+	step.factor = params.damping > 0.0f ? std::exp(-params.damping * dt) : 1.0f;
+	step.clamp = params.clampToBounds;
+	step.minX = params.boundsMin.x;
+	step.minY = params.boundsMin.y;
+	step.maxX = params.boundsMax.x;
+	step.maxY = params.boundsMax.y;
+	step.restitution = params.restitution;
+
+	const SimdLevel supported = getSupportedSimdLevel();
+	[[maybe_unused]] const SimdLevel used = level == SimdLevel::Auto ? supported : std::min(level, supported);
+	std::size_t done = 0;
+#if ENGINE_KINEMATICS_X86
+	if (used == SimdLevel::AVX2) {
+		done = integrateAVX2(x, y, vx, vy, count, step);
+	} else if (used == SimdLevel::SSE2) {
+		done = integrateSSE2(x, y, vx, vy, count, step);
+	}
+#endif
+	integrateScalar(x, y, vx, vy, done, count, step);
+}
+
+SimdLevel KinematicBodies::getSupportedSimdLevel() {
+	static const SimdLevel level = detectSimdLevel();
+	return level;
+}
@@ -0,0 +1,175 @@
+#include "engine/light_manager.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+namespace {
+	// std140 images of the light structs declared by Mesh's generated shaders. A vec3 is aligned to 16 bytes but a
+	// float may sit in its last 4, and every array element is padded to a multiple of 16.
+	struct DirLightStd140 {
+		glm::vec3 direction;
+		float pad0;
+		glm::vec3 ambient;
+		float pad1;
+		glm::vec3 diffuse;
+		float pad2;
+		glm::vec3 specular;
+		float pad3;
+	};
+	static_assert(sizeof(DirLightStd140) == 64, "DirLight must match its std140 array stride");
+
+	struct PointLightStd140 {
+		glm::vec3 position;
+		float constant;
+		float linear;
+		float quadratic;
+		float pad0[2];
+		glm::vec3 ambient;
+		float pad1;
+		glm::vec3 diffuse;
+		float pad2;
+		glm::vec3 specular;
+		float pad3;
+	};
+	static_assert(sizeof(PointLightStd140) == 80, "PointLight must match its std140 array stride");
+	static_assert(offsetof(PointLightStd140, constant) == 12 && offsetof(PointLightStd140, ambient) == 32, "PointLight std140 offsets");
+
+	struct SpotLightStd140 {
+		glm::vec3 position;
+		float pad0;
+		glm::vec3 direction;
+		float cutOff;
+		float outerCutOff;
+		float constant;
+		float linear;
+		float quadratic;
+		glm::vec3 ambient;
+		float pad1;
+		glm::vec3 diffuse;
+		float pad2;
+		glm::vec3 specular;
+		float pad3;
+	};
+	static_assert(sizeof(SpotLightStd140) == 96, "SpotLight must match its std140 array stride");
+	static_assert(offsetof(SpotLightStd140, cutOff) == 28 && offsetof(SpotLightStd140, ambient) == 48, "SpotLight std140 offsets");
+
+	template<typename T>
+	void Append(std::vector<unsigned char>& bytes, const T& value) {
+		const auto* begin = reinterpret_cast<const unsigned char*>(&value);
+		bytes.insert(bytes.end(), begin, begin + sizeof(T));
+	}
+
+	// Padding is zeroed so unchanged lights pack to identical bytes.
+	void Pack(std::vector<unsigned char>& bytes, const DirLight& light) {
+		DirLightStd140 packed{};
+		packed.direction = light.direction;
+		packed.ambient = light.ambient;
+		packed.diffuse = light.diffuse;
+		packed.specular = light.specular;
+		Append(bytes, packed);
+	}
+
+	void Pack(std::vector<unsigned char>& bytes, const PointLight& light) {
+		PointLightStd140 packed{};
+		packed.position = light.position;
+		packed.constant = light.constant;
+		packed.linear = light.linear;
+		packed.quadratic = light.quadratic;
+		packed.ambient = light.ambient;
+		packed.diffuse = light.diffuse;
+		packed.specular = light.specular;
+		Append(bytes, packed);
+	}
+
+	void Pack(std::vector<unsigned char>& bytes, const SpotLight& light) {
+		SpotLightStd140 packed{};
+		packed.position = light.position;
+		packed.direction = light.direction;
+		packed.cutOff = light.cutOff;
+		packed.outerCutOff = light.outerCutOff;
+		packed.constant = light.constant;
+		packed.linear = light.linear;
+		packed.quadratic = light.quadratic;
+		packed.ambient = light.ambient;
+		packed.diffuse = light.diffuse;
+		packed.specular = light.specular;
+		Append(bytes, packed);
+	}
+
+	// Fill the rest of a block that once held more lights, shaders built for that many still read all of them.
+	// These add no light and, unlike zeroed bytes, keep the attenuation and cone maths from dividing by zero.
+	const DirLight unlitDir{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+	const PointLight unlitPoint{ glm::vec3(0.0f), 1.0f, 0.0f, 0.0f, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+	const SpotLight unlitSpot{ glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+
+	template<typename Light>
+	void PadTo(std::vector<unsigned char>& bytes, const std::size_t size, const Light& unlit) {
+		while (bytes.size() < size) {
+			Pack(bytes, unlit);
+		}
+	}
+}
+
+bool LightManager::uploadBlock(Block& block, const std::vector<unsigned char>& data, const unsigned int binding) {
+	bool uploaded = false;
+	if (!data.empty() && data != block.uploaded) {
+		if (block.buffer == 0) {
+			glGenBuffers(1, &block.buffer);
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, block.buffer);
+		if (data.size() > block.capacity) {
+			glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(data.size()), data.data(), GL_DYNAMIC_DRAW);
+			block.capacity = data.size();
+		} else {
+			// Never shrunk, Upload pads data to the full capacity so no stale lights are left past the end.
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(data.size()), data.data());
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		block.uploaded = data;
+		uploaded = true;
+	}
+	if (block.buffer != 0) {
+		// Every time, in case something else was bound there since.
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, block.buffer);
+	}
+	return uploaded;
+}
+
+bool LightManager::Upload() {
+	bool uploaded = false;
+
+	this->packed.clear();
+	for (const auto& light : this->direction) {
+		Pack(this->packed, light);
+	}
+	PadTo(this->packed, this->dirBlock.capacity, unlitDir);
+	uploaded = uploadBlock(this->dirBlock, this->packed, dirLightBinding) || uploaded;
+
+	this->packed.clear();
+	for (const auto& light : this->point) {
+		Pack(this->packed, light);
+	}
+	PadTo(this->packed, this->pointBlock.capacity, unlitPoint);
+	uploaded = uploadBlock(this->pointBlock, this->packed, pointLightBinding) || uploaded;
+
+	this->packed.clear();
+	for (const auto& light : this->spotlight) {
+		Pack(this->packed, light);
+	}
+	for (const auto& light : this->flashlight) {
+		Pack(this->packed, light);
+	}
+	PadTo(this->packed, this->spotBlock.capacity, unlitSpot);
+	uploaded = uploadBlock(this->spotBlock, this->packed, spotLightBinding) || uploaded;
+	return uploaded;
+}
+
+void LightManager::Shutdown() {
+	for (Block* block : { &this->dirBlock, &this->pointBlock, &this->spotBlock }) {
+		if (block->buffer != 0) {
+			glDeleteBuffers(1, &block->buffer);
+		}
+		*block = Block();
+	}
+}
@@ -32,9 +32,7 @@ std::string Mesh::create_vertex_shader() const {
         ""+texture_export+"\n" // This is conditional based on (this->use_textures)
         "\n"
         "uniform mat4 model;\n"
-        "uniform mat4 view;\n"
-        "uniform mat4 projection;\n"
-        "\n"
+        ""+std::string(Renderer3D::cameraBlockSource)+"\n"
         "void main() {\n"
         "   "+texture_pass+"\n" // This is conditional based on (this->use_textures)
         "   FragPos = vec3(model * vec4(aPos, 1.0));\n"
@@ -202,7 +200,7 @@ std::string Mesh::create_fragment_shader(const std::size_t& numDirLights, const
     std::string lighting_defs = "";
     std::string lighting_count_defs = "";
     std::string uniform_defs =
-        "uniform vec3 viewPos;\n"
+        std::string(Renderer3D::cameraBlockSource)+
         "uniform Material material;\n";
     std::string lighting_calc = "";
     std::string lighting_fwd_defs = "";
@@ -211,7 +209,10 @@ std::string Mesh::create_fragment_shader(const std::size_t& numDirLights, const
     if (numDirLights > 0) {
         lighting_defs += direction_light_struct;
         lighting_count_defs += num_dir_lights_def;
-        uniform_defs += "uniform DirLight dirLights[NR_DIR_LIGHTS];\n";
+        uniform_defs +=
+            "layout(std140) uniform "+std::string(LightManager::dirLightBlock)+" {\n"
+            "   DirLight dirLights[NR_DIR_LIGHTS];\n"
+            "};\n";
         lighting_calc +=
             "   for (int i = 0; i < NR_DIR_LIGHTS; i++) {\n"
             "      result += CalcDirLight(dirLights[i], norm, viewDir);\n"
@@ -223,7 +224,10 @@ std::string Mesh::create_fragment_shader(const std::size_t& numDirLights, const
     if (numPointLights > 0) {
         lighting_defs += point_light_struct;
         lighting_count_defs += num_point_lights_def;
-        uniform_defs += "uniform PointLight pointLights[NR_POINT_LIGHTS];\n";
+        uniform_defs +=
+            "layout(std140) uniform "+std::string(LightManager::pointLightBlock)+" {\n"
+            "   PointLight pointLights[NR_POINT_LIGHTS];\n"
+            "};\n";
         lighting_calc +=
             "   for (int i = 0; i < NR_POINT_LIGHTS; i++) {\n"
             "      result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);\n"
@@ -235,7 +239,10 @@ std::string Mesh::create_fragment_shader(const std::size_t& numDirLights, const
     if (numSpotLights > 0) {
         lighting_defs += spotlight_light_struct;
         lighting_count_defs += num_spot_lights_def;
-        uniform_defs += "uniform SpotLight spotLights[NR_SPOT_LIGHTS];\n";
+        uniform_defs +=
+            "layout(std140) uniform "+std::string(LightManager::spotLightBlock)+" {\n"
+            "   SpotLight spotLights[NR_SPOT_LIGHTS];\n"
+            "};\n";
         lighting_calc +=
             "   for (int i = 0; i < NR_SPOT_LIGHTS; i++) {\n"
             "      result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);\n"
@@ -296,7 +303,10 @@ bool Mesh::autoCreateShader(Engine* engine) {
     // Flashlights are implemented as spotlights.
     const std::string fragment_code = this->create_fragment_shader(dirCount, pointCount, spotlightCount + flashlightCount);
 
-    this->shader = Shader(vertex_code, fragment_code);
+    {
+        ENGINE_TRACE_SCOPE("shader", "CompileMeshShader");
+        this->shader = Shader(vertex_code, fragment_code);
+    }
     const bool is_valid = this->shader.valid();
 
 #if ENGINE_DEBUG
@@ -308,73 +318,59 @@ bool Mesh::autoCreateShader(Engine* engine) {
 	}
 #endif
     if (is_valid) {
-        // Set light properties.
+        this->resolveUniforms();
         this->shader.use();
 
-        for (std::size_t i = 0; i < dirCount; ++i) {
-            const auto dirLight = engine->getLightManager()->getDirLights().at(i);
-            this->shader.setVec3("dirLights["+std::to_string(i)+"].direction", dirLight.direction);
-
-            this->shader.setVec3("dirLights["+std::to_string(i)+"].ambient", dirLight.ambient);
-            this->shader.setVec3("dirLights["+std::to_string(i)+"].diffuse", dirLight.diffuse);
-            this->shader.setVec3("dirLights["+std::to_string(i)+"].specular", dirLight.specular);
-        }
-
-        for (std::size_t i = 0; i < pointCount; ++i) {
-            const auto pointLight = engine->getLightManager()->getPointLights().at(i);
-            this->shader.setVec3("pointLights["+std::to_string(i)+"].position", pointLight.position);
-
-            this->shader.setFloat("pointLights["+std::to_string(i)+"].constant", pointLight.constant);
-            this->shader.setFloat("pointLights["+std::to_string(i)+"].linear", pointLight.linear);
-            this->shader.setFloat("pointLights["+std::to_string(i)+"].quadratic", pointLight.quadratic);
-
-            this->shader.setVec3("pointLights["+std::to_string(i)+"].ambient", pointLight.ambient);
-            this->shader.setVec3("pointLights["+std::to_string(i)+"].diffuse", pointLight.diffuse);
-            this->shader.setVec3("pointLights["+std::to_string(i)+"].specular", pointLight.specular);
-        }
-
-        for (std::size_t i = 0; i < spotlightCount + flashlightCount; ++i) {
-            // First half is spotlights, then flashlights.
-            if (i < spotlightCount) {
-                const auto index = i;
-                const auto spotLight = engine->getLightManager()->getSpotLight().at(index);
-
-                this->shader.setVec3("spotLights["+std::to_string(i)+"].position", spotLight.position);
-                this->shader.setVec3("spotLights["+std::to_string(i)+"].direction", spotLight.direction);
-                this->shader.setFloat("spotLights["+std::to_string(i)+"].cutOff", spotLight.cutOff);
-                this->shader.setFloat("spotLights["+std::to_string(i)+"].outerCutOff", spotLight.outerCutOff);
-
-                this->shader.setFloat("spotLights["+std::to_string(i)+"].constant", spotLight.constant);
-                this->shader.setFloat("spotLights["+std::to_string(i)+"].linear", spotLight.linear);
-                this->shader.setFloat("spotLights["+std::to_string(i)+"].quadratic", spotLight.quadratic);
-
-                this->shader.setVec3("spotLights["+std::to_string(i)+"].ambient", spotLight.ambient);
-                this->shader.setVec3("spotLights["+std::to_string(i)+"].diffuse", spotLight.diffuse);
-                this->shader.setVec3("spotLights["+std::to_string(i)+"].specular", spotLight.specular);
-            } else {
-                // Update flashlights
-                const auto index = i - spotlightCount;
-                const auto flashLight = engine->getLightManager()->getFlashLight().at(index);
-
-                this->shader.setVec3("flashLights["+std::to_string(i)+"].position", flashLight.position);
-                this->shader.setVec3("flashLights["+std::to_string(i)+"].direction", flashLight.direction);
-                this->shader.setFloat("flashLights["+std::to_string(i)+"].cutOff", flashLight.cutOff);
-                this->shader.setFloat("flashLights["+std::to_string(i)+"].outerCutOff", flashLight.outerCutOff);
-
-                this->shader.setFloat("flashLights["+std::to_string(i)+"].constant", flashLight.constant);
-                this->shader.setFloat("flashLights["+std::to_string(i)+"].linear", flashLight.linear);
-                this->shader.setFloat("flashLights["+std::to_string(i)+"].quadratic", flashLight.quadratic);
-
-                this->shader.setVec3("flashLights["+std::to_string(i)+"].ambient", flashLight.ambient);
-                this->shader.setVec3("flashLights["+std::to_string(i)+"].diffuse", flashLight.diffuse);
-                this->shader.setVec3("flashLights["+std::to_string(i)+"].specular", flashLight.specular);
+        // Samplers read fixed texture units, set them once rather than every draw.
+        unsigned int diffuseIndex = 1;
+        unsigned int specularIndex = 1;
+        unsigned int normalIndex = 1;
+        unsigned int heightIndex = 1;
+        for (std::size_t i = 0; this->use_textures && i < this->textures.size(); ++i) {
+            // retrieve texture number (the N in diffuse_textureN)
+            std::string number;
+            const std::string& name = this->textures[i].desc;
+            if (name == this->diffuseDesc) {
+                number = std::to_string(diffuseIndex++);
+            } else if(name == this->specularDesc) {
+                number = std::to_string(specularIndex++);
+            } else if(name == this->normalDesc) {
+                number = std::to_string(normalIndex++);
+            } else if(name == this->heightDesc) {
+                number = std::to_string(heightIndex++);
             }
+            this->shader.setInt(name + number, static_cast<int>(i));
         }
+
+        // The camera and lights are read from Renderer3D's and LightManager's uniform buffers.
+        this->shader.bindUniformBlock(Renderer3D::cameraBlock, Renderer3D::cameraBinding);
+        this->shader.bindUniformBlock(LightManager::dirLightBlock, LightManager::dirLightBinding);
+        this->shader.bindUniformBlock(LightManager::pointLightBlock, LightManager::pointLightBinding);
+        this->shader.bindUniformBlock(LightManager::spotLightBlock, LightManager::spotLightBinding);
     }
 
     return is_valid;
 }
 
+void Mesh::resolveUniforms() {
+    Uniforms& handles = this->uniforms;
+    handles.model = this->shader.uniform("model");
+    handles.lightAmbient = this->shader.uniform("light.ambient");
+    handles.lightDiffuse = this->shader.uniform("light.diffuse");
+    handles.lightSpecular = this->shader.uniform("light.specular");
+    handles.materialAmbient = this->shader.uniform("material.ambient");
+    handles.materialDiffuse = this->shader.uniform("material.diffuse");
+    handles.materialSpecular = this->shader.uniform("material.specular");
+    handles.materialShininess = this->shader.uniform("material.shininess");
+    handles.materialAmbientMix = this->shader.uniform("material.ambientMix");
+    handles.materialDiffuseMix = this->shader.uniform("material.diffuseMix");
+    handles.materialSpecularMix = this->shader.uniform("material.specularMix");
+}
+
+const Aabb3D& Mesh::getBounds() const {
+	return this->bounds;
+}
+
 std::string Mesh::description() const {
     return "Num Diffuse: (" + this->diffuseDesc + ") - " + std::to_string(this->diffuseNr) + "\n" +
         "Num Specular: (" + this->specularDesc + ") - " + std::to_string(this->specularNr) + "\n" +
@@ -382,50 +378,15 @@ std::string Mesh::description() const {
         "Num Height: (" + this->heightDesc + ") - " + std::to_string(this->heightNr) + "\n";
 }
 
+// The camera and lights come from uniform buffers shared by every mesh, this only makes sure the camera's is current.
 void Mesh::UpdatePerspective(Engine* engine) {
-	this->shader\
-		.use()\
-		.setMat4("projection", engine->get3DRenderer()->getProjection())\
-        .setMat4("view", engine->get3DRenderer()->getView())\
-        .setVec3("viewPos", engine->get3DRenderer()->getCameraPos());
-
-    // Update light position
-    const auto dirCount = engine->getLightManager()->getDirLights().size();
-    const auto pointCount = engine->getLightManager()->getPointLights().size();
-    const auto spotlightCount = engine->getLightManager()->getSpotLight().size();
-    const auto flashlightCount = engine->getLightManager()->getFlashLight().size();
-
-    for (std::size_t i = 0; i < dirCount; ++i) {
-        const auto dirLight = engine->getLightManager()->getDirLights().at(i);
-        this->shader.setVec3("dirLights["+std::to_string(i)+"].direction", dirLight.direction);
-    }
-
-    for (std::size_t i = 0; i < pointCount; ++i) {
-        const auto pointLight = engine->getLightManager()->getPointLights().at(i);
-        this->shader.setVec3("pointLights["+std::to_string(i)+"].position", pointLight.position);
-    }
-
-    for (std::size_t i = 0; i < spotlightCount + flashlightCount; ++i) {
-        // First half is spotlights, then flashlights.
-        if (i < spotlightCount) {
-            const auto index = i;
-            const auto spotLight = engine->getLightManager()->getSpotLight().at(index);
-
-            this->shader.setVec3("spotLights["+std::to_string(i)+"].position", spotLight.position);
-            this->shader.setVec3("spotLights["+std::to_string(i)+"].direction", spotLight.direction);
-        } else {
-            const auto index = i - spotlightCount;
-            const auto flashLight = engine->getLightManager()->getFlashLight().at(index);
-
-            this->shader.setVec3("flashLights["+std::to_string(i)+"].position", flashLight.position);
-            this->shader.setVec3("flashLights["+std::to_string(i)+"].direction", flashLight.direction);
-        }
-    }
+    engine->get3DRenderer()->Upload();
 }
 
 // render the mesh
 void Mesh::Draw(const glm::mat4& model) const {
-	this->shader.use().setMat4("model", model);
+	ENGINE_GPU_SCOPE("Mesh::Draw");
+	this->shader.use().setMat4(this->uniforms.model, model);
 
 //    glm::vec3 lightColor;
 //    lightColor.x = sin(0 * 2.0f);
@@ -433,43 +394,24 @@ void Mesh::Draw(const glm::mat4& model) const {
 //    lightColor.z = sin(0 * 1.3f);
 //    glm::vec3 diffuseColor = lightColor   * glm::vec3(1.0f); /*glm::vec3(0.5f)*/; // decrease the influence
 //    glm::vec3 ambientColor = diffuseColor * glm::vec3(1.0f); // low influence
-    this->shader.setVec3("light.ambient", glm::vec3(0.2f));
-    this->shader.setVec3("light.diffuse", glm::vec3(0.8f));
-    this->shader.setVec3("light.specular", glm::vec3(1.0f));
+    this->shader.setVec3(this->uniforms.lightAmbient, glm::vec3(0.2f));
+    this->shader.setVec3(this->uniforms.lightDiffuse, glm::vec3(0.8f));
+    this->shader.setVec3(this->uniforms.lightSpecular, glm::vec3(1.0f));
 
     // material properties
-    this->shader.setVec3("material.ambient", this->material.AmbientColour);
-    this->shader.setVec3("material.diffuse", this->material.DiffuseColour);
-    this->shader.setVec3("material.specular", this->material.SpecularColour); // specular lighting doesn't have full effect on this object's material
-    this->shader.setFloat("material.shininess", this->material.shininess);
+    this->shader.setVec3(this->uniforms.materialAmbient, this->material.AmbientColour);
+    this->shader.setVec3(this->uniforms.materialDiffuse, this->material.DiffuseColour);
+    this->shader.setVec3(this->uniforms.materialSpecular, this->material.SpecularColour); // specular lighting doesn't have full effect on this object's material
+    this->shader.setFloat(this->uniforms.materialShininess, this->material.shininess);
 
-    this->shader.setFloat("material.ambientMix", 1-this->material.ambient_tex_blend);
-    this->shader.setFloat("material.diffuseMix", 1-this->material.diffuse_tex_blend);
-    this->shader.setFloat("material.specularMix", 1-this->material.specular_tex_blend);
+    this->shader.setFloat(this->uniforms.materialAmbientMix, 1-this->material.ambient_tex_blend);
+    this->shader.setFloat(this->uniforms.materialDiffuseMix, 1-this->material.diffuse_tex_blend);
+    this->shader.setFloat(this->uniforms.materialSpecularMix, 1-this->material.specular_tex_blend);
 
     if (this->use_textures) {
-        // bind appropriate textures
-        unsigned int diffuseIndex = 1;
-        unsigned int specularIndex = 1;
-        unsigned int normalIndex = 1;
-        unsigned int heightIndex = 1;
-
+        // bind appropriate textures, the samplers were pointed at these units when the shader was built
         for (unsigned int i = 0; i < textures.size(); ++i) {
             glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-                                              // retrieve texture number (the N in diffuse_textureN)
-            std::string number;
-            std::string name = textures[i].desc;
-            if (name == this->diffuseDesc) {
-                number = std::to_string(diffuseIndex++);
-            } else if(name == this->specularDesc) {
-                number = std::to_string(specularIndex++);
-            } else if(name == this->normalDesc) {
-                number = std::to_string(normalIndex++);
-            } else if(name == this->heightDesc) {
-                number = std::to_string(heightIndex++);
-            }
-
-            this->shader.setInt(name + number, static_cast<int>(i));
             this->textures[i].Bind();
         }
     }
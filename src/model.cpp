@@ -1,12 +1,62 @@
 #include "engine/model.hpp"
+#include "engine/trace.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
+#include <set>
+#include <stdexcept>
+
+namespace {
+	// Textures are stored under their path, so every model using a file shares it.
+	std::string modelTexturePath(const aiString& file, const constants::fs::path& root_dir) {
+		return root_dir.string() + "/" + std::string(file.C_Str());
+	}
+
+	std::string modelTextureName(const std::string& path) {
+		return "model_" + path;
+	}
+
+	constexpr aiTextureType modelTextureTypes[] = { aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_AMBIENT };
+}
+
 Model::Model(Engine* engine, const std::string& path) {
 	this->loadModel(engine, path);
 }
 
+#if ENGINE_ENABLE_COROUTINES
+CoTask<std::unique_ptr<Model>> Model::Load(Engine* engine, std::string path) {
+	// Checked before the coroutine starts, it couldn't get back to a main thread to build the meshes.
+	if (!engine->isRendering()) {
+		throw std::logic_error("Model::Load builds meshes on the main (GL) thread, there is none in EngineMode::Simulation");
+	}
+	return loadOnWorker(engine, std::move(path));
+}
+
+CoTask<std::unique_ptr<Model>> Model::loadOnWorker(Engine* engine, std::string path) {
+	// Parsing and decoding are the slow part, keep them off the main thread.
+	co_await engine->getScheduler()->schedule();
+	auto importer = std::make_unique<Assimp::Importer>();
+	const aiScene* scene = importScene(*importer, path);
+	const auto directory = constants::fs::path(path).parent_path();
+	if (scene) {
+		preloadTextures(engine, *scene, directory);
+	}
+
+	// Meshes read textures from the resource manager, which is only touched on the main thread.
+	co_await engine->mainThread();
+	std::unique_ptr<Model> model(new Model());
+	if (scene) {
+		model->processNode(engine, *scene->mRootNode, *scene, directory);
+	}
+	co_return model;
+}
+
+CoTask<std::unique_ptr<Model>> Engine::loadModel(std::string path) {
+	return Model::Load(this, std::move(path));
+}
+#endif
+
 Model::~Model() {
 	for (auto& mesh : this->meshes) {
 		mesh.Cleanup();
@@ -21,6 +71,14 @@ std::size_t Model::numMeshes() const {
 		return this->meshes.size();
 }
 
+const Aabb3D& Model::getBounds() const {
+	return this->bounds;
+}
+
+Aabb3D Model::getWorldBounds(const glm::mat4& model) const {
+	return this->bounds.Transformed(model);
+}
+
 void Model::Init(Engine* engine) {
     for (auto& mesh : this->meshes) {
         mesh.autoCreateShader(engine);
@@ -55,13 +113,42 @@ void Model::Draw(const glm::mat4& model) const {
 	}
 }
 
-void Model::loadModel(Engine* engine, const std::string& path) {
+const aiScene* Model::importScene(Assimp::Importer& importer, const std::string& path) {
+	ENGINE_TRACE_SCOPE_DETAIL("asset", "ImportScene", path);
 	// read file via ASSIMP
-	Assimp::Importer importer;
     const aiScene* scene = importer.ReadFile(path, /*aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace*/ aiProcessPreset_TargetRealtime_MaxQuality);
 	// check for errors
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
 		std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+		return nullptr;
+	}
+	return scene;
+}
+
+void Model::preloadTextures(Engine* engine, const aiScene& scene, const constants::fs::path& root_dir) {
+	std::set<std::string> queued;
+	for (unsigned int m = 0; m < scene.mNumMaterials; ++m) {
+		const aiMaterial& material = *scene.mMaterials[m];
+		for (const aiTextureType type : modelTextureTypes) {
+			for (unsigned int i = 0; i < material.GetTextureCount(type); ++i) {
+				aiString str;
+				material.GetTexture(type, i, &str);
+				const std::string tex_path = modelTexturePath(str, root_dir);
+				if (queued.insert(tex_path).second) {
+					// Same settings as loadMaterialTextures, which then finds them already loaded.
+					// Dropping the future doesn't wait for it.
+					engine->getResourceManager()->LoadTextureAsync(tex_path, modelTextureName(tex_path), false, true);
+				}
+			}
+		}
+	}
+}
+
+void Model::loadModel(Engine* engine, const std::string& path) {
+	ENGINE_TRACE_SCOPE_DETAIL("asset", "LoadModel", path);
+	Assimp::Importer importer;
+	const aiScene* scene = importScene(importer, path);
+	if (!scene) {
 		return;
 	}
 	// retrieve the directory path of the filepath
@@ -78,6 +165,7 @@ void Model::processNode(Engine* engine, const aiNode& node, const aiScene& scene
 		// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
 		const aiMesh* mesh = scene.mMeshes[node.mMeshes[i]];
 		meshes.emplace_back(processMesh(engine, *mesh, scene, root_dir));
+		this->bounds.Expand(meshes.back().getBounds());
 	}
 
 	// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
@@ -107,10 +195,12 @@ Mesh Model::processMesh(Engine* engine, const aiMesh& mesh, const aiScene& scene
 		return vector;
 	};
 
+	Aabb3D meshBounds;
 	// walk through each of the mesh's vertices
 	for (unsigned int i = 0; i < mesh.mNumVertices; ++i) {
 		Vertex vertex;
 		vertex.Position = ai_to_vec3(mesh.mVertices[i]);
+		meshBounds.Expand(vertex.Position);
 		vertex.Normal = ai_to_vec3(mesh.mNormals[i]);
 		// texture coordinates
 		if (mesh.mTextureCoords[0]) {// does the mesh contain texture coordinates?
@@ -182,6 +272,7 @@ Mesh Model::processMesh(Engine* engine, const aiMesh& mesh, const aiScene& scene
 
 	// return a mesh object created from the extracted mesh data
 	Mesh finalMesh(vertices, indices, textures, mat);
+	finalMesh.bounds = meshBounds;
 	finalMesh.fragmentOutColour = this->fragmentOutColour;
 	finalMesh.diffuseDesc = this->diffuseDesc;
 	finalMesh.specularDesc = this->specularDesc;
@@ -199,8 +290,8 @@ std::vector<Texture2D> Model::loadMaterialTextures(Engine* engine, const aiMater
 		mat.GetTexture(type, i, &str);
 
 		// The texture name is just the path of the file
-		const std::string tex_path = root_dir.string() + "/" + std::string(str.C_Str());
-		const std::string tex_name = "model_" + tex_path;
+		const std::string tex_path = modelTexturePath(str, root_dir);
+		const std::string tex_name = modelTextureName(tex_path);
 		auto* resourceManager = engine->getResourceManager();
 		// Return the old texture if it is already loaded.
 		Texture2D texture = resourceManager->TextureLoaded(tex_name) ?
@@ -0,0 +1,220 @@
+#include "engine/profiler.hpp"
+#include "engine/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+	// Zone names are shared by every profiler, so ids can be cached in function-local statics.
+	struct ZoneRegistry {
+		std::mutex mutex;
+		std::map<std::string, std::size_t> ids;
+		// Names by id for trace events, pointing at the map keys.
+		std::array<std::atomic<const char*>, Profiler::MaxZones> names{};
+	};
+
+	ZoneRegistry& zoneRegistry() {
+		static ZoneRegistry registry;
+		return registry;
+	}
+
+	double toMilliseconds(const std::uint64_t& nanos) {
+		return static_cast<double>(nanos) / 1e6;
+	}
+
+	// Nearest-rank percentile over sorted samples.
+	double percentile(const std::vector<std::uint64_t>& sorted, const double& p) {
+		const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+		return toMilliseconds(sorted.at(std::clamp<std::size_t>(rank, 1, sorted.size()) - 1));
+	}
+}
+
+Profiler::Profiler(const std::size_t _historySize) : historySize(0) {
+	this->SetHistorySize(_historySize);
+}
+
+void Profiler::SetHistorySize(const std::size_t _historySize) {
+	if (_historySize == 0) {
+		throw std::invalid_argument("Profiler history must hold at least one frame");
+	}
+	this->historySize = _historySize;
+	this->history = std::make_unique<FrameRecord[]>(_historySize);
+	this->written.store(0);
+	for (auto& column : this->current) {
+		column.store(0, std::memory_order_relaxed);
+	}
+}
+
+std::size_t Profiler::getHistorySize() const {
+	return this->historySize;
+}
+
+std::uint64_t Profiler::getFrameCount() const {
+	return this->written.load(std::memory_order_acquire);
+}
+
+void Profiler::AddPhase(const FramePhase phase, const Clock::duration& duration) noexcept {
+	const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	this->current[static_cast<std::size_t>(phase)].fetch_add(static_cast<std::uint64_t>(nanos), std::memory_order_relaxed);
+}
+
+void Profiler::AddZone(const std::size_t zone, const Clock::duration& duration) noexcept {
+	if (zone >= MaxZones) {
+		return;
+	}
+	const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	this->current[NumPhases + zone].fetch_add(static_cast<std::uint64_t>(nanos), std::memory_order_relaxed);
+}
+
+void Profiler::EndFrame() noexcept {
+	const auto frame = this->written.load(std::memory_order_relaxed);
+	auto& record = this->history[frame % this->historySize];
+
+	// Seqlock write, readers discard the row if they observe an odd or changed sequence.
+	const auto seq = record.seq.load(std::memory_order_relaxed);
+	record.seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (std::size_t i = 0; i < NumColumns; ++i) {
+		record.nanos[i].store(this->current[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	record.seq.store(seq + 2, std::memory_order_release);
+
+	this->written.store(frame + 1, std::memory_order_release);
+}
+
+std::size_t Profiler::RegisterZone(const std::string& name) {
+	auto& registry = zoneRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	const auto found = registry.ids.find(name);
+	if (found != registry.ids.end()) {
+		return found->second;
+	}
+	if (registry.ids.size() >= MaxZones) {
+		throw std::length_error("Too many profiler zones registered: " + name);
+	}
+	const auto id = registry.ids.size();
+	const auto inserted = registry.ids.emplace(name, id).first;
+	registry.names.at(id).store(inserted->first.c_str());
+	return id;
+}
+
+ProfileStats Profiler::getPhaseStats(const FramePhase phase) const {
+	return this->collect(static_cast<std::size_t>(phase), false);
+}
+
+ProfileStats Profiler::getZoneStats(const std::string& name) const {
+	auto& registry = zoneRegistry();
+	std::size_t zone = 0;
+	{
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		const auto found = registry.ids.find(name);
+		if (found == registry.ids.end()) {
+			return {};
+		}
+		zone = found->second;
+	}
+	return this->collect(NumPhases + zone, true);
+}
+
+ProfileStats Profiler::collect(const std::size_t column, const bool skipEmpty) const {
+	const auto frames = this->written.load(std::memory_order_acquire);
+	const auto available = static_cast<std::size_t>(std::min<std::uint64_t>(frames, this->historySize));
+
+	std::vector<std::uint64_t> samples;
+	samples.reserve(available);
+	for (std::size_t i = 0; i < available; ++i) {
+		const auto& record = this->history[(frames - 1 - i) % this->historySize];
+		const auto before = record.seq.load(std::memory_order_acquire);
+		const auto value = record.nanos[column].load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const auto after = record.seq.load(std::memory_order_relaxed);
+		if (before != after || before % 2 != 0) {
+			// Being overwritten by a newer frame.
+			continue;
+		}
+		if (skipEmpty && value == 0) {
+			continue;
+		}
+		samples.push_back(value);
+	}
+
+	return Summarize(std::move(samples));
+}
+
+ProfileStats Profiler::Summarize(std::vector<std::uint64_t> samples) {
+	ProfileStats stats;
+	if (samples.empty()) {
+		return stats;
+	}
+	std::sort(samples.begin(), samples.end());
+
+	std::uint64_t total = 0;
+	for (const auto& sample : samples) {
+		total += sample;
+	}
+
+	stats.samples = samples.size();
+	stats.min = toMilliseconds(samples.front());
+	stats.max = toMilliseconds(samples.back());
+	stats.avg = toMilliseconds(total) / static_cast<double>(samples.size());
+	stats.p95 = percentile(samples, 0.95);
+	stats.p99 = percentile(samples, 0.99);
+	return stats;
+}
+
+std::string Profiler::PhaseName(const FramePhase phase) {
+	return phaseLabel(phase);
+}
+
+const char* Profiler::phaseLabel(const FramePhase phase) {
+	switch (phase) {
+	case FramePhase::PollEvents: return "PollEvents";
+	case FramePhase::GLCommands: return "GLCommands";
+	case FramePhase::VRInput: return "VRInput";
+	case FramePhase::ProcessInput: return "ProcessInput";
+	case FramePhase::Update: return "Update";
+	case FramePhase::UpdateWait: return "UpdateWait";
+	case FramePhase::Clear: return "Clear";
+	case FramePhase::Render: return "Render";
+	case FramePhase::AudioUpdate: return "AudioUpdate";
+	case FramePhase::SwapBuffers: return "SwapBuffers";
+	case FramePhase::VRPose: return "VRPose";
+	case FramePhase::FrameWait: return "FrameWait";
+	case FramePhase::Frame: return "Frame";
+	case FramePhase::Count: break;
+	}
+	return "Unknown";
+}
+
+ProfileZone::ProfileZone(Profiler* _profiler, const std::size_t _zone) noexcept : profiler(_profiler), zone(_zone), start(Profiler::Clock::now()) {}
+
+ProfileZone::~ProfileZone() {
+	const auto end = Profiler::Clock::now();
+	if (this->profiler) {
+		this->profiler->AddZone(this->zone, end - this->start);
+	}
+#if ENGINE_ENABLE_TRACING
+	if (Tracer::isEnabled()) {
+		Tracer::Complete("zone", zoneRegistry().names.at(this->zone).load(), this->start, end);
+	}
+#endif
+}
+
+ProfilePhase::ProfilePhase(Profiler* _profiler, const FramePhase _phase) noexcept : profiler(_profiler), phase(_phase), start(Profiler::Clock::now()) {}
+
+ProfilePhase::~ProfilePhase() {
+	const auto end = Profiler::Clock::now();
+	if (this->profiler) {
+		this->profiler->AddPhase(this->phase, end - this->start);
+	}
+#if ENGINE_ENABLE_TRACING
+	if (Tracer::isEnabled()) {
+		Tracer::Complete("frame", Profiler::phaseLabel(this->phase), this->start, end);
+	}
+#endif
+}
@@ -1,15 +1,31 @@
 #include "engine/3d_renderer.hpp"
 
+#include <cstddef>
+
+namespace {
+	// std140 image of Renderer3D::cameraBlockSource
+	struct CameraStd140 {
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 viewPos;
+		float pad0;
+	};
+	static_assert(sizeof(CameraStd140) == 144 && offsetof(CameraStd140, viewPos) == 128, "Camera block must match std140");
+}
+
 void Renderer3D::setProjectionMatrix(const glm::mat4 _projection) {
 	this->projection = _projection;
+	this->cameraChanged = true;
 }
 
 void Renderer3D::setViewMatrix(const glm::mat4& _view) {
 	this->view = _view;
+	this->cameraChanged = true;
 }
 
 void Renderer3D::setCameraPosition(const glm::vec3& _cameraPos) {
     this->cameraPos = _cameraPos;
+    this->cameraChanged = true;
 }
 
 const glm::mat4& Renderer3D::getProjection() const {
@@ -23,3 +39,33 @@ const glm::mat4& Renderer3D::getView() const {
 const glm::vec3& Renderer3D::getCameraPos() const {
     return this->cameraPos;
 }
+
+Frustum Renderer3D::getFrustum() const {
+	return Frustum::FromMatrix(this->projection * this->view);
+}
+
+void Renderer3D::Upload() {
+	if (this->cameraBuffer == 0) {
+		glGenBuffers(1, &this->cameraBuffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, this->cameraBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraStd140), nullptr, GL_DYNAMIC_DRAW);
+		this->cameraChanged = true;
+	}
+	if (this->cameraChanged) {
+		const CameraStd140 camera{ this->view, this->projection, this->cameraPos, 0.0f };
+		glBindBuffer(GL_UNIFORM_BUFFER, this->cameraBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraStd140), &camera);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		this->cameraChanged = false;
+	}
+	// Every time, in case something else was bound there since.
+	glBindBufferBase(GL_UNIFORM_BUFFER, cameraBinding, this->cameraBuffer);
+}
+
+void Renderer3D::Shutdown() {
+	if (this->cameraBuffer != 0) {
+		glDeleteBuffers(1, &this->cameraBuffer);
+		this->cameraBuffer = 0;
+	}
+	this->cameraChanged = true;
+}
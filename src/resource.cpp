@@ -6,10 +6,13 @@
 //
 
 #include "engine/resource.hpp"
+#include "engine/scheduler.hpp"
+#include "engine/trace.hpp"
 #include <glad/glad.h>
 
 #include <cstring>
 #include <sstream>
+#include <stdexcept>
 #include <iostream>
 #include <array>
 #include <fstream>
@@ -23,6 +26,7 @@ ResourceManager::~ResourceManager() {
 }
 
 Shader& ResourceManager::LoadShader(const std::string& vShaderFile, const std::string& fShaderFile, const std::string& name) {
+    ENGINE_TRACE_SCOPE_DETAIL("shader", "LoadShader", name);
     Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile);
 #if ENGINE_DEBUG
     UnusedShaders.insert(name);
@@ -64,6 +68,7 @@ void ResourceManager::SetShaderAsSelfUsed([[maybe_unused]] const std::string& na
 
 Texture2D& ResourceManager::LoadTexture(const std::string& file,const std::string& name, const bool flip_vertically, const bool generate_mipmap) {
     if (!this->ShaderLoaded(name)) {
+        ENGINE_TRACE_SCOPE_DETAIL("asset", "LoadTexture", file);
         // Only load if not found.
         Textures.emplace(name, loadTextureFromFile(file.c_str(), flip_vertically, generate_mipmap));
 
@@ -74,7 +79,54 @@ Texture2D& ResourceManager::LoadTexture(const std::string& file,const std::strin
     return Textures.at(name);
 }
 
+std::future<Texture2D&> ResourceManager::LoadTextureAsync(const std::string& file, const std::string& name, const bool flip_vertically, const bool generate_mipmap) {
+    if (this->glCommands == nullptr) {
+        throw std::logic_error("LoadTextureAsync needs a GL command queue, only set by an Engine constructed in a rendering mode (not EngineMode::Simulation)");
+    }
+    ScreenSize size;
+    unsigned char* data = nullptr;
+    int nrChannels = 0;
+    this->loadImageFile(&data, &size, &nrChannels, file, flip_vertically);
+    // Freed even if the command is dropped unrun.
+    std::shared_ptr<unsigned char> pixels(data, [](unsigned char* p) { stbi_image_free(p); });
+    Texture2D texture = this->describeTexture(nrChannels, generate_mipmap);
+
+    return this->glCommands->Submit([this, texture, size, pixels, name, generate_mipmap]() mutable -> Texture2D& {
+        if (!this->TextureLoaded(name)) {
+            ENGINE_TRACE_SCOPE_DETAIL("asset", "UploadTexture", name);
+            // Only upload if not found, like LoadTexture.
+            texture.Generate(size, pixels.get(), generate_mipmap);
+            Textures.emplace(name, texture);
+#if ENGINE_DEBUG
+            UnusedTextures.insert(name);
+#endif
+        }
+        pixels.reset();
+        return Textures.at(name);
+    });
+}
+
+#if ENGINE_ENABLE_COROUTINES
+CoTask<Texture2D*> ResourceManager::AwaitTexture(std::string file, std::string name, const bool flip_vertically, const bool generate_mipmap) {
+    // Checked before the coroutine starts, it would otherwise wait on a queue nothing drains and never resume.
+    if (this->scheduler == nullptr || this->glCommands == nullptr) {
+        throw std::logic_error("AwaitTexture needs a GL command queue, only set by an Engine constructed in a rendering mode (not EngineMode::Simulation)");
+    }
+    return this->awaitTextureUpload(std::move(file), std::move(name), flip_vertically, generate_mipmap);
+}
+
+CoTask<Texture2D*> ResourceManager::awaitTextureUpload(std::string file, std::string name, const bool flip_vertically, const bool generate_mipmap) {
+    co_await this->scheduler->schedule();
+    // Decodes here and queues the upload.
+    std::future<Texture2D&> uploaded = this->LoadTextureAsync(file, name, flip_vertically, generate_mipmap);
+    // Queued after the upload from this same thread, so it has run by the time we resume.
+    co_await ResumeOn(*this->glCommands);
+    co_return &uploaded.get();
+}
+#endif
+
 Texture2D& ResourceManager::LoadCubeMap(const CubeMap& faces, const bool flip_vertically, const std::string& name) {
+    ENGINE_TRACE_SCOPE_DETAIL("asset", "LoadCubeMap", name);
     Textures.emplace(name, loadCubeMapTextureFromFile(faces, flip_vertically));
 #if ENGINE_DEBUG
     UnusedTextures.insert(name);
@@ -161,13 +213,15 @@ Shader ResourceManager::loadShaderFromFile(const std::string& vShaderFile, const
 }
 
 void ResourceManager::loadImageFile(unsigned char** data, ScreenSize* size, int* nrChannels, const std::string& file, const bool flip_vertically) {
+    ENGINE_TRACE_SCOPE_DETAIL("asset", "DecodeImage", file);
 #if ENGINE_DEBUG
     if (!constants::fs::exists(file)) {
         std::cerr << "ERROR: texture file not found - " << file << std::endl;
     }
 #endif
 
-    stbi_set_flip_vertically_on_load(flip_vertically);
+    // Per thread, loaders may decode on several threads at once.
+    stbi_set_flip_vertically_on_load_thread(flip_vertically);
     *data = stbi_load(file.c_str(), &size->WIDTH, &size->HEIGHT, nrChannels, STBI_default);
 
 #if ENGINE_DEBUG
@@ -178,8 +232,7 @@ void ResourceManager::loadImageFile(unsigned char** data, ScreenSize* size, int*
 }
 
 
-Texture2D ResourceManager::loadTextureFromFile(const std::string& file, const bool flip_vertically, const bool generate_mipmap) {
-    // create texture object
+Texture2D ResourceManager::describeTexture(const int nrChannels, const bool generate_mipmap) const {
     Texture2D texture;
     texture.Wrap_S = GL_REPEAT;
     texture.Wrap_T = GL_REPEAT;
@@ -190,11 +243,6 @@ Texture2D ResourceManager::loadTextureFromFile(const std::string& file, const bo
 	}
     texture.Filter_Max = GL_LINEAR;
 
-    ScreenSize size;
-    unsigned char* data;
-    int nrChannels;
-    // This will not automatically unload it.
-    this->loadImageFile(&data, &size, &nrChannels, file, flip_vertically);
     if (nrChannels == 1) {
         texture.Internal_Format = GL_RED;
         texture.Image_Format = GL_RED;
@@ -207,6 +255,17 @@ Texture2D ResourceManager::loadTextureFromFile(const std::string& file, const bo
     } else {
 		std::cout << "ResourceManager::Texture::Error::Unknown number of channels" << std::endl;
     }
+    return texture;
+}
+
+Texture2D ResourceManager::loadTextureFromFile(const std::string& file, const bool flip_vertically, const bool generate_mipmap) {
+    ScreenSize size;
+    unsigned char* data;
+    int nrChannels;
+    // This will not automatically unload it.
+    this->loadImageFile(&data, &size, &nrChannels, file, flip_vertically);
+    // create texture object
+    Texture2D texture = this->describeTexture(nrChannels, generate_mipmap);
 
     // now generate texture
     texture.Generate(size, data, generate_mipmap);
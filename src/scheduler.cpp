@@ -1,35 +1,312 @@
 #include "engine/scheduler.hpp"
+#include "engine/task_graph.hpp"
+#include "engine/trace.hpp"
 
-Scheduler::Scheduler() {
-	// Create the task scheduler and bind the main thread to it
+#include <iostream>
+
+namespace {
+	std::size_t resolveThreadCount(const SchedulerOptions& options) {
+		if (options.numThreads > 0) {
+			return options.numThreads;
+		}
+		const std::size_t hardwareThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+		// The main thread counts as one of the threads, reserving it means it doesn't share its core with a worker.
+		return options.reserveMainThread ? hardwareThreads : hardwareThreads + 1;
+	}
+
+	SchedulerOptions withThreadCount(const std::size_t numThreads) {
+		SchedulerOptions options;
+		options.numThreads = numThreads;
+		return options;
+	}
+}
+
+#if ENGINE_ENABLE_MULTITHREADED
+namespace {
+	// Tasks may only wait on FTL counters from a fiber, track whether this thread is running one.
+	thread_local std::size_t fiberTaskDepth = 0;
+
+	void RunFiberTask([[maybe_unused]] ftl::TaskScheduler* taskScheduler, void* arg) {
+		std::unique_ptr<Scheduler::Task> task(static_cast<Scheduler::Task*>(arg));
+		fiberTaskDepth += 1;
+		try {
+			ENGINE_TRACE_SCOPE("scheduler", "Task");
+			(*task)();
+		} catch (const std::exception& e) {
+			// Counted tasks keep theirs for WaitForCounter, only fire and forget ones get here.
+			std::cerr << "Uncaught exception in scheduler task: " << e.what() << std::endl;
+		} catch (...) {
+			std::cerr << "Uncaught exception in scheduler task" << std::endl;
+		}
+		fiberTaskDepth -= 1;
+	}
+}
+
+TaskCounter::TaskCounter(Scheduler* scheduler) {
+	if (scheduler->usesFibers()) {
+		this->counter = std::make_unique<ftl::AtomicCounter>(scheduler->taskScheduler.get());
+	}
+}
+#else
+TaskCounter::TaskCounter([[maybe_unused]] Scheduler* scheduler) {}
+#endif
+
+bool TaskCounter::isDone() const {
+	return this->pending.load(std::memory_order_acquire) == 0;
+}
+
+Scheduler::Scheduler(const std::size_t _numThreads) : Scheduler(withThreadCount(_numThreads)) {}
+
+Scheduler::Scheduler(const SchedulerOptions& _options) : options(_options), numThreads(resolveThreadCount(_options)) {
 #if ENGINE_ENABLE_MULTITHREADED
-	taskScheduler.Init();
+	if (this->options.backend == SchedulerBackend::Fibers) {
+		// Create the task scheduler and bind the main thread to it
+		this->mainThread = std::this_thread::get_id();
+		this->taskScheduler = std::make_unique<ftl::TaskScheduler>();
+		ftl::TaskSchedulerInitOptions initOptions;
+		initOptions.ThreadPoolSize = static_cast<unsigned>(this->numThreads);
+		this->taskScheduler->Init(initOptions);
+	}
+#else
+	if (this->options.backend == SchedulerBackend::Fibers) {
+#if ENGINE_DEBUG
+		std::cout << "Fiber scheduler requires ENGINE_ENABLE_MULTITHREADED, using work stealing" << std::endl;
+#endif
+		this->options.backend = SchedulerBackend::WorkStealing;
+	}
 #endif
 }
 
 Scheduler::~Scheduler() {
 }
 
-/*
-template<typename Seq, typename output>
-std::vector<output> Scheduler::map(const std::function<output(Seq::value_type)>&& f, const Seq& data) {
-	std::vector<output> out;
-	out.reserve(funcs.size());
+std::size_t Scheduler::getNumThreads() const {
+	return this->numThreads;
+}
+
+SchedulerBackend Scheduler::getBackend() const {
+	return this->options.backend;
+}
+
+bool Scheduler::PinMainThread() {
+	if (this->options.backend != SchedulerBackend::WorkStealing || !this->options.pinThreads || !this->options.reserveMainThread) {
+		return false;
+	}
+	return WorkStealingPool::PinCurrentThread(0);
+}
+
+Scheduler::Task Scheduler::withCounter(Task task, TaskCounter* counter) {
+	if (counter == nullptr) {
+		return task;
+	}
+	return [task = std::move(task), counter]() {
+		try {
+			task();
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(counter->failureMutex);
+			if (!counter->failure) {
+				counter->failure = std::current_exception();
+			}
+		}
+		counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+	};
+}
+
+bool Scheduler::usesFibers() const {
+	return this->options.backend == SchedulerBackend::Fibers;
+}
+
+#if ENGINE_ENABLE_MULTITHREADED
+bool Scheduler::canUseFibers() const {
+	return std::this_thread::get_id() == this->mainThread || fiberTaskDepth > 0;
+}
+#endif
+
+WorkStealingPool& Scheduler::getPool() {
+	std::call_once(this->poolOnce, [this]() {
+		WorkStealingPool::Options poolOptions;
+		poolOptions.numWorkers = this->numThreads - 1;
+		poolOptions.reserveMainThread = this->options.reserveMainThread;
+		poolOptions.pinWorkers = this->options.pinThreads;
+		poolOptions.cpus = this->options.cpus;
+		this->pool = std::make_unique<WorkStealingPool>(poolOptions);
+	});
+	return *this->pool;
+}
+
+void Scheduler::AddTask(Task task, TaskCounter* counter) {
+	std::vector<Task> tasks;
+	tasks.push_back(std::move(task));
+	this->AddTasks(std::move(tasks), counter);
+}
+
+void Scheduler::AddTasks(std::vector<Task> tasks, TaskCounter* counter) {
+	if (tasks.empty()) {
+		return;
+	}
+	if (counter) {
+		counter->pending.fetch_add(tasks.size(), std::memory_order_acq_rel);
+	}
+
+#if ENGINE_ENABLE_MULTITHREADED
+	if (this->usesFibers()) {
+		if (!this->canUseFibers()) {
+			for (auto& task : tasks) {
+				withCounter(std::move(task), counter)();
+			}
+			return;
+		}
+
+		std::vector<ftl::Task> fiberTasks;
+		fiberTasks.reserve(tasks.size());
+		for (auto& task : tasks) {
+			// Freed by RunFiberTask
+			fiberTasks.push_back({ RunFiberTask, new Task(withCounter(std::move(task), counter)) });
+		}
+		this->taskScheduler->AddTasks(static_cast<unsigned>(fiberTasks.size()), fiberTasks.data(), counter ? counter->counter.get() : nullptr);
+		return;
+	}
+#endif
+
+	if (this->numThreads <= 1) {
+		for (auto& task : tasks) {
+			withCounter(std::move(task), counter)();
+		}
+		return;
+	}
+
+	for (auto& task : tasks) {
+		task = withCounter(std::move(task), counter);
+	}
+	this->getPool().Submit(tasks);
+}
+
+void Scheduler::WaitForCounter(TaskCounter& counter) {
+	this->waitFor(counter);
+	std::exception_ptr failure;
+	{
+		std::lock_guard<std::mutex> lock(counter.failureMutex);
+		std::swap(failure, counter.failure);
+	}
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+}
+
+void Scheduler::waitFor(TaskCounter& counter) {
 #if ENGINE_ENABLE_MULTITHREADED
-	ftl::AtomicCounter counter(&this->taskScheduler);
+	if (this->usesFibers()) {
+		if (this->canUseFibers()) {
+			// Pinned, so the main thread keeps its GL context.
+			this->taskScheduler->WaitForCounter(counter.counter.get(), 0, true);
+			return;
+		}
+		while (!counter.isDone()) {
+			std::this_thread::yield();
+		}
+		return;
+	}
+#endif
+
+	if (this->numThreads <= 1) {
+		return;
+	}
+	auto& workers = this->getPool();
+	while (!counter.isDone()) {
+		// Help out rather than block, this also keeps nested parallel_for from deadlocking.
+		if (!workers.RunOne()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void Scheduler::RunGraph(TaskGraph& graph) {
+	if (!graph.isCompiled()) {
+		graph.Compile();
+	}
+	if (graph.nodes.empty()) {
+		return;
+	}
+
+	bool serial = this->numThreads <= 1;
+#if ENGINE_ENABLE_MULTITHREADED
+	serial = serial || !this->canUseFibers();
+#endif
+	if (serial) {
+		for (const auto& node : graph.order) {
+			if (graph.nodes[node].task) {
+				ENGINE_TRACE_SCOPE("scheduler", graph.nodes[node].traceName);
+				graph.nodes[node].task();
+			}
+		}
+		return;
+	}
+
+	for (std::size_t node = 0; node < graph.nodes.size(); ++node) {
+		graph.remaining[node].store(graph.nodes[node].numPredecessors, std::memory_order_relaxed);
+	}
+
+	TaskCounter counter(this);
+	std::vector<Task> roots;
+	roots.reserve(graph.roots.size());
+	for (const auto& root : graph.roots) {
+		roots.emplace_back([this, &graph, root, &counter]() { this->runGraphNode(graph, root, counter); });
+	}
+	this->AddTasks(std::move(roots), &counter);
+	this->WaitForCounter(counter);
+}
+
+void Scheduler::runGraphNode(TaskGraph& graph, std::size_t node, TaskCounter& counter) {
+	while (true) {
+		const auto& current = graph.nodes[node];
+		if (current.task) {
+			ENGINE_TRACE_SCOPE("scheduler", current.traceName);
+			current.task();
+		}
+
+		bool hasNext = false;
+		std::size_t next = 0;
+		for (const auto& successor : current.successors) {
+			if (graph.remaining[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+				continue;
+			}
+			if (!hasNext) {
+				next = successor;
+				hasNext = true;
+			} else {
+				this->AddTask([this, &graph, successor, &counter]() { this->runGraphNode(graph, successor, counter); }, &counter);
+			}
+		}
+		if (!hasNext) {
+			return;
+		}
+		node = next;
+	}
+}
+
+#if ENGINE_ENABLE_COROUTINES
+Scheduler::ScheduleAwaiter Scheduler::schedule() {
+	return ScheduleAwaiter(this);
+}
+
+Scheduler::FrameAwaiter Scheduler::nextFrame() {
+	return FrameAwaiter(this);
+}
+
+void Scheduler::Spawn(CoTask<> task) {
+	std::move(task).Detach();
+}
+
+std::size_t Scheduler::ResumeFrameWaiters() {
 	{
-		std::vector<ftl::Task> tasks;
-		for (std::size_t i = 0; i < funcs.size(); ++i) {
-			// Create a new task from this function
-			tasks.emplace_back({ f, &out[i] });
-		};
-		taskScheduler.AddTasks(funcs.size(), tasks.data(), &counter);
-	}
-	taskScheduler.WaitForCounter(&counter, 0);
-#else
-	std::transform(data.begin(), data.end() [&f](const input& in) {
-		return f(in);
-	}, out.begin());
+		std::lock_guard<std::mutex> lock(this->frameWaitersMutex);
+		this->resuming.swap(this->frameWaiters);
+	}
+	const std::size_t count = this->resuming.size();
+	for (auto handle : this->resuming) {
+		handle.resume();
+	}
+	this->resuming.clear();
+	return count;
+}
 #endif
-	return out;
-}*/
@@ -11,13 +11,14 @@ void Skybox::Init(Engine* engine, const CubeMap& cubemap) {
     const std::string skybox_vert =
         "#version 330 core\n"
         "layout(location = 0) in vec3 aPos;\n"
-        "out vec2 TexCoords;\n"
+        "out vec3 TexCoords;\n"
         "\n"
-        "uniform mat4 projection;\n"
+        + std::string(Renderer3D::cameraBlockSource) +
         "\n"
         "void main() {\n"
         "	TexCoords = aPos;\n"
-        "   vec4 pos = projection * view * vec4(aPos, 1.0);"
+        "   // remove translation from the view matrix\n"
+        "   vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0);\n"
         "	gl_Position = pos.xyww;\n"
         "}";
     const std::string skybox_frag =
@@ -95,16 +96,16 @@ void Skybox::Init(Engine* engine, const CubeMap& cubemap) {
     this->shader\
         .use()\
         .setInt("skybox", 0);
+    this->shader.bindUniformBlock(Renderer3D::cameraBlock, Renderer3D::cameraBinding);
 }
 
 void Skybox::Draw(Renderer3D* renderer) const noexcept {
+    ENGINE_GPU_SCOPE("Skybox::Draw");
     // draw skybox as last
     glDepthFunc(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
 
+    renderer->Upload();
     this->shader.use();
-    const auto view = glm::mat4(glm::mat3(renderer->getView())); // remove translation from the view matrix
-    this->shader.setMat4("view", view);
-    this->shader.setMat4("projection", renderer->getProjection());
     // skybox cube
     glBindVertexArray(this->VAO);
     glActiveTexture(GL_TEXTURE0);
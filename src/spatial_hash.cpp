@@ -0,0 +1,248 @@
+#include "engine/spatial_hash.hpp"
+#include "engine/scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	std::size_t nextPowerOfTwo(const std::size_t value) {
+		std::size_t result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	void sortUnique(std::vector<SpatialHash2D::Pair>& pairs) {
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+	}
+}
+
+SpatialHash2D::SpatialHash2D(const float _cellSize, const std::size_t bucketCount) : cellSize(_cellSize), inverseCellSize(1.0f / _cellSize) {
+	if (!(_cellSize > 0.0f)) {
+		throw std::invalid_argument("SpatialHash2D cell size must be positive");
+	}
+	const std::size_t numBuckets = nextPowerOfTwo(std::max<std::size_t>(bucketCount, 1));
+	this->bucketMask = numBuckets - 1;
+	this->buckets.resize(numBuckets);
+}
+
+SpatialHash2D::CellRange SpatialHash2D::cellsOf(const Aabb2D& box) const {
+	CellRange cells;
+	cells.x0 = static_cast<int>(std::floor(box.min.x * this->inverseCellSize));
+	cells.y0 = static_cast<int>(std::floor(box.min.y * this->inverseCellSize));
+	cells.x1 = static_cast<int>(std::floor(box.max.x * this->inverseCellSize));
+	cells.y1 = static_cast<int>(std::floor(box.max.y * this->inverseCellSize));
+	return cells;
+}
+
+std::size_t SpatialHash2D::bucketOf(const int x, const int y) const {
+	const auto hash = static_cast<std::uint32_t>(x) * 73856093u ^ static_cast<std::uint32_t>(y) * 19349663u;
+	return hash & this->bucketMask;
+}
+
+void SpatialHash2D::addToBuckets(const Id id, const CellRange& cells) {
+	for (int y = cells.y0; y <= cells.y1; ++y) {
+		for (int x = cells.x0; x <= cells.x1; ++x) {
+			this->buckets[this->bucketOf(x, y)].push_back(id);
+		}
+	}
+}
+
+void SpatialHash2D::removeFromBuckets(const Id id, const CellRange& cells) {
+	for (int y = cells.y0; y <= cells.y1; ++y) {
+		for (int x = cells.x0; x <= cells.x1; ++x) {
+			auto& bucket = this->buckets[this->bucketOf(x, y)];
+			const auto found = std::find(bucket.begin(), bucket.end(), id);
+			if (found != bucket.end()) {
+				*found = bucket.back();
+				bucket.pop_back();
+			}
+		}
+	}
+}
+
+void SpatialHash2D::Insert(const Id id, const Aabb2D& box) {
+	if (id >= this->entries.size()) {
+		this->entries.resize(static_cast<std::size_t>(id) + 1);
+	}
+	Entry& entry = this->entries[id];
+	if (entry.present) {
+		throw std::invalid_argument("SpatialHash2D already contains id " + std::to_string(id));
+	}
+	entry.box = box;
+	entry.cells = this->cellsOf(box);
+	entry.present = true;
+	this->addToBuckets(id, entry.cells);
+	this->count += 1;
+}
+
+void SpatialHash2D::Update(const Id id, const Aabb2D& box) {
+	if (!this->contains(id)) {
+		this->Insert(id, box);
+		return;
+	}
+	Entry& entry = this->entries[id];
+	entry.box = box;
+	const CellRange cells = this->cellsOf(box);
+	if (cells == entry.cells) {
+		return;
+	}
+	this->removeFromBuckets(id, entry.cells);
+	this->addToBuckets(id, cells);
+	entry.cells = cells;
+}
+
+void SpatialHash2D::Remove(const Id id) {
+	if (!this->contains(id)) {
+		return;
+	}
+	Entry& entry = this->entries[id];
+	this->removeFromBuckets(id, entry.cells);
+	entry.present = false;
+	this->count -= 1;
+}
+
+bool SpatialHash2D::contains(const Id id) const {
+	return id < this->entries.size() && this->entries[id].present;
+}
+
+void SpatialHash2D::Clear() {
+	for (auto& bucket : this->buckets) {
+		bucket.clear();
+	}
+	this->entries.clear();
+	this->count = 0;
+}
+
+void SpatialHash2D::Rebuild(const std::vector<Aabb2D>& boxes, Scheduler* scheduler) {
+	this->Clear();
+	this->entries.resize(boxes.size());
+	this->count = boxes.size();
+	auto describe = [this, &boxes](const std::size_t i) {
+		Entry& entry = this->entries[i];
+		entry.box = boxes[i];
+		entry.cells = this->cellsOf(boxes[i]);
+		entry.present = true;
+	};
+
+	if (!scheduler || scheduler->getNumThreads() <= 1) {
+		for (std::size_t i = 0; i < boxes.size(); ++i) {
+			describe(i);
+			this->addToBuckets(static_cast<Id>(i), this->entries[i].cells);
+		}
+		return;
+	}
+
+	// Each chunk of objects sorts its bucket entries by stripe of buckets, then each stripe is filled by one task
+	// taking the chunks in order, so no two threads touch the same bucket and ids stay in ascending order.
+	const std::size_t numChunks = scheduler->getNumThreads() * 4;
+	const std::size_t numStripes = std::min(numChunks, this->buckets.size());
+	const std::size_t chunkSize = (boxes.size() + numChunks - 1) / numChunks;
+	std::vector<std::vector<std::pair<std::size_t, Id>>> staged(numChunks * numStripes);
+	scheduler->parallel_for(0, numChunks, 1, [&](const std::size_t chunk) {
+		const std::size_t end = std::min(boxes.size(), (chunk + 1) * chunkSize);
+		for (std::size_t i = chunk * chunkSize; i < end; ++i) {
+			describe(i);
+			const CellRange& cells = this->entries[i].cells;
+			for (int y = cells.y0; y <= cells.y1; ++y) {
+				for (int x = cells.x0; x <= cells.x1; ++x) {
+					const std::size_t bucket = this->bucketOf(x, y);
+					staged[chunk * numStripes + bucket * numStripes / this->buckets.size()].emplace_back(bucket, static_cast<Id>(i));
+				}
+			}
+		}
+	});
+	scheduler->parallel_for(0, numStripes, 1, [&](const std::size_t stripe) {
+		for (std::size_t chunk = 0; chunk < numChunks; ++chunk) {
+			for (const auto& [bucket, id] : staged[chunk * numStripes + stripe]) {
+				this->buckets[bucket].push_back(id);
+			}
+		}
+	});
+}
+
+std::size_t SpatialHash2D::size() const {
+	return this->count;
+}
+
+float SpatialHash2D::getCellSize() const {
+	return this->cellSize;
+}
+
+void SpatialHash2D::QueryRegion(const Aabb2D& region, std::vector<Id>& out) const {
+	out.clear();
+	const CellRange cells = this->cellsOf(region);
+	auto scan = [this, &region, &out](const std::vector<Id>& bucket) {
+		for (const Id id : bucket) {
+			if (this->entries[id].box.Overlaps(region)) {
+				out.push_back(id);
+			}
+		}
+	};
+
+	const auto width = static_cast<std::size_t>(static_cast<std::int64_t>(cells.x1) - cells.x0 + 1);
+	const auto height = static_cast<std::size_t>(static_cast<std::int64_t>(cells.y1) - cells.y0 + 1);
+	if (width * height >= this->buckets.size()) {
+		// Covers more cells than there are buckets, cheaper to look at every bucket once.
+		for (const auto& bucket : this->buckets) {
+			scan(bucket);
+		}
+	} else {
+		for (int y = cells.y0; y <= cells.y1; ++y) {
+			for (int x = cells.x0; x <= cells.x1; ++x) {
+				scan(this->buckets[this->bucketOf(x, y)]);
+			}
+		}
+	}
+	// Boxes spanning several cells (or colliding cells) were seen more than once.
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void SpatialHash2D::collectPairs(const std::size_t begin, const std::size_t end, std::vector<Pair>& out) const {
+	for (std::size_t bucket = begin; bucket < end; ++bucket) {
+		const auto& ids = this->buckets[bucket];
+		for (std::size_t i = 0; i < ids.size(); ++i) {
+			const Entry& a = this->entries[ids[i]];
+			for (std::size_t j = i + 1; j < ids.size(); ++j) {
+				if (ids[i] == ids[j]) {
+					continue;
+				}
+				const Entry& b = this->entries[ids[j]];
+				if (!a.box.Overlaps(b.box)) {
+					continue;
+				}
+				// Both are listed in the first cell their ranges share, only report the pair from that cell's bucket.
+				if (this->bucketOf(std::max(a.cells.x0, b.cells.x0), std::max(a.cells.y0, b.cells.y0)) != bucket) {
+					continue;
+				}
+				out.emplace_back(std::min(ids[i], ids[j]), std::max(ids[i], ids[j]));
+			}
+		}
+	}
+}
+
+void SpatialHash2D::FindPairs(std::vector<Pair>& out, Scheduler* scheduler) const {
+	out.clear();
+	if (!scheduler || scheduler->getNumThreads() <= 1) {
+		this->collectPairs(0, this->buckets.size(), out);
+		sortUnique(out);
+		return;
+	}
+
+	const std::size_t numChunks = std::min(scheduler->getNumThreads() * 4, this->buckets.size());
+	const std::size_t chunkSize = (this->buckets.size() + numChunks - 1) / numChunks;
+	std::vector<std::vector<Pair>> found(numChunks);
+	scheduler->parallel_for(0, numChunks, 1, [&](const std::size_t chunk) {
+		this->collectPairs(chunk * chunkSize, std::min(this->buckets.size(), (chunk + 1) * chunkSize), found[chunk]);
+	});
+	for (const auto& pairs : found) {
+		out.insert(out.end(), pairs.begin(), pairs.end());
+	}
+	// Colliding cells can still report a pair twice.
+	sortUnique(out);
+}
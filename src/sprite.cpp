@@ -2,6 +2,7 @@
 
 #include "engine/sprite.hpp"
 #include "engine/debug.hpp"
+#include "engine/gpu_profiler.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <array>
@@ -84,6 +85,7 @@ void SpriteRenderer::initRenderData() {
 }
 
 void SpriteRenderer::DrawSprite(const Texture2D& texture, const Position2d& position, const Size& size, const float& rotate, const Colour& color) {
+	ENGINE_GPU_SCOPE("SpriteRenderer::DrawSprite");
 	// prepare transformations
 	this->shader.use();
 	glCheckError();
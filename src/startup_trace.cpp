@@ -0,0 +1,44 @@
+#include "engine/startup_trace.hpp"
+
+StartupTrace::StartupTrace() : origin(Clock::now()), mainThread(std::this_thread::get_id()) {}
+
+double StartupTrace::sinceOrigin(const Clock::time_point& time) const {
+	return std::chrono::duration<double, std::milli>(time - this->origin).count();
+}
+
+void StartupTrace::Record(const std::string& name, const Clock::time_point& start, const Clock::time_point& end) {
+	Entry entry;
+	entry.name = name;
+	entry.start = this->sinceOrigin(start);
+	entry.duration = std::chrono::duration<double, std::milli>(end - start).count();
+	entry.mainThread = std::this_thread::get_id() == this->mainThread;
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries.push_back(entry);
+}
+
+void StartupTrace::MarkFirstFrame() {
+	const auto now = Clock::now();
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->timeToFirstFrame <= 0.0) {
+		this->timeToFirstFrame = this->sinceOrigin(now);
+	}
+}
+
+double StartupTrace::getTimeToFirstFrame() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->timeToFirstFrame;
+}
+
+std::vector<StartupTrace::Entry> StartupTrace::getEntries() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->entries;
+}
+
+StartupScope::StartupScope(StartupTrace* _trace, const std::string& _name) : trace(_trace), name(_name), start(StartupTrace::Clock::now()) {}
+
+StartupScope::~StartupScope() {
+	if (this->trace) {
+		this->trace->Record(this->name, this->start, StartupTrace::Clock::now());
+	}
+}
@@ -0,0 +1,94 @@
+#include "engine/task_graph.hpp"
+#include "engine/trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+TaskGraph::NodeId TaskGraph::AddNode(const std::string& name, Task task) {
+	Node node;
+	node.name = name;
+#if ENGINE_ENABLE_TRACING
+	node.traceName = Tracer::Intern(name);
+#endif
+	node.task = std::move(task);
+	this->nodes.push_back(std::move(node));
+	this->compiled = false;
+	return this->nodes.size() - 1;
+}
+
+void TaskGraph::AddDependency(const NodeId before, const NodeId after) {
+	if (before >= this->nodes.size() || after >= this->nodes.size()) {
+		throw std::out_of_range("TaskGraph dependency on an unknown node");
+	}
+	if (before == after) {
+		throw std::invalid_argument("TaskGraph node can't depend on itself: " + this->nodes.at(before).name);
+	}
+	this->nodes.at(before).successors.push_back(after);
+	this->compiled = false;
+}
+
+void TaskGraph::Compile() {
+	const std::size_t numNodes = this->nodes.size();
+	for (auto& node : this->nodes) {
+		std::sort(node.successors.begin(), node.successors.end());
+		node.successors.erase(std::unique(node.successors.begin(), node.successors.end()), node.successors.end());
+		node.numPredecessors = 0;
+	}
+	for (const auto& node : this->nodes) {
+		for (const auto& successor : node.successors) {
+			this->nodes.at(successor).numPredecessors += 1;
+		}
+	}
+
+	// Kahn's algorithm, anything left unvisited is part of a cycle.
+	this->roots.clear();
+	this->order.clear();
+	this->order.reserve(numNodes);
+	std::vector<std::size_t> inDegree(numNodes);
+	for (NodeId id = 0; id < numNodes; ++id) {
+		inDegree.at(id) = this->nodes.at(id).numPredecessors;
+		if (inDegree.at(id) == 0) {
+			this->roots.push_back(id);
+			this->order.push_back(id);
+		}
+	}
+	for (std::size_t i = 0; i < this->order.size(); ++i) {
+		for (const auto& successor : this->nodes.at(this->order.at(i)).successors) {
+			if (--inDegree.at(successor) == 0) {
+				this->order.push_back(successor);
+			}
+		}
+	}
+	if (this->order.size() != numNodes) {
+		std::string cycle;
+		for (NodeId id = 0; id < numNodes; ++id) {
+			if (inDegree.at(id) > 0) {
+				cycle += (cycle.empty() ? "" : ", ") + this->nodes.at(id).name;
+			}
+		}
+		this->order.clear();
+		throw std::invalid_argument("TaskGraph has a dependency cycle between: " + cycle);
+	}
+
+	this->remaining = std::make_unique<std::atomic<std::size_t>[]>(numNodes);
+	this->compiled = true;
+}
+
+bool TaskGraph::isCompiled() const {
+	return this->compiled;
+}
+
+std::size_t TaskGraph::size() const {
+	return this->nodes.size();
+}
+
+const std::string& TaskGraph::getName(const NodeId node) const {
+	return this->nodes.at(node).name;
+}
+
+const std::vector<TaskGraph::NodeId>& TaskGraph::getExecutionOrder() const {
+	if (!this->compiled) {
+		throw std::logic_error("TaskGraph must be compiled before it has an execution order");
+	}
+	return this->order;
+}
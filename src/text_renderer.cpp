@@ -160,6 +160,8 @@ void TextRenderer::Load([[maybe_unused]] const std::string& font, [[maybe_unused
 
 void TextRenderer::RenderText([[maybe_unused]] Engine* engine, [[maybe_unused]] const std::string& text, [[maybe_unused]] const Position2d& pos, [[maybe_unused]] const float& scale, [[maybe_unused]] const Colour& color) {
 #if ENGINE_ENABLE_TEXT
+	ENGINE_GPU_SCOPE("TextRenderer::RenderText");
+
 	// activate corresponding render state
 	this->shader.use().\
 		setVec3(output_colour_var, color.to_vec3());
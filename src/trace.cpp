@@ -0,0 +1,315 @@
+#include "engine/trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+std::atomic<bool> Tracer::enabled{false};
+
+namespace {
+	const Tracer::Clock::time_point& origin() {
+		static const Tracer::Clock::time_point start = Tracer::Clock::now();
+		return start;
+	}
+
+	std::int64_t sinceOrigin(const Tracer::Clock::time_point& time) {
+		return std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin()).count(), 0);
+	}
+
+	// Written by the owning thread under a per-slot sequence lock, so WriteChromeTrace can read while it records.
+	struct Slot {
+		std::atomic<std::uint64_t> seq{0};
+		std::atomic<const char*> category{nullptr};
+		std::atomic<const char*> name{nullptr};
+		std::atomic<const char*> detail{nullptr};
+		std::atomic<std::int64_t> start{0};
+		// Negative for instant events
+		std::atomic<std::int64_t> duration{0};
+	};
+
+	struct ThreadBuffer {
+		std::uint32_t tid = 0;
+		// Guarded by the registry mutex
+		std::string name;
+
+		// Allocated by the owner on its first event, so threads that are only named stay cheap.
+		std::unique_ptr<Slot[]> storage;
+		std::atomic<Slot*> slots{nullptr};
+		std::size_t capacity = 0;
+
+		// Session the events belong to, and how many the owner has written in it.
+		std::atomic<std::uint64_t> session{0};
+		std::atomic<std::uint64_t> written{0};
+	};
+
+	struct Registry {
+		std::mutex mutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		std::unordered_set<std::string> interned;
+		std::uint32_t nextTid = 1;
+		std::atomic<std::size_t> capacity{0};
+		// Bumped by every Start, buffers from an older session are reset lazily by their owner.
+		std::atomic<std::uint64_t> session{0};
+		// BeginSession calls without their EndSession
+		std::size_t openSessions = 0;
+	};
+
+	Registry& registry() {
+		static Registry instance;
+		return instance;
+	}
+
+	ThreadBuffer& localBuffer() {
+		thread_local std::shared_ptr<ThreadBuffer> buffer;
+		if (!buffer) {
+			Registry& r = registry();
+			auto created = std::make_shared<ThreadBuffer>();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			created->tid = r.nextTid++;
+			r.buffers.push_back(created);
+			buffer = std::move(created);
+		}
+		return *buffer;
+	}
+
+	// Tags a slot with its session and index, even once written.
+	std::uint64_t slotSequence(const std::uint64_t session, const std::uint64_t index) {
+		return ((session << 40) | (index + 1)) << 1;
+	}
+
+	void record(const char* category, const char* name, const char* detail, const std::int64_t start, const std::int64_t duration) noexcept {
+		if (!Tracer::isEnabled()) {
+			return;
+		}
+		Registry& r = registry();
+		ThreadBuffer* buffer = nullptr;
+		try {
+			buffer = &localBuffer();
+			if (buffer->slots.load(std::memory_order_relaxed) == nullptr) {
+				buffer->capacity = r.capacity.load();
+				buffer->storage = std::make_unique<Slot[]>(buffer->capacity);
+				buffer->slots.store(buffer->storage.get(), std::memory_order_release);
+			}
+		} catch (...) {
+			// Out of memory, drop the event rather than take the game down.
+			return;
+		}
+
+		const std::uint64_t session = r.session.load(std::memory_order_acquire);
+		std::uint64_t index = buffer->written.load(std::memory_order_relaxed);
+		if (buffer->session.load(std::memory_order_relaxed) != session) {
+			index = 0;
+			buffer->written.store(0, std::memory_order_relaxed);
+			buffer->session.store(session, std::memory_order_release);
+		}
+
+		Slot& slot = buffer->storage[index % buffer->capacity];
+		const std::uint64_t seq = slotSequence(session, index);
+		slot.seq.store(seq - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.category.store(category, std::memory_order_relaxed);
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.detail.store(detail, std::memory_order_relaxed);
+		slot.start.store(start, std::memory_order_relaxed);
+		slot.duration.store(duration, std::memory_order_relaxed);
+		slot.seq.store(seq, std::memory_order_release);
+		buffer->written.store(index + 1, std::memory_order_release);
+	}
+
+	struct Event {
+		const char* category;
+		const char* name;
+		const char* detail;
+		std::int64_t start;
+		std::int64_t duration;
+	};
+
+	void writeString(std::ostream& out, const char* text) {
+		static const char hex[] = "0123456789abcdef";
+		out << '"';
+		for (const char* c = text ? text : ""; *c != '\0'; ++c) {
+			const auto byte = static_cast<unsigned char>(*c);
+			if (byte == '"' || byte == '\\') {
+				out << '\\' << *c;
+			} else if (byte < 0x20) {
+				out << "\\u00" << hex[byte >> 4] << hex[byte & 0xF];
+			} else {
+				out << *c;
+			}
+		}
+		out << '"';
+	}
+
+	// Trace timestamps are microseconds, keep the nanoseconds as a fraction.
+	void writeMicroseconds(std::ostream& out, const std::int64_t nanos) {
+		const std::int64_t fraction = nanos % 1000;
+		out << nanos / 1000 << '.' << (fraction < 100 ? "0" : "") << (fraction < 10 ? "0" : "") << fraction;
+	}
+
+	// Caller holds the registry mutex.
+	void newSession(Registry& r, const std::size_t eventsPerThread) {
+		if (r.capacity.load() == 0) {
+			r.capacity.store(std::max<std::size_t>(eventsPerThread, 1));
+		}
+		// Threads that have exited only live on in the registry, their events belong to the old session.
+		r.buffers.erase(std::remove_if(r.buffers.begin(), r.buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer) {
+			return buffer.use_count() == 1;
+		}), r.buffers.end());
+		r.session.fetch_add(1);
+	}
+}
+
+void Tracer::Start(const std::size_t eventsPerThread) {
+	Registry& r = registry();
+	origin();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	newSession(r, eventsPerThread);
+	enabled.store(true);
+}
+
+void Tracer::Stop() {
+	enabled.store(false);
+}
+
+void Tracer::BeginSession(const std::size_t eventsPerThread) {
+	Registry& r = registry();
+	origin();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	if (r.openSessions++ == 0) {
+		newSession(r, eventsPerThread);
+		enabled.store(true);
+	}
+}
+
+void Tracer::EndSession() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	if (r.openSessions > 0 && --r.openSessions == 0) {
+		enabled.store(false);
+	}
+}
+
+void Tracer::Complete(const char* category, const char* name, const Clock::time_point& start, const Clock::time_point& end, const char* detail) noexcept {
+	const std::int64_t begin = sinceOrigin(start);
+	record(category, name, detail, begin, std::max<std::int64_t>(sinceOrigin(end) - begin, 0));
+}
+
+void Tracer::Instant(const char* category, const char* name, const char* detail) noexcept {
+	record(category, name, detail, sinceOrigin(Clock::now()), -1);
+}
+
+void Tracer::SetThreadName(const std::string& name) {
+	ThreadBuffer& buffer = localBuffer();
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	buffer.name = name;
+}
+
+const char* Tracer::Intern(const std::string& text) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	return r.interned.insert(text).first->c_str();
+}
+
+void Tracer::WriteChromeTrace(std::ostream& out, const Clock::duration& window) {
+	Registry& r = registry();
+	struct Track {
+		std::shared_ptr<ThreadBuffer> buffer;
+		std::string name;
+	};
+	std::vector<Track> tracks;
+	{
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (const auto& buffer : r.buffers) {
+			tracks.push_back({ buffer, buffer->name });
+		}
+	}
+	const std::uint64_t session = r.session.load(std::memory_order_acquire);
+	const std::int64_t cutoff = window > Clock::duration::zero() ? sinceOrigin(Clock::now() - window) : 0;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"engine\"}}";
+	std::vector<Event> events;
+	for (const auto& track : tracks) {
+		ThreadBuffer& buffer = *track.buffer;
+		if (!track.name.empty()) {
+			out << ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.tid << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+			writeString(out, track.name.c_str());
+			out << "}}";
+		}
+
+		const Slot* slots = buffer.slots.load(std::memory_order_acquire);
+		if (slots == nullptr || buffer.session.load(std::memory_order_acquire) != session) {
+			continue;
+		}
+		const std::uint64_t written = buffer.written.load(std::memory_order_acquire);
+		const std::uint64_t first = written > buffer.capacity ? written - buffer.capacity : 0;
+		events.clear();
+		for (std::uint64_t index = first; index < written; ++index) {
+			const Slot& slot = slots[index % buffer.capacity];
+			const std::uint64_t expected = slotSequence(session, index);
+			if (slot.seq.load(std::memory_order_acquire) != expected) {
+				continue;
+			}
+			Event event;
+			event.category = slot.category.load(std::memory_order_relaxed);
+			event.name = slot.name.load(std::memory_order_relaxed);
+			event.detail = slot.detail.load(std::memory_order_relaxed);
+			event.start = slot.start.load(std::memory_order_relaxed);
+			event.duration = slot.duration.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// Overwritten while we were reading it
+			if (slot.seq.load(std::memory_order_relaxed) != expected) {
+				continue;
+			}
+			if (event.start + std::max<std::int64_t>(event.duration, 0) >= cutoff) {
+				events.push_back(event);
+			}
+		}
+
+		for (const auto& event : events) {
+			out << ",\n{\"ph\":\"" << (event.duration < 0 ? "i\",\"s\":\"t" : "X") << "\",\"pid\":1,\"tid\":" << buffer.tid << ",\"cat\":";
+			writeString(out, event.category);
+			out << ",\"name\":";
+			writeString(out, event.name);
+			out << ",\"ts\":";
+			writeMicroseconds(out, event.start);
+			if (event.duration >= 0) {
+				out << ",\"dur\":";
+				writeMicroseconds(out, event.duration);
+			}
+			if (event.detail) {
+				out << ",\"args\":{\"detail\":";
+				writeString(out, event.detail);
+				out << "}";
+			}
+			out << "}";
+		}
+	}
+	out << "\n]}" << std::endl;
+}
+
+bool Tracer::WriteChromeTrace(const std::string& path, const Clock::duration& window) {
+	std::ofstream out(path);
+	if (!out.good()) {
+		return false;
+	}
+	WriteChromeTrace(out, window);
+	return out.good();
+}
+
+TraceScope::TraceScope(const char* _category, const char* _name, const char* _detail) noexcept : category(_category), name(_name), detail(_detail), active(Tracer::isEnabled()) {
+	if (this->active) {
+		this->start = Tracer::Clock::now();
+	}
+}
+
+TraceScope::~TraceScope() {
+	if (this->active) {
+		Tracer::Complete(this->category, this->name, this->start, Tracer::Clock::now(), this->detail);
+	}
+}
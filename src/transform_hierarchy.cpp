@@ -0,0 +1,282 @@
+#include "engine/transform_hierarchy.hpp"
+#include "engine/scheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	// Subtrees smaller than this aren't split further, nor are whole updates run in parallel below it.
+	constexpr std::size_t minParallelNodes = 1024;
+}
+
+glm::mat4 Transform::toMatrix() const {
+	glm::mat4 matrix = glm::mat4_cast(this->rotation);
+	matrix[0] = matrix[0] * this->scale.x;
+	matrix[1] = matrix[1] * this->scale.y;
+	matrix[2] = matrix[2] * this->scale.z;
+	matrix[3] = glm::vec4(this->translation, 1.0f);
+	return matrix;
+}
+
+const TransformHierarchy::Link& TransformHierarchy::checkedLink(const NodeId node) const {
+	if (!this->isAlive(node)) {
+		throw std::out_of_range("TransformHierarchy has no node " + std::to_string(node));
+	}
+	return this->links[node];
+}
+
+TransformHierarchy::NodeId TransformHierarchy::Create(const Transform& local, const NodeId parent) {
+	if (parent != nullNode) {
+		this->checkedLink(parent);
+	}
+	NodeId node;
+	if (this->freeIds.empty()) {
+		node = static_cast<NodeId>(this->links.size());
+		this->links.emplace_back();
+	} else {
+		node = this->freeIds.back();
+		this->freeIds.pop_back();
+		this->links[node] = Link();
+	}
+	Link& link = this->links[node];
+	link.alive = true;
+	link.index = static_cast<std::uint32_t>(this->order.size());
+	this->attach(node, parent);
+
+	this->order.push_back(node);
+	this->parentIndex.push_back(noParent);
+	this->subtreeEnd.push_back(link.index + 1);
+	this->locals.push_back(local);
+	this->worlds.emplace_back(1.0f);
+	this->dirty.push_back(1);
+	this->changed.push_back(0);
+	this->count += 1;
+	this->orderChanged = true;
+	return node;
+}
+
+void TransformHierarchy::Destroy(const NodeId node) {
+	this->checkedLink(node);
+	this->detach(node);
+	// The entries stay in the arrays until the next Update rebuilds them without dead nodes.
+	std::vector<NodeId> stack{ node };
+	while (!stack.empty()) {
+		const NodeId next = stack.back();
+		stack.pop_back();
+		Link& link = this->links[next];
+		for (NodeId child = link.firstChild; child != nullNode; child = this->links[child].nextSibling) {
+			stack.push_back(child);
+		}
+		link.alive = false;
+		this->freeIds.push_back(next);
+		this->count -= 1;
+	}
+	this->orderChanged = true;
+}
+
+void TransformHierarchy::SetParent(const NodeId node, const NodeId parent) {
+	const Link& link = this->checkedLink(node);
+	if (link.parent == parent) {
+		return;
+	}
+	for (NodeId ancestor = parent; ancestor != nullNode; ancestor = this->checkedLink(ancestor).parent) {
+		if (ancestor == node) {
+			throw std::invalid_argument("TransformHierarchy node " + std::to_string(node) + " can't be parented below itself");
+		}
+	}
+	this->detach(node);
+	this->attach(node, parent);
+	this->dirty[this->links[node].index] = 1;
+	this->orderChanged = true;
+}
+
+bool TransformHierarchy::isAlive(const NodeId node) const {
+	return node < this->links.size() && this->links[node].alive;
+}
+
+std::size_t TransformHierarchy::size() const {
+	return this->count;
+}
+
+TransformHierarchy::NodeId TransformHierarchy::getParent(const NodeId node) const {
+	return this->checkedLink(node).parent;
+}
+
+const Transform& TransformHierarchy::getLocal(const NodeId node) const {
+	return this->locals[this->checkedLink(node).index];
+}
+
+void TransformHierarchy::setLocal(const NodeId node, const Transform& local) {
+	const std::uint32_t index = this->checkedLink(node).index;
+	this->locals[index] = local;
+	this->dirty[index] = 1;
+}
+
+const glm::mat4& TransformHierarchy::getWorld(const NodeId node) const {
+	return this->worlds[this->checkedLink(node).index];
+}
+
+bool TransformHierarchy::isWorldChanged(const NodeId node) const {
+	return this->changed[this->checkedLink(node).index] != 0;
+}
+
+const std::vector<TransformHierarchy::NodeId>& TransformHierarchy::getOrder() const {
+	return this->order;
+}
+
+void TransformHierarchy::attach(const NodeId node, const NodeId parent) {
+	Link& link = this->links[node];
+	link.parent = parent;
+	link.nextSibling = nullNode;
+	NodeId& first = parent == nullNode ? this->firstRoot : this->links[parent].firstChild;
+	NodeId& last = parent == nullNode ? this->lastRoot : this->links[parent].lastChild;
+	link.previousSibling = last;
+	if (last == nullNode) {
+		first = node;
+	} else {
+		this->links[last].nextSibling = node;
+	}
+	last = node;
+}
+
+void TransformHierarchy::detach(const NodeId node) {
+	Link& link = this->links[node];
+	NodeId& first = link.parent == nullNode ? this->firstRoot : this->links[link.parent].firstChild;
+	NodeId& last = link.parent == nullNode ? this->lastRoot : this->links[link.parent].lastChild;
+	if (link.previousSibling == nullNode) {
+		first = link.nextSibling;
+	} else {
+		this->links[link.previousSibling].nextSibling = link.nextSibling;
+	}
+	if (link.nextSibling == nullNode) {
+		last = link.previousSibling;
+	} else {
+		this->links[link.nextSibling].previousSibling = link.previousSibling;
+	}
+	link.parent = nullNode;
+	link.previousSibling = nullNode;
+	link.nextSibling = nullNode;
+}
+
+void TransformHierarchy::rebuildOrder() {
+	std::vector<NodeId> newOrder;
+	newOrder.reserve(this->count);
+	std::vector<NodeId> stack;
+	for (NodeId root = this->firstRoot; root != nullNode; root = this->links[root].nextSibling) {
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const NodeId node = stack.back();
+			stack.pop_back();
+			newOrder.push_back(node);
+			// Reversed, so children come out in the order they were added.
+			for (NodeId child = this->links[node].lastChild; child != nullNode; child = this->links[child].previousSibling) {
+				stack.push_back(child);
+			}
+		}
+	}
+
+	std::vector<std::uint32_t> newParentIndex(newOrder.size());
+	std::vector<std::uint32_t> newSubtreeEnd(newOrder.size());
+	std::vector<Transform> newLocals(newOrder.size());
+	std::vector<glm::mat4> newWorlds(newOrder.size());
+	std::vector<std::uint8_t> newDirty(newOrder.size());
+	for (std::size_t i = 0; i < newOrder.size(); ++i) {
+		Link& link = this->links[newOrder[i]];
+		newLocals[i] = this->locals[link.index];
+		newWorlds[i] = this->worlds[link.index];
+		newDirty[i] = this->dirty[link.index];
+		newSubtreeEnd[i] = static_cast<std::uint32_t>(i + 1);
+		link.index = static_cast<std::uint32_t>(i);
+		// Parents come first, so theirs is already updated.
+		newParentIndex[i] = link.parent == nullNode ? noParent : this->links[link.parent].index;
+	}
+	for (std::size_t i = newOrder.size(); i-- > 0;) {
+		if (newParentIndex[i] != noParent) {
+			newSubtreeEnd[newParentIndex[i]] = std::max(newSubtreeEnd[newParentIndex[i]], newSubtreeEnd[i]);
+		}
+	}
+
+	this->order = std::move(newOrder);
+	this->parentIndex = std::move(newParentIndex);
+	this->subtreeEnd = std::move(newSubtreeEnd);
+	this->locals = std::move(newLocals);
+	this->worlds = std::move(newWorlds);
+	this->dirty = std::move(newDirty);
+	this->changed.assign(this->order.size(), 0);
+	this->orderChanged = false;
+	this->plannedThreads = 0;
+}
+
+void TransformHierarchy::planRanges(const std::size_t numThreads) {
+	// Several tasks per thread evens out uneven subtrees. A subtree too big for one task is split into its children's
+	// subtrees, its own node goes to `heads` to be done before them.
+	const std::size_t target = std::max(minParallelNodes, this->order.size() / (numThreads * 4));
+	this->heads.clear();
+	this->ranges.clear();
+	std::vector<std::uint32_t> stack;
+	for (NodeId root = this->lastRoot; root != nullNode; root = this->links[root].previousSibling) {
+		stack.push_back(this->links[root].index);
+	}
+	while (!stack.empty()) {
+		const std::uint32_t index = stack.back();
+		stack.pop_back();
+		const std::uint32_t end = this->subtreeEnd[index];
+		if (end - index <= target) {
+			// Neighbouring small subtrees share a task.
+			if (!this->ranges.empty() && this->ranges.back().end == index && end - this->ranges.back().begin <= target) {
+				this->ranges.back().end = end;
+			} else {
+				this->ranges.push_back({ index, end });
+			}
+			continue;
+		}
+		this->heads.push_back(index);
+		const std::size_t firstChild = stack.size();
+		for (std::uint32_t child = index + 1; child < end; child = this->subtreeEnd[child]) {
+			stack.push_back(child);
+		}
+		std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(firstChild), stack.end());
+	}
+	this->plannedThreads = numThreads;
+}
+
+void TransformHierarchy::updateNode(const std::uint32_t index) {
+	const std::uint32_t parent = this->parentIndex[index];
+	const bool parentChanged = parent != noParent && this->changed[parent];
+	if (!this->dirty[index] && !parentChanged) {
+		this->changed[index] = 0;
+		return;
+	}
+	const glm::mat4 local = this->locals[index].toMatrix();
+	this->worlds[index] = parent == noParent ? local : this->worlds[parent] * local;
+	this->dirty[index] = 0;
+	this->changed[index] = 1;
+}
+
+void TransformHierarchy::updateRange(const std::uint32_t begin, const std::uint32_t end) {
+	for (std::uint32_t i = begin; i < end; ++i) {
+		this->updateNode(i);
+	}
+}
+
+void TransformHierarchy::Update(Scheduler* scheduler) {
+	if (this->orderChanged) {
+		this->rebuildOrder();
+	}
+	const auto size = static_cast<std::uint32_t>(this->order.size());
+	if (!scheduler || scheduler->getNumThreads() <= 1 || size < minParallelNodes) {
+		this->updateRange(0, size);
+		return;
+	}
+
+	if (this->plannedThreads != scheduler->getNumThreads()) {
+		this->planRanges(scheduler->getNumThreads());
+	}
+	for (const std::uint32_t head : this->heads) {
+		this->updateNode(head);
+	}
+	scheduler->parallel_for(0, this->ranges.size(), 1, [this](const std::size_t i) {
+		this->updateRange(this->ranges[i].begin, this->ranges[i].end);
+	});
+}
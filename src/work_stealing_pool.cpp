@@ -0,0 +1,243 @@
+#include "engine/work_stealing_pool.hpp"
+#include "engine/trace.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#if ENGINE_OS == ENGINE_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#elif ENGINE_OS == ENGINE_OS_WIN32
+#include <windows.h>
+#endif
+
+namespace {
+	// Lets Submit/RunOne find the calling worker's own deque.
+	thread_local WorkStealingPool* currentPool = nullptr;
+	thread_local std::size_t currentWorker = 0;
+
+	// Spins before a worker goes to sleep, waking a sleeping thread costs far more than a few empty scans.
+	constexpr int idleSpins = 64;
+
+	// An exception escaping a worker thread would terminate the process. Scheduler keeps those of counted tasks
+	// for WaitForCounter, so only fire and forget tasks get here.
+	void Run(WorkStealingPool::Task& task) {
+		ENGINE_TRACE_SCOPE("scheduler", "Task");
+		try {
+			task();
+		} catch (const std::exception& e) {
+			std::cerr << "Uncaught exception in worker task: " << e.what() << std::endl;
+		} catch (...) {
+			std::cerr << "Uncaught exception in worker task" << std::endl;
+		}
+	}
+
+	std::uint32_t xorshift(std::uint32_t& state) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+}
+
+WorkStealingPool::WorkStealingPool(const Options& options) {
+	const std::size_t hardwareThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	std::size_t numWorkers = options.numWorkers;
+	if (numWorkers == 0) {
+		numWorkers = options.reserveMainThread ? std::max<std::size_t>(hardwareThreads - 1, 1) : hardwareThreads;
+	}
+
+	this->workers.reserve(numWorkers);
+	for (std::size_t i = 0; i < numWorkers; ++i) {
+		this->workers.push_back(std::make_unique<Worker>());
+		this->workers.back()->rng = static_cast<std::uint32_t>(i * 2654435761u + 1);
+	}
+
+	for (std::size_t i = 0; i < numWorkers; ++i) {
+		int cpu = -1;
+		if (options.pinWorkers) {
+			if (!options.cpus.empty()) {
+				cpu = static_cast<int>(options.cpus.at(i % options.cpus.size()));
+			} else {
+				// CPU 0 is left to the main thread when it is reserved.
+				const std::size_t first = options.reserveMainThread ? 1 : 0;
+				cpu = static_cast<int>((first + i) % hardwareThreads);
+			}
+		}
+		this->workers.at(i)->thread = std::thread([this, i, cpu]() {
+			if (cpu >= 0 && !PinCurrentThread(static_cast<unsigned int>(cpu))) {
+#if ENGINE_DEBUG
+				std::cout << "Failed to pin worker " << i << " to CPU " << cpu << std::endl;
+#endif
+			}
+			this->workerLoop(i);
+		});
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+		this->stopping.store(true);
+		this->epoch.fetch_add(1);
+	}
+	this->sleepCv.notify_all();
+	for (auto& worker : this->workers) {
+		worker->thread.join();
+	}
+
+	// Drop anything that never ran.
+	for (auto& worker : this->workers) {
+		while (Task* task = worker->deque.Take()) {
+			delete task;
+		}
+	}
+	for (Task* task : this->injection) {
+		delete task;
+	}
+}
+
+std::size_t WorkStealingPool::getNumWorkers() const {
+	return this->workers.size();
+}
+
+bool WorkStealingPool::PinCurrentThread([[maybe_unused]] const unsigned int cpu) {
+#if ENGINE_OS == ENGINE_OS_LINUX
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif ENGINE_OS == ENGINE_OS_WIN32
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+	// macOS only has affinity hints
+	return false;
+#endif
+}
+
+void WorkStealingPool::Submit(Task task) {
+	std::vector<Task> tasks;
+	tasks.push_back(std::move(task));
+	this->Submit(tasks);
+}
+
+void WorkStealingPool::Submit(std::vector<Task>& tasks) {
+	if (tasks.empty()) {
+		return;
+	}
+	if (currentPool == this) {
+		auto& deque = this->workers.at(currentWorker)->deque;
+		for (auto& task : tasks) {
+			deque.Push(new Task(std::move(task)));
+		}
+	} else {
+		std::lock_guard<std::mutex> lock(this->injectionMutex);
+		for (auto& task : tasks) {
+			this->injection.push_back(new Task(std::move(task)));
+		}
+		this->injectionSize.store(this->injection.size());
+	}
+	this->wake(tasks.size());
+}
+
+void WorkStealingPool::wake(const std::size_t count) {
+	if (this->sleepers.load() == 0) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+		this->epoch.fetch_add(1);
+	}
+	if (count == 1) {
+		this->sleepCv.notify_one();
+	} else {
+		this->sleepCv.notify_all();
+	}
+}
+
+WorkStealingPool::Task* WorkStealingPool::popInjection() {
+	if (this->injectionSize.load(std::memory_order_relaxed) == 0) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock(this->injectionMutex);
+	if (this->injection.empty()) {
+		return nullptr;
+	}
+	Task* task = this->injection.front();
+	this->injection.pop_front();
+	this->injectionSize.store(this->injection.size());
+	return task;
+}
+
+WorkStealingPool::Task* WorkStealingPool::findTask(Worker* self, std::uint32_t& rng) {
+	if (self != nullptr) {
+		if (Task* task = self->deque.Take()) {
+			return task;
+		}
+	}
+	if (Task* task = this->popInjection()) {
+		return task;
+	}
+
+	// Start at a random victim so thieves spread out.
+	const std::size_t numWorkers = this->workers.size();
+	const std::size_t start = xorshift(rng) % numWorkers;
+	for (std::size_t i = 0; i < numWorkers; ++i) {
+		Worker* victim = this->workers[(start + i) % numWorkers].get();
+		if (victim == self) {
+			continue;
+		}
+		if (Task* task = victim->deque.Steal()) {
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+bool WorkStealingPool::RunOne() {
+	static thread_local std::uint32_t rng = static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+	Worker* self = currentPool == this ? this->workers.at(currentWorker).get() : nullptr;
+	std::unique_ptr<Task> task(this->findTask(self, self ? self->rng : rng));
+	if (!task) {
+		return false;
+	}
+	Run(*task);
+	return true;
+}
+
+void WorkStealingPool::workerLoop(const std::size_t index) {
+	currentPool = this;
+	currentWorker = index;
+	Worker* self = this->workers.at(index).get();
+	ENGINE_TRACE_THREAD_NAME("Worker " + std::to_string(index));
+
+	int spins = 0;
+	while (!this->stopping.load(std::memory_order_relaxed)) {
+		if (std::unique_ptr<Task> task{ this->findTask(self, self->rng) }) {
+			Run(*task);
+			spins = 0;
+			continue;
+		}
+		if (++spins < idleSpins) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Announce we're about to sleep before the last look, so a Submit racing with us either sees a sleeper or we see its task.
+		this->sleepers.fetch_add(1);
+		const auto seenEpoch = this->epoch.load();
+		if (std::unique_ptr<Task> task{ this->findTask(self, self->rng) }) {
+			this->sleepers.fetch_sub(1);
+			Run(*task);
+			spins = 0;
+			continue;
+		}
+		{
+			std::unique_lock<std::mutex> lock(this->sleepMutex);
+			this->sleepCv.wait(lock, [this, seenEpoch]() { return this->epoch.load() != seenEpoch; });
+		}
+		this->sleepers.fetch_sub(1);
+		spins = 0;
+	}
+	currentPool = nullptr;
+}
@@ -4,9 +4,1008 @@
 #include <engine/engine.hpp>
 #include <constants/screen_size.hpp>
 #include <engine/game.hpp>
+#include <engine/profiler.hpp>
+#include <engine/frame_pacer.hpp>
+#include <engine/input_queue.hpp>
+#include <engine/scheduler.hpp>
+#include <engine/task_graph.hpp>
+#include <engine/frame_arena.hpp>
+#include <engine/gl_command_queue.hpp>
+#include <engine/trace.hpp>
+#include <engine/entity_registry.hpp>
+#include <engine/game_object.hpp>
+#include <engine/game_object_inst.hpp>
+#include <engine/kinematics.hpp>
+#include <engine/spatial_hash.hpp>
+#include <engine/bvh.hpp>
+#include <engine/transform_hierarchy.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 TEST_CASE("startup", "[engine]") {
 	const ScreenSize size { 800, 600 };
 	std::shared_ptr<Game> g = std::make_shared<Game>(size, "test_engine");
 	Engine e{g};
 }
+
+// Headless still opens a (hidden) window, so this needs a display, e.g. run under xvfb-run on CI.
+TEST_CASE("headless fixed frame run", "[engine][headless]") {
+	const ScreenSize size { 320, 240 };
+	std::shared_ptr<Game> g = std::make_shared<Game>(size, "test_engine_headless");
+	auto config = EngineConfig::Headless(30);
+	config.summaryPath = "test_engine_headless.json";
+	Engine e{g, config};
+	e.run();
+
+	REQUIRE(e.getFrameNumber() == 30);
+	// Audio starts on the first sound, none were loaded.
+	REQUIRE_FALSE(e.getAudioEngine()->isInitialized());
+	REQUIRE(e.getStartupTrace().getTimeToFirstFrame() > 0.0);
+#if ENGINE_ENABLE_PROFILING
+	REQUIRE(e.getFrameStats(FramePhase::Frame).samples == 30);
+#endif
+}
+
+TEST_CASE("concurrent simulation engines", "[engine][simulation]") {
+	const ScreenSize size { 320, 240 };
+	constexpr std::size_t numEngines = 4;
+	std::vector<std::unique_ptr<Engine>> engines;
+	for (std::size_t i = 0; i < numEngines; ++i) {
+		auto config = EngineConfig::Simulation(1000);
+		config.summaryPath = "test_engine_simulation_" + std::to_string(i) + ".json";
+		engines.push_back(std::make_unique<Engine>(std::make_shared<Game>(size, "test_engine_simulation"), config));
+	}
+
+	std::vector<std::thread> threads;
+	for (auto& engine : engines) {
+		threads.emplace_back([&engine]() { engine->run(); });
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (const auto& engine : engines) {
+		REQUIRE_FALSE(engine->isRendering());
+		REQUIRE(engine->getFrameNumber() == 1000);
+		const auto startup = engine->getStartupTrace().getEntries();
+		REQUIRE(startup.size() == 1);
+		REQUIRE(startup.front().name == "Game::Init");
+	}
+}
+
+TEST_CASE("profiler stats", "[profiler]") {
+	Profiler profiler{ 100 };
+	for (int i = 1; i <= 200; ++i) {
+		profiler.AddPhase(FramePhase::Update, std::chrono::milliseconds(i));
+		profiler.EndFrame();
+	}
+
+	// Only the last 100 frames (101ms - 200ms) are kept.
+	const auto stats = profiler.getPhaseStats(FramePhase::Update);
+	REQUIRE(stats.samples == 100);
+	REQUIRE(stats.min == Approx(101.0));
+	REQUIRE(stats.max == Approx(200.0));
+	REQUIRE(stats.avg == Approx(150.5));
+	REQUIRE(stats.p95 == Approx(195.0));
+	REQUIRE(stats.p99 == Approx(199.0));
+
+	const auto zone = Profiler::RegisterZone("test_zone");
+	profiler.AddZone(zone, std::chrono::milliseconds(4));
+	profiler.EndFrame();
+	REQUIRE(profiler.getZoneStats("test_zone").samples == 1);
+	REQUIRE(profiler.getZoneStats("test_zone").avg == Approx(4.0));
+}
+
+TEST_CASE("frame pacer holds target rate", "[pacing]") {
+	FramePacer pacer;
+	REQUIRE_FALSE(pacer.isEnabled());
+	pacer.setTargetFps(200.0);
+	REQUIRE(pacer.isEnabled());
+
+	// The first Wait only starts the cadence.
+	for (int i = 0; i < 21; ++i) {
+		pacer.Wait();
+	}
+
+	const auto frameTimes = pacer.getFrameTimeStats();
+	REQUIRE(frameTimes.samples == 20);
+	REQUIRE(frameTimes.avg >= 4.5);
+	REQUIRE(pacer.getDeviationStats().samples == 20);
+	REQUIRE_THROWS(pacer.setTargetFps(-1.0));
+}
+
+namespace {
+	class InputCountingGame : public Game {
+	public:
+		using Game::Game;
+		int presses = 0;
+		int releases = 0;
+		void pressed([[maybe_unused]] const int key) noexcept override { this->presses += 1; }
+		void released([[maybe_unused]] const int key) noexcept override { this->releases += 1; }
+	};
+}
+
+TEST_CASE("queued input is dispatched before update", "[engine][input]") {
+	const ScreenSize size { 320, 240 };
+	auto game = std::make_shared<InputCountingGame>(size, "test_engine_input");
+	Engine e{game, EngineConfig::Simulation(1)};
+
+	InputEvent event;
+	event.key = GLFW_KEY_A;
+	event.action = GLFW_PRESS;
+	event.timestamp = Profiler::Clock::now();
+	REQUIRE(e.pushInput(event));
+	event.key = -1;
+	REQUIRE_FALSE(e.pushInput(event));
+	// Nothing reaches the game until the next simulation tick.
+	REQUIRE(game->presses == 0);
+
+	e.run();
+	REQUIRE(game->presses == 1);
+	REQUIRE(game->Keys[GLFW_KEY_A]);
+
+	InputQueue queue;
+	for (std::size_t i = 0; i < InputQueue::Capacity; ++i) {
+		REQUIRE(queue.Push(event));
+	}
+	REQUIRE_FALSE(queue.Push(event));
+	REQUIRE(queue.getDropped() == 1);
+}
+
+TEST_CASE("async texture loads are refused in simulation mode", "[engine][simulation]") {
+	const ScreenSize size { 320, 240 };
+	Engine e{std::make_shared<Game>(size, "test_engine_async_texture"), EngineConfig::Simulation(1)};
+	// Nothing would ever drain the upload, the future could never be ready.
+	REQUIRE_THROWS_AS(e.getResourceManager()->LoadTextureAsync("missing.png", "missing", false), std::logic_error);
+}
+
+namespace {
+	class TickCountingGame : public Game {
+	public:
+		using Game::Game;
+		std::vector<double> ticks;
+		void Update(const double& dt) noexcept override { this->ticks.push_back(dt); }
+	};
+}
+
+TEST_CASE("fixed timestep ticks at the fixed rate and caps catch up", "[engine][simulation]") {
+	const ScreenSize size { 320, 240 };
+	// Powers of two, so the accumulator is exact and the tick counts can't be off by one.
+	constexpr double step = 1.0 / 64.0;
+
+	// 2.5 steps per frame: 2, 3 then 2 ticks, half a step left over.
+	auto game = std::make_shared<TickCountingGame>(size, "test_engine_fixed_timestep");
+	Engine e{game, EngineConfig::Simulation(3, 2.5 * step)};
+	e.setFixedTimestep(64.0, 4);
+	REQUIRE(e.getFixedTimestep() == Approx(step));
+	e.run();
+	REQUIRE(game->ticks.size() == 7);
+	for (const double dt : game->ticks) {
+		REQUIRE(dt == Approx(step));
+	}
+	REQUIRE(e.getInterpolationAlpha() == Approx(0.5));
+
+	// A one second frame only runs maxCatchUp ticks, the rest of the time is dropped.
+	auto slow = std::make_shared<TickCountingGame>(size, "test_engine_catch_up");
+	Engine slowEngine{slow, EngineConfig::Simulation(1, 1.0)};
+	slowEngine.setFixedTimestep(64.0, 4);
+	slowEngine.run();
+	REQUIRE(slow->ticks.size() == 4);
+	REQUIRE(slowEngine.getInterpolationAlpha() == Approx(0.0));
+
+	// Without a fixed timestep every frame is one tick of the frame time.
+	slowEngine.disableFixedTimestep();
+	slowEngine.run();
+	REQUIRE(slow->ticks.size() == 5);
+	REQUIRE(slow->ticks.back() == Approx(1.0));
+	REQUIRE(slowEngine.getInterpolationAlpha() == Approx(1.0));
+}
+
+namespace {
+	class SnapshotGame : public Game {
+	public:
+		using Game::Game;
+		bool PublishesState() const noexcept override { return true; }
+	};
+}
+
+TEST_CASE("pipelining is refused unless the game publishes its state", "[engine][pipeline]") {
+	const ScreenSize size { 320, 240 };
+	Engine live{std::make_shared<Game>(size, "test_engine_live_state"), EngineConfig::Simulation(1)};
+	REQUIRE_THROWS_AS(live.enablePipelining(), std::logic_error);
+	REQUIRE_FALSE(live.isPipelined());
+
+	Engine snapshots{std::make_shared<SnapshotGame>(size, "test_engine_snapshots"), EngineConfig::Simulation(1)};
+	REQUIRE_THROWS_AS(snapshots.enablePipelining(4), std::invalid_argument);
+	snapshots.enablePipelining(3);
+	REQUIRE(snapshots.isPipelined());
+	snapshots.disablePipelining();
+	REQUIRE_FALSE(snapshots.isPipelined());
+}
+
+TEST_CASE("frame pipeline updates the next snapshot while the last one is read", "[pipeline]") {
+	for (const std::size_t numBuffers : { std::size_t(2), std::size_t(3) }) {
+		// Frame each buffer holds, and whether someone is using it right now.
+		std::array<int, 3> snapshots{};
+		std::array<std::atomic<bool>, 3> inUse{};
+		std::atomic<int> clashes{ 0 };
+		int published = 0;
+
+		std::promise<void> updating;
+		std::shared_future<void> rendered;
+		FramePipeline pipeline;
+		pipeline.Start([&](const double&, const std::size_t& buffer) {
+			if (inUse[buffer].exchange(true)) {
+				clashes += 1;
+			}
+			updating.set_value();
+			// Stays on this buffer until the render thread has read the other one.
+			rendered.wait();
+			published += 1;
+			snapshots[buffer] = published;
+			inUse[buffer].store(false);
+		}, numBuffers);
+
+		for (int frame = 0; frame < 10; ++frame) {
+			updating = std::promise<void>();
+			std::promise<void> doneReading;
+			rendered = doneReading.get_future().share();
+			std::future<void> updateStarted = updating.get_future();
+			pipeline.Kick(1.0 / 60.0);
+
+			const std::size_t read = pipeline.getReadBuffer();
+			if (inUse[read].exchange(true)) {
+				clashes += 1;
+			}
+			// Update N+1 is running while snapshot N is being read.
+			REQUIRE(updateStarted.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+			REQUIRE(snapshots[read] == frame);
+			inUse[read].store(false);
+			doneReading.set_value();
+
+			pipeline.Wait();
+			REQUIRE(pipeline.getReadBuffer() != read);
+			REQUIRE(pipeline.getReadBuffer() == (read + 1) % numBuffers);
+		}
+		pipeline.Stop();
+		REQUIRE(clashes == 0);
+		REQUIRE(published == 10);
+	}
+
+	// A throwing update keeps the last good snapshot.
+	FramePipeline failing;
+	failing.Start([](const double&, const std::size_t&) { throw std::runtime_error("update failed"); });
+	failing.Kick(1.0 / 60.0);
+	REQUIRE_THROWS_AS(failing.Wait(), std::runtime_error);
+	REQUIRE(failing.getReadBuffer() == 0);
+	REQUIRE_THROWS_AS(failing.Start([](const double&, const std::size_t&) {}, 1), std::invalid_argument);
+}
+
+TEST_CASE("scheduler parallel primitives", "[scheduler]") {
+	Scheduler scheduler{ 4 };
+
+	std::vector<int> visited(10000, 0);
+	scheduler.parallel_for(0, visited.size(), 100, [&visited](const std::size_t i) { visited[i] += 1; });
+	REQUIRE(std::all_of(visited.begin(), visited.end(), [](const int v) { return v == 1; }));
+
+	std::vector<int> values(1000);
+	std::iota(values.begin(), values.end(), 1);
+	const auto squares = scheduler.map(values, [](const int v) { return static_cast<long>(v) * v; }, 16);
+	REQUIRE(squares.size() == values.size());
+	REQUIRE(squares.back() == 1000L * 1000L);
+	REQUIRE(scheduler.reduce(values, 0L, std::plus<>(), 16) == 500500L);
+
+	std::atomic<int> ran{0};
+	TaskCounter counter(&scheduler);
+	for (int i = 0; i < 32; ++i) {
+		scheduler.AddTask([&ran]() { ran.fetch_add(1); }, &counter);
+	}
+	scheduler.WaitForCounter(counter);
+	REQUIRE(counter.isDone());
+	REQUIRE(ran.load() == 32);
+
+	// A throwing task still counts as done, its exception comes out of WaitForCounter.
+	for (int i = 0; i < 8; ++i) {
+		scheduler.AddTask([i]() {
+			if (i == 3) {
+				throw std::runtime_error("task failed");
+			}
+		}, &counter);
+	}
+	REQUIRE_THROWS_AS(scheduler.WaitForCounter(counter), std::runtime_error);
+	REQUIRE(counter.isDone());
+	REQUIRE_THROWS_AS(scheduler.parallel_for(0, 1000, 10, [](const std::size_t i) {
+		if (i == 500) {
+			throw std::out_of_range("index");
+		}
+	}), std::out_of_range);
+}
+
+TEST_CASE("task graph runs nodes after their dependencies", "[scheduler]") {
+	Scheduler scheduler{ 4 };
+	TaskGraph graph;
+
+	std::atomic<int> step{0};
+	int animation = -1, culling = -1, commands = -1;
+	std::atomic<int> sideTasks{0};
+	const auto animate = graph.AddNode("Animation", [&]() { animation = step.fetch_add(1); });
+	const auto cull = graph.AddNode("Culling", [&]() { culling = step.fetch_add(1); });
+	const auto build = graph.AddNode("Commands", [&]() { commands = step.fetch_add(1); });
+	graph.AddNode("Audio", [&]() { sideTasks.fetch_add(1); });
+	graph.AddNode("Particles", [&]() { sideTasks.fetch_add(1); });
+	graph.AddDependency(animate, cull);
+	graph.AddDependency(cull, build);
+	graph.Compile();
+
+	// Compiled once, run every frame.
+	for (int frame = 0; frame < 10; ++frame) {
+		step = 0;
+		scheduler.RunGraph(graph);
+		REQUIRE(animation < culling);
+		REQUIRE(culling < commands);
+	}
+	REQUIRE(sideTasks.load() == 20);
+
+	graph.AddDependency(build, animate);
+	REQUIRE_THROWS_AS(graph.Compile(), std::invalid_argument);
+}
+
+TEST_CASE("frame arenas are reset per thread at the end of the frame", "[memory]") {
+	FrameArena arena{ 1024 };
+	auto* aligned = static_cast<unsigned char*>(arena.Allocate(3, 64));
+	REQUIRE(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0);
+	// Larger than a block, spills into a new one which Reset merges.
+	arena.Allocate(4096);
+	REQUIRE(arena.getCapacity() > 1024);
+	const auto capacity = arena.getCapacity();
+	arena.Reset();
+	REQUIRE(arena.getUsed() == 0);
+	REQUIRE(arena.getCapacity() == capacity);
+
+	FrameVector<int> values{ FrameAllocator<int>(arena) };
+	values.reserve(100);
+	for (int i = 0; i < 100; ++i) {
+		values.push_back(i);
+	}
+	REQUIRE(std::accumulate(values.begin(), values.end(), 0) == 4950);
+	FrameString text{ "a frame-lifetime string longer than the small buffer", FrameAllocator<char>(arena) };
+	REQUIRE(text.size() > 16);
+
+	// Catch assertions aren't thread safe, so the worker only reports back.
+	FrameMemory memory;
+	std::size_t usedDuringFrame = 0, usedAfterFrame = 1;
+	std::thread worker([&]() {
+		memory.Local().Allocate(128);
+		usedDuringFrame = FrameArena::Local().getUsed();
+		memory.NextFrame();
+		usedAfterFrame = FrameArena::Local().getUsed();
+	});
+	worker.join();
+	REQUIRE(usedDuringFrame == 128);
+	REQUIRE(usedAfterFrame == 0);
+	REQUIRE(memory.getFrame() == 1);
+
+	// Threads that never bind follow the global frame.
+	std::size_t unboundAfterFrame = 1;
+	std::thread unbound([&]() {
+		FrameArena::Local().Allocate(128);
+		FrameMemory::Global().NextFrame();
+		unboundAfterFrame = FrameArena::Local().getUsed();
+	});
+	unbound.join();
+	REQUIRE(unboundAfterFrame == 0);
+}
+
+TEST_CASE("gl command queue runs submissions from other threads on the owner", "[gl]") {
+	GLCommandQueue queue;
+	queue.BindToCurrentThread();
+
+	// The owner runs its own submissions inline.
+	REQUIRE(queue.Submit([]() { return 7; }).get() == 7);
+
+	const std::thread::id owner = std::this_thread::get_id();
+	std::vector<std::future<bool>> results;
+	std::mutex resultsMutex;
+	std::vector<std::thread> producers;
+	for (int p = 0; p < 4; ++p) {
+		producers.emplace_back([&]() {
+			for (int i = 0; i < 250; ++i) {
+				auto result = queue.Submit([owner]() { return std::this_thread::get_id() == owner; });
+				std::lock_guard<std::mutex> lock(resultsMutex);
+				results.push_back(std::move(result));
+			}
+		});
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	REQUIRE(queue.size() == 1000);
+
+	// A zero budget still makes progress, one command per drain.
+	REQUIRE(queue.Drain(GLCommandQueue::Clock::duration::zero()) == 1);
+	REQUIRE(queue.DrainAll() == 999);
+	for (auto& result : results) {
+		REQUIRE(result.get());
+	}
+
+	std::future<void> failed;
+	std::future<int> dropped;
+	std::thread([&]() {
+		failed = queue.Submit([]() { throw std::runtime_error("upload failed"); });
+	}).join();
+	queue.DrainAll();
+	REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+
+	{
+		GLCommandQueue unowned;
+		dropped = unowned.Submit([]() { return 1; });
+	}
+	REQUIRE_THROWS_AS(dropped.get(), std::future_error);
+}
+
+#if ENGINE_ENABLE_TRACING
+TEST_CASE("trace events from every thread are written as chrome trace json", "[trace]") {
+	Tracer::Start();
+	ENGINE_TRACE_THREAD_NAME("Test Main");
+	{
+		ENGINE_TRACE_SCOPE("test", "MainScope");
+	}
+	std::thread([]() {
+		ENGINE_TRACE_THREAD_NAME("Test Worker");
+		ENGINE_TRACE_SCOPE_DETAIL("test", "WorkerScope", std::string("needs \"escaping\""));
+		ENGINE_TRACE_INSTANT("test", "WorkerInstant");
+	}).join();
+
+	std::ostringstream out;
+	Tracer::WriteChromeTrace(out);
+	const std::string json = out.str();
+	REQUIRE(json.find("\"name\":\"MainScope\"") != std::string::npos);
+	REQUIRE(json.find("\"name\":\"WorkerScope\"") != std::string::npos);
+	REQUIRE(json.find("\"args\":{\"detail\":\"needs \\\"escaping\\\"\"}") != std::string::npos);
+	REQUIRE(json.find("\"ph\":\"i\",\"s\":\"t\",\"pid\":1") != std::string::npos);
+	REQUIRE(json.find("\"args\":{\"name\":\"Test Main\"}") != std::string::npos);
+	REQUIRE(json.find("\"args\":{\"name\":\"Test Worker\"}") != std::string::npos);
+#if ENGINE_ENABLE_JSON
+	const auto parsed = nlohmann::json::parse(json);
+	REQUIRE(parsed.at("traceEvents").size() >= 6);
+#endif
+
+	// Restarting drops the old events, a window keeps only the most recent ones.
+	// The window ends at Clock::now() when writing, so "Old" ends well before it (sleep_for waits at least that long)
+	// and "Recent" ends in the future, neither depends on how quickly the test runs.
+	Tracer::Start();
+	{
+		ENGINE_TRACE_SCOPE("test", "Old");
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	const Tracer::Clock::time_point recent = Tracer::Clock::now();
+	Tracer::Complete("test", "Recent", recent, recent + std::chrono::hours(1));
+	Tracer::Stop();
+	{
+		ENGINE_TRACE_SCOPE("test", "Stopped");
+	}
+	std::ostringstream windowed;
+	Tracer::WriteChromeTrace(windowed, std::chrono::milliseconds(50));
+	REQUIRE(windowed.str().find("Recent") != std::string::npos);
+	REQUIRE(windowed.str().find("Old") == std::string::npos);
+	REQUIRE(windowed.str().find("MainScope") == std::string::npos);
+	REQUIRE(windowed.str().find("Stopped") == std::string::npos);
+}
+
+TEST_CASE("overlapping trace sessions share one recording", "[trace]") {
+	Tracer::BeginSession();
+	{
+		ENGINE_TRACE_SCOPE("test", "FirstSession");
+	}
+	// A second owner joining keeps what the first one recorded.
+	Tracer::BeginSession();
+	{
+		ENGINE_TRACE_SCOPE("test", "SecondSession");
+	}
+	// And the first one finishing doesn't stop the second.
+	Tracer::EndSession();
+	REQUIRE(Tracer::isEnabled());
+	{
+		ENGINE_TRACE_SCOPE("test", "AfterFirstEnded");
+	}
+	Tracer::EndSession();
+	REQUIRE_FALSE(Tracer::isEnabled());
+	// Unbalanced ends are ignored.
+	Tracer::EndSession();
+	REQUIRE_FALSE(Tracer::isEnabled());
+
+	std::ostringstream out;
+	Tracer::WriteChromeTrace(out);
+	REQUIRE(out.str().find("FirstSession") != std::string::npos);
+	REQUIRE(out.str().find("SecondSession") != std::string::npos);
+	REQUIRE(out.str().find("AfterFirstEnded") != std::string::npos);
+
+	// The next session starts from empty buffers again.
+	Tracer::BeginSession();
+	Tracer::EndSession();
+	std::ostringstream restarted;
+	Tracer::WriteChromeTrace(restarted);
+	REQUIRE(restarted.str().find("FirstSession") == std::string::npos);
+}
+#endif
+
+TEST_CASE("entity registry queries track component changes", "[ecs]") {
+	EntityRegistry registry;
+	std::vector<Entity> entities;
+	for (int i = 0; i < 1000; ++i) {
+		const Entity entity = registry.Create();
+		registry.Add<Position2D>(entity, glm::vec2(static_cast<float>(i), 0.0f));
+		if (i % 2 == 0) {
+			registry.Add<Velocity2D>(entity, glm::vec2(1.0f, 2.0f));
+		}
+		entities.push_back(entity);
+	}
+	auto& moving = registry.query<Position2D, Velocity2D>();
+	REQUIRE(moving.size() == 500);
+	REQUIRE(&registry.query<Position2D, Velocity2D>() == &moving);
+
+	Scheduler scheduler{ 4 };
+	moving.parallel_each(scheduler, [](const Entity, Position2D& position, const Velocity2D& velocity) {
+		position.value += velocity.value;
+	}, 16);
+	REQUIRE(registry.Get<Position2D>(entities[0]).value == glm::vec2(1.0f, 2.0f));
+	REQUIRE(registry.Get<Position2D>(entities[1]).value == glm::vec2(1.0f, 0.0f));
+
+	// Structural changes invalidate the cached matches, stale handles stop matching.
+	registry.Remove<Velocity2D>(entities[2]);
+	registry.Destroy(entities[4]);
+	REQUIRE(moving.size() == 498);
+	REQUIRE_FALSE(registry.isAlive(entities[4]));
+	REQUIRE_FALSE(registry.Has<Position2D>(entities[4]));
+	const Entity reused = registry.Create();
+	REQUIRE(reused.getIndex() == entities[4].getIndex());
+	REQUIRE(reused != entities[4]);
+	REQUIRE(registry.TryGet<Position2D>(reused) == nullptr);
+	REQUIRE_THROWS_AS(registry.Get<Velocity2D>(entities[1]), std::out_of_range);
+
+	float sum = 0.0f;
+	registry.each<Velocity2D>([&sum](const Entity, const Velocity2D& velocity) { sum += velocity.value.y; });
+	REQUIRE(sum == Approx(2.0f * 498.0f));
+
+#if !ENGINE_MIN_GAME_OBJECT
+	GameObject object;
+	object.position() = glm::vec2(3.0f, 4.0f);
+	object.size() = glm::vec2(1.0f, 1.0f);
+	object.velocity() = glm::vec2(0.0f, -1.0f);
+	object.colour() = Colour::red;
+	REQUIRE_FALSE(object.isAttached());
+	const Entity spawned = object.Attach(registry);
+	REQUIRE(object.getEntity() == spawned);
+	REQUIRE_THROWS_AS(object.Attach(registry), std::logic_error);
+	REQUIRE(moving.size() == 499);
+
+	// Both ways are live views, no copying back and forth
+	registry.Get<Position2D>(spawned).value.x = 5.0f;
+	REQUIRE(object.position().x == Approx(5.0f));
+	object.velocity().y = 2.0f;
+	REQUIRE(registry.Get<Velocity2D>(spawned).value.y == Approx(2.0f));
+	const GameObject view(registry, spawned);
+	REQUIRE(view.colour().R == Approx(Colour::red.R));
+	REQUIRE(view.size().x == Approx(1.0f));
+
+	const GameObject created(registry);
+	REQUIRE(registry.isAlive(created.getEntity()));
+	REQUIRE(registry.Has<Colour>(created.getEntity()));
+	REQUIRE(created.velocity().x == Approx(0.0f));
+	REQUIRE(moving.size() == 500);
+
+	object.Detach();
+	REQUIRE_FALSE(object.isAttached());
+	object.position().x = 9.0f;
+	REQUIRE(object.position().y == Approx(4.0f));
+	REQUIRE(registry.Get<Position2D>(spawned).value.x == Approx(5.0f));
+	registry.Destroy(spawned);
+	REQUIRE_THROWS_AS(view.position(), std::out_of_range);
+	REQUIRE_THROWS_AS(GameObject(registry, spawned), std::invalid_argument);
+#endif
+}
+
+TEST_CASE("game object pool keeps handles stable across spawns and frees", "[ecs]") {
+	struct Bullet {
+		int id;
+		float life;
+	};
+	GameObjectInst<Bullet> bullets(64);
+	std::vector<InstHandle> handles;
+	for (int i = 0; i < 10; ++i) {
+		handles.push_back(bullets.Spawn(Bullet{ i, static_cast<float>(i) }));
+	}
+	REQUIRE(bullets.size() == 10);
+
+	REQUIRE(bullets.Free(handles[3]));
+	REQUIRE_FALSE(bullets.Free(handles[3]));
+	REQUIRE(bullets.get(handles[3]) == nullptr);
+	REQUIRE_THROWS_AS(bullets.at(handles[3]), std::out_of_range);
+	// The last bullet moved into the hole, its handle still finds it.
+	REQUIRE(bullets.at(handles[9]).id == 9);
+
+	// The freed slot is reused with a new generation.
+	const InstHandle reused = bullets.Spawn(Bullet{ 10, 10.0f });
+	REQUIRE(reused.getIndex() == handles[3].getIndex());
+	REQUIRE(reused != handles[3]);
+	REQUIRE(bullets.get(handles[3]) == nullptr);
+
+	REQUIRE(bullets.FreeIf([](const Bullet& bullet) { return bullet.life < 5.0f; }) == 4);
+	REQUIRE(bullets.size() == 6);
+	int sum = 0;
+	for (std::size_t i = 0; i < bullets.size(); ++i) {
+		REQUIRE(bullets.get(bullets.handleAt(i)) == bullets.data() + i);
+		sum += bullets.data()[i].id;
+	}
+	REQUIRE(sum == 5 + 6 + 7 + 8 + 9 + 10);
+
+	bullets.Clear();
+	REQUIRE(bullets.empty());
+	REQUIRE_FALSE(bullets.isAlive(reused));
+	REQUIRE_FALSE(bullets.isAlive(InstHandle()));
+
+	// A throwing constructor doesn't use up a slot.
+	struct Picky {
+		explicit Picky(const int value) {
+			if (value < 0) {
+				throw std::invalid_argument("negative");
+			}
+		}
+	};
+	GameObjectInst<Picky> picky;
+	REQUIRE_THROWS_AS(picky.Spawn(-1), std::invalid_argument);
+	REQUIRE(picky.empty());
+	REQUIRE(picky.Spawn(1).getIndex() == 0);
+}
+
+TEST_CASE("kinematics kernels agree with the scalar loop", "[kinematics]") {
+	KinematicsParams params;
+	params.damping = 0.5f;
+	params.clampToBounds = true;
+	params.boundsMin = glm::vec2(0.0f);
+	params.boundsMax = glm::vec2(100.0f, 50.0f);
+	params.restitution = 0.5f;
+
+	// Not a multiple of 8, so the scalar tail runs too.
+	std::vector<KinematicBodies> levels(3);
+	for (auto& bodies : levels) {
+		for (int i = 0; i < 1003; ++i) {
+			const float f = static_cast<float>(i);
+			bodies.Add(glm::vec2(std::fmod(f * 7.0f, 100.0f), std::fmod(f * 3.0f, 50.0f)), glm::vec2(std::sin(f) * 300.0f, std::cos(f) * 300.0f));
+		}
+	}
+	for (int frame = 0; frame < 30; ++frame) {
+		levels[0].Integrate(1.0f / 60.0f, params, nullptr, SimdLevel::Scalar);
+		levels[1].Integrate(1.0f / 60.0f, params, nullptr, SimdLevel::SSE2);
+		levels[2].Integrate(1.0f / 60.0f, params, nullptr, SimdLevel::AVX2);
+	}
+	for (std::size_t i = 0; i < levels[0].size(); ++i) {
+		const glm::vec2 position = levels[0].getPosition(i);
+		REQUIRE(position.x >= 0.0f);
+		REQUIRE(position.x <= 100.0f);
+		REQUIRE(position.y >= 0.0f);
+		REQUIRE(position.y <= 50.0f);
+		for (std::size_t level = 1; level < levels.size(); ++level) {
+			REQUIRE(levels[level].getPosition(i).x == Approx(position.x));
+			REQUIRE(levels[level].getPosition(i).y == Approx(position.y));
+			REQUIRE(levels[level].getVelocity(i).x == Approx(levels[0].getVelocity(i).x));
+			REQUIRE(levels[level].getVelocity(i).y == Approx(levels[0].getVelocity(i).y));
+		}
+	}
+
+	// Hitting the floor bounces back up at half the speed.
+	KinematicBodies falling;
+	falling.Add(glm::vec2(10.0f, 1.0f), glm::vec2(0.0f, -120.0f));
+	params.damping = 0.0f;
+	falling.Integrate(1.0f / 60.0f, params);
+	REQUIRE(falling.getPosition(0).y == Approx(0.0f));
+	REQUIRE(falling.getVelocity(0).y == Approx(60.0f));
+}
+
+TEST_CASE("spatial hash finds the same pairs as brute force", "[broadphase]") {
+	std::vector<Aabb2D> boxes;
+	for (int i = 0; i < 2000; ++i) {
+		const float x = std::fmod(static_cast<float>(i) * 37.3f, 500.0f) - 250.0f;
+		const float y = std::fmod(static_cast<float>(i) * 91.7f, 400.0f) - 200.0f;
+		// A few boxes much larger than a cell
+		const float size = i % 100 == 0 ? 90.0f : 6.0f;
+		boxes.push_back(Aabb2D::FromPositionSize(glm::vec2(x, y), glm::vec2(size)));
+	}
+	std::vector<SpatialHash2D::Pair> expected;
+	for (std::size_t i = 0; i < boxes.size(); ++i) {
+		for (std::size_t j = i + 1; j < boxes.size(); ++j) {
+			if (boxes[i].Overlaps(boxes[j])) {
+				expected.emplace_back(static_cast<SpatialHash2D::Id>(i), static_cast<SpatialHash2D::Id>(j));
+			}
+		}
+	}
+	REQUIRE_FALSE(expected.empty());
+
+	// Few buckets, so cells collide.
+	SpatialHash2D grid(8.0f, 64);
+	Scheduler scheduler{ 4 };
+	std::vector<SpatialHash2D::Pair> pairs;
+	grid.Rebuild(boxes);
+	grid.FindPairs(pairs);
+	REQUIRE(pairs == expected);
+	grid.Rebuild(boxes, &scheduler);
+	grid.FindPairs(pairs, &scheduler);
+	REQUIRE(pairs == expected);
+
+	// Move everything incrementally and compare again.
+	for (std::size_t i = 0; i < boxes.size(); ++i) {
+		boxes[i].min += glm::vec2(13.0f, -7.0f);
+		boxes[i].max += glm::vec2(13.0f, -7.0f);
+		grid.Update(static_cast<SpatialHash2D::Id>(i), boxes[i]);
+	}
+	grid.Remove(5);
+	expected.clear();
+	for (std::size_t i = 0; i < boxes.size(); ++i) {
+		for (std::size_t j = i + 1; j < boxes.size(); ++j) {
+			if (i != 5 && j != 5 && boxes[i].Overlaps(boxes[j])) {
+				expected.emplace_back(static_cast<SpatialHash2D::Id>(i), static_cast<SpatialHash2D::Id>(j));
+			}
+		}
+	}
+	grid.FindPairs(pairs, &scheduler);
+	REQUIRE(pairs == expected);
+	REQUIRE(grid.size() == boxes.size() - 1);
+	REQUIRE_THROWS_AS(grid.Insert(6, boxes[6]), std::invalid_argument);
+
+	const Aabb2D region{ glm::vec2(-20.0f), glm::vec2(20.0f) };
+	std::vector<SpatialHash2D::Id> found;
+	grid.QueryRegion(region, found);
+	std::vector<SpatialHash2D::Id> inside;
+	for (std::size_t i = 0; i < boxes.size(); ++i) {
+		if (i != 5 && boxes[i].Overlaps(region)) {
+			inside.push_back(static_cast<SpatialHash2D::Id>(i));
+		}
+	}
+	REQUIRE(found == inside);
+}
+
+TEST_CASE("bvh queries match testing every box", "[bvh]") {
+	std::vector<Aabb3D> boxes;
+	for (int i = 0; i < 1500; ++i) {
+		const glm::vec3 center(std::fmod(static_cast<float>(i) * 37.3f, 200.0f) - 100.0f, std::fmod(static_cast<float>(i) * 91.7f, 200.0f) - 100.0f, std::fmod(static_cast<float>(i) * 53.9f, 200.0f) - 100.0f);
+		boxes.push_back(Aabb3D::FromCenterExtents(center, glm::vec3(0.5f + static_cast<float>(i % 4))));
+	}
+	DynamicBvh bvh;
+	std::vector<DynamicBvh::ProxyId> proxies;
+	for (std::size_t i = 0; i < boxes.size(); ++i) {
+		proxies.push_back(bvh.Insert(boxes[i], static_cast<std::uint32_t>(i)));
+	}
+	REQUIRE(bvh.size() == boxes.size());
+	// Balanced, 1500 leaves would be 11 levels
+	REQUIRE(bvh.getHeight() < 24);
+
+	const Frustum frustum = Frustum::FromMatrix(glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f) * glm::lookAt(glm::vec3(0.0f, 0.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+	const glm::vec3 sphereCenter(10.0f, -20.0f, 5.0f);
+	auto check = [&](const std::vector<bool>& removed) {
+		std::vector<std::uint32_t> visible;
+		bvh.QueryFrustum(frustum, [&](const DynamicBvh::ProxyId proxy) { visible.push_back(bvh.getUserData(proxy)); });
+		std::vector<std::uint32_t> near;
+		bvh.QuerySphere(sphereCenter, 30.0f, [&](const DynamicBvh::ProxyId proxy) { near.push_back(bvh.getUserData(proxy)); });
+		std::sort(visible.begin(), visible.end());
+		std::sort(near.begin(), near.end());
+		std::vector<std::uint32_t> expectedVisible;
+		std::vector<std::uint32_t> expectedNear;
+		for (std::size_t i = 0; i < boxes.size(); ++i) {
+			if (removed[i]) {
+				continue;
+			}
+			const Aabb3D& fat = bvh.getFatBounds(proxies[i]);
+			REQUIRE(fat.Contains(boxes[i]));
+			if (frustum.Intersects(fat)) {
+				expectedVisible.push_back(static_cast<std::uint32_t>(i));
+			}
+			if (fat.OverlapsSphere(sphereCenter, 30.0f)) {
+				expectedNear.push_back(static_cast<std::uint32_t>(i));
+			}
+		}
+		REQUIRE_FALSE(expectedVisible.empty());
+		REQUIRE(expectedVisible.size() < boxes.size() / 2);
+		REQUIRE(visible == expectedVisible);
+		REQUIRE(near == expectedNear);
+
+		// Aimed at box 7, others may be in the way
+		const Ray ray{ glm::vec3(-150.0f, 0.5f, 0.3f), glm::normalize(boxes[7].getCenter() - glm::vec3(-150.0f, 0.5f, 0.3f)) };
+		float closest = 1000.0f;
+		std::uint32_t expectedHit = 0;
+		for (std::size_t i = 0; i < boxes.size(); ++i) {
+			const float distance = ray.Intersect(boxes[i], closest);
+			if (!removed[i] && distance >= 0.0f) {
+				closest = distance;
+				expectedHit = static_cast<std::uint32_t>(i);
+			}
+		}
+		float hitDistance = -1.0f;
+		const DynamicBvh::ProxyId hit = bvh.RayCast(ray, 1000.0f, [&](const DynamicBvh::ProxyId proxy, const float maxDistance) {
+			return ray.Intersect(boxes[bvh.getUserData(proxy)], maxDistance);
+		}, &hitDistance);
+		REQUIRE(hit != DynamicBvh::nullProxy);
+		REQUIRE(bvh.getUserData(hit) == expectedHit);
+		REQUIRE(hitDistance == Approx(closest));
+	};
+	std::vector<bool> removed(boxes.size(), false);
+	check(removed);
+
+	// Small moves stay inside the fat boxes, large ones reinsert.
+	for (std::size_t i = 0; i < boxes.size(); ++i) {
+		const glm::vec3 offset = i % 2 == 0 ? glm::vec3(0.05f, 0.0f, 0.0f) : glm::vec3(0.0f, 7.0f, -3.0f);
+		boxes[i].min += offset;
+		boxes[i].max += offset;
+		REQUIRE(bvh.Move(proxies[i], boxes[i]) == (i % 2 == 1));
+	}
+	for (std::size_t i = 0; i < boxes.size(); i += 3) {
+		bvh.Remove(proxies[i]);
+		removed[i] = true;
+	}
+	check(removed);
+	REQUIRE(bvh.size() == boxes.size() - boxes.size() / 3);
+	REQUIRE_THROWS_AS(bvh.Remove(proxies[0]), std::out_of_range);
+
+	// Turned 90 degrees about z and moved, a 2x4x6 box becomes 4x2x6.
+	const Aabb3D turned = Aabb3D::FromCenterExtents(glm::vec3(0.0f), glm::vec3(1.0f, 2.0f, 3.0f)).Transformed(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f)), glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+	REQUIRE(turned.min.x == Approx(3.0f));
+	REQUIRE(turned.max.x == Approx(7.0f));
+	REQUIRE(turned.max.y == Approx(1.0f));
+	REQUIRE(turned.max.z == Approx(3.0f));
+}
+
+TEST_CASE("transform hierarchy only recomputes dirty subtrees", "[transform]") {
+	auto near = [](const glm::mat4& a, const glm::mat4& b) {
+		for (int column = 0; column < 4; ++column) {
+			for (int row = 0; row < 4; ++row) {
+				if (std::abs(a[column][row] - b[column][row]) > 1e-4f) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	TransformHierarchy hierarchy;
+	Transform rootLocal;
+	rootLocal.translation = glm::vec3(10.0f, 0.0f, 0.0f);
+	rootLocal.rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const auto root = hierarchy.Create(rootLocal);
+	Transform childLocal;
+	childLocal.translation = glm::vec3(0.0f, 0.0f, 2.0f);
+	childLocal.scale = glm::vec3(2.0f);
+	const auto child = hierarchy.Create(childLocal, root);
+	const auto grandchild = hierarchy.Create(childLocal, child);
+	const auto other = hierarchy.Create();
+	hierarchy.Update();
+
+	REQUIRE(near(hierarchy.getWorld(grandchild), rootLocal.toMatrix() * childLocal.toMatrix() * childLocal.toMatrix()));
+	// Turned 90 degrees about y, the child's +z offset becomes +x.
+	const glm::vec4 childOrigin = hierarchy.getWorld(child) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	REQUIRE(childOrigin.x == Approx(12.0f));
+	REQUIRE(childOrigin.z == Approx(0.0f).margin(1e-4));
+	REQUIRE(hierarchy.getOrder() == std::vector<TransformHierarchy::NodeId>{ root, child, grandchild, other });
+
+	// Nothing changed, nothing recomputed.
+	hierarchy.Update();
+	REQUIRE_FALSE(hierarchy.isWorldChanged(root));
+	REQUIRE_FALSE(hierarchy.isWorldChanged(grandchild));
+
+	childLocal.translation = glm::vec3(0.0f, 1.0f, 0.0f);
+	hierarchy.setLocal(child, childLocal);
+	hierarchy.Update();
+	REQUIRE_FALSE(hierarchy.isWorldChanged(root));
+	REQUIRE(hierarchy.isWorldChanged(child));
+	REQUIRE(hierarchy.isWorldChanged(grandchild));
+	REQUIRE_FALSE(hierarchy.isWorldChanged(other));
+
+	hierarchy.SetParent(child, other);
+	REQUIRE_THROWS_AS(hierarchy.SetParent(other, grandchild), std::invalid_argument);
+	hierarchy.Update();
+	REQUIRE(near(hierarchy.getWorld(grandchild), hierarchy.getWorld(child) * hierarchy.getLocal(grandchild).toMatrix()));
+	REQUIRE(hierarchy.getOrder() == std::vector<TransformHierarchy::NodeId>{ root, other, child, grandchild });
+	hierarchy.Destroy(child);
+	REQUIRE_FALSE(hierarchy.isAlive(grandchild));
+	REQUIRE(hierarchy.size() == 2);
+	hierarchy.Update();
+	REQUIRE(hierarchy.getOrder() == std::vector<TransformHierarchy::NodeId>{ root, other });
+
+	// A forest big enough to be split across threads, including one deep chain, matches the serial update.
+	TransformHierarchy serial;
+	TransformHierarchy parallel;
+	std::vector<TransformHierarchy::NodeId> nodes;
+	for (int i = 0; i < 20000; ++i) {
+		Transform local;
+		local.translation = glm::vec3(static_cast<float>(i % 7), 0.5f, -1.0f);
+		local.rotation = glm::angleAxis(0.001f * static_cast<float>(i), glm::vec3(0.0f, 0.0f, 1.0f));
+		// Every third node starts a new tree, the first 3000 form a chain.
+		const auto parent = i == 0 || (i >= 3000 && i % 3 == 0) ? TransformHierarchy::nullNode : nodes[static_cast<std::size_t>(i < 3000 ? i - 1 : i / 2)];
+		nodes.push_back(serial.Create(local, parent));
+		REQUIRE(parallel.Create(local, parent) == nodes.back());
+	}
+	Scheduler scheduler{ 4 };
+	for (int frame = 0; frame < 3; ++frame) {
+		const auto moved = nodes[static_cast<std::size_t>(frame * 4999)];
+		Transform local = serial.getLocal(moved);
+		local.translation.y += 1.0f;
+		serial.setLocal(moved, local);
+		parallel.setLocal(moved, local);
+		serial.Update();
+		parallel.Update(&scheduler);
+		for (const auto node : nodes) {
+			REQUIRE(serial.isWorldChanged(node) == parallel.isWorldChanged(node));
+			REQUIRE(serial.getWorld(node) == parallel.getWorld(node));
+		}
+	}
+}
+
+#if ENGINE_ENABLE_COROUTINES
+namespace {
+	CoTask<int> doubledOnWorker(Scheduler& scheduler, const int value) {
+		co_await scheduler.schedule();
+		co_return value * 2;
+	}
+
+	CoTask<> failOnWorker(Scheduler& scheduler) {
+		co_await scheduler.schedule();
+		throw std::runtime_error("load failed");
+	}
+
+	// Checked on the main thread once the coroutine is done, Catch assertions aren't thread safe.
+	struct CoroutineResults {
+		std::thread::id mainThread = std::this_thread::get_id();
+		std::atomic<bool> done{false};
+		int doubled = 0;
+		bool resumedOnMain = false;
+		bool rethrown = false;
+	};
+
+	// A free function rather than a lambda, a lambda's captures die with the closure while the coroutine is suspended.
+	CoTask<> coroutineScenario(Scheduler& scheduler, CoroutineResults& results) {
+		results.doubled = co_await doubledOnWorker(scheduler, 21);
+		co_await scheduler.nextFrame();
+		results.resumedOnMain = std::this_thread::get_id() == results.mainThread;
+		try {
+			co_await failOnWorker(scheduler);
+		} catch (const std::runtime_error&) {
+			results.rethrown = true;
+		}
+		co_await scheduler.nextFrame();
+		results.done = true;
+	}
+}
+
+TEST_CASE("coroutines hop between workers and the main thread", "[scheduler][coroutine]") {
+	Scheduler scheduler{ 2 };
+	CoroutineResults results;
+	scheduler.Spawn(coroutineScenario(scheduler, results));
+
+	// Stands in for the engine's frame loop.
+	while (!results.done.load()) {
+		scheduler.ResumeFrameWaiters();
+		std::this_thread::yield();
+	}
+	REQUIRE(results.doubled == 42);
+	REQUIRE(results.resumedOnMain);
+	REQUIRE(results.rethrown);
+}
+
+TEST_CASE("coroutines can't hop to the main thread in simulation mode", "[engine][simulation][coroutine]") {
+	const ScreenSize size { 320, 240 };
+	Engine e{std::make_shared<Game>(size, "test_engine_simulation_coroutines"), EngineConfig::Simulation(1)};
+	// Refused when called, before a coroutine could suspend on a queue nothing drains.
+	REQUIRE_THROWS_AS(e.mainThread(), std::logic_error);
+	REQUIRE_THROWS_AS(e.getResourceManager()->AwaitTexture("missing.png", "missing", false), std::logic_error);
+}
+#endif